@@ -31,6 +31,11 @@
     volumes).  Block buffers may be either dirty or clean.  Most I/O passes
     through this module.  When a buffer is needed for a block which is not in
     the cache, a "victim" is selected via a simple LRU scheme.
+
+    Buffers are looked up through a hash table keyed on the volume and block
+    number, and kept in LRU order on a doubly linked list threaded through the
+    buffer heads, so the cost of finding, promoting, and releasing a buffer
+    does not grow with the number of buffers.
 */
 #include <redfs.h>
 #include <redcore.h>
@@ -104,6 +109,47 @@
 #define BBLK_INVALID UINT32_MAX
 
 
+/*  An invalid buffer index.  Used to terminate the hash chains and the LRU
+    list.
+*/
+#define BIDX_INVALID UINT16_MAX
+
+
+/*  Number of bits in a hash bucket number.  There are at least as many buckets
+    as buffers, so the hash chains hold one buffer on average.
+*/
+#if REDCONF_BUFFER_COUNT <= 16U
+  #define BUFFER_HASH_BITS 4U
+#elif REDCONF_BUFFER_COUNT <= 32U
+  #define BUFFER_HASH_BITS 5U
+#elif REDCONF_BUFFER_COUNT <= 64U
+  #define BUFFER_HASH_BITS 6U
+#elif REDCONF_BUFFER_COUNT <= 128U
+  #define BUFFER_HASH_BITS 7U
+#elif REDCONF_BUFFER_COUNT <= 256U
+  #define BUFFER_HASH_BITS 8U
+#elif REDCONF_BUFFER_COUNT <= 512U
+  #define BUFFER_HASH_BITS 9U
+#elif REDCONF_BUFFER_COUNT <= 1024U
+  #define BUFFER_HASH_BITS 10U
+#elif REDCONF_BUFFER_COUNT <= 2048U
+  #define BUFFER_HASH_BITS 11U
+#elif REDCONF_BUFFER_COUNT <= 4096U
+  #define BUFFER_HASH_BITS 12U
+#elif REDCONF_BUFFER_COUNT <= 8192U
+  #define BUFFER_HASH_BITS 13U
+#elif REDCONF_BUFFER_COUNT <= 16384U
+  #define BUFFER_HASH_BITS 14U
+#elif REDCONF_BUFFER_COUNT <= 32768U
+  #define BUFFER_HASH_BITS 15U
+#else
+  #define BUFFER_HASH_BITS 16U
+#endif
+
+#define BUFFER_HASH_BUCKETS (1UL << BUFFER_HASH_BITS)
+
+
+
 /** @brief Metadata stored for each block buffer.
 
     To make better use of CPU caching when searching the BUFFERHEAD array, this
@@ -111,10 +157,13 @@
 */
 typedef struct
 {
-    uint32_t    ulBlock;    /**< Block number the buffer is associated with; BBLK_INVALID if unused. */
-    uint8_t     bVolNum;    /**< Volume the block resides on. */
-    uint8_t     bRefCount;  /**< Number of references. */
-    uint16_t    uFlags;     /**< Buffer flags: mask of BFLAG_* values. */
+    uint32_t    ulBlock;        /**< Block number the buffer is associated with; BBLK_INVALID if unused. */
+    uint8_t     bVolNum;        /**< Volume the block resides on. */
+    uint8_t     bRefCount;      /**< Number of references. */
+    uint16_t    uFlags;         /**< Buffer flags: mask of BFLAG_* values. */
+    uint16_t    uHashNext;      /**< Next buffer in the same hash chain; BIDX_INVALID if last. */
+    uint16_t    uMoreRecent;    /**< Next more recently used buffer; BIDX_INVALID if MRU. */
+    uint16_t    uLessRecent;    /**< Next less recently used buffer; BIDX_INVALID if LRU. */
 } BUFFERHEAD;
 
 
@@ -126,36 +175,74 @@ typedef struct
     */
     uint16_t    uNumUsed;
 
-    /** MRU array.  Each element of the array stores a buffer index; each buffer
-        index appears in the array once and only once.  The first element of the
-        array is the most-recently-used (MRU) buffer, followed by the next most
-        recently used, and so on, till the last element, which is the least-
-        recently-used (LRU) buffer.
+    /** Index of the most-recently-used (MRU) buffer.  Every buffer is on the
+        LRU list, which runs from this buffer through the uLessRecent links of
+        the buffer heads to the least-recently-used buffer.
+    */
+    uint16_t    uMRU;
+
+    /** Index of the least-recently-used (LRU) buffer.  The list runs back to
+        the MRU buffer through the uMoreRecent links.
+    */
+    uint16_t    uLRU;
+
+    /** Hash table of the buffers which are associated with a block.  Each
+        bucket stores the index of the first buffer in its chain, or
+        BIDX_INVALID if the chain is empty; see BufferHash().
     */
-    uint8_t     abMRU[REDCONF_BUFFER_COUNT];
+    uint16_t    auHash[BUFFER_HASH_BUCKETS];
 
     /** Buffer heads, storing metadata for each buffer.
     */
     BUFFERHEAD  aHead[REDCONF_BUFFER_COUNT];
 
+  #if REDCONF_READ_ONLY == 0
+    /** Indexes of the dirty buffers being flushed by RedBufferFlush(), sorted
+        by block number.
+    */
+    uint16_t    auFlush[REDCONF_BUFFER_COUNT];
+
+    /** Number of blocks written by RedBufferFlush().
+    */
+    uint32_t    ulFlushBlocks;
+
+    /** Number of RedIoWrite() requests issued by RedBufferFlush().
+    */
+    uint32_t    ulFlushWrites;
+  #endif
+
     /** Array of memory for the block buffers themselves.
 
         Force 64-bit alignment of the aabBuffer array to ensure that it is safe
         to cast buffer pointers to node structure pointers.
     */
     ALIGNED_2D_BYTE_ARRAY(b, aabBuffer, REDCONF_BUFFER_COUNT, REDCONF_BLOCK_SIZE);
+
+  #if (REDCONF_READ_ONLY == 0) && (REDCONF_FLUSH_GATHER_BLOCKS > 1U)
+    /** Bounce buffer into which RedBufferFlush() gathers consecutive blocks
+        whose buffers are not adjacent in memory.
+    */
+    ALIGNED_2D_BYTE_ARRAY(g, aabGather, REDCONF_FLUSH_GATHER_BLOCKS, REDCONF_BLOCK_SIZE);
+  #endif
 } BUFFERCTX;
 
 
 static bool BufferIsValid(const uint8_t  *pbBuffer, uint16_t uFlags);
-static bool BufferToIdx(const void *pBuffer, uint8_t *pbIdx);
+static bool BufferToIdx(const void *pBuffer, uint16_t *puIdx);
 #if REDCONF_READ_ONLY == 0
-static REDSTATUS BufferWrite(uint8_t bIdx);
+static REDSTATUS BufferWrite(uint16_t uIdx);
+static REDSTATUS BufferWriteRun(const uint16_t *puIdx, uint32_t ulCount, bool fAdjacent);
 static REDSTATUS BufferFinalize(uint8_t *pbBuffer, uint16_t uFlags);
+static void BufferSortByBlock(uint16_t *puIdx, uint32_t ulCount);
 #endif
-static void BufferMakeLRU(uint8_t bIdx);
-static void BufferMakeMRU(uint8_t bIdx);
-static bool BufferFind(uint32_t ulBlock, uint8_t *pbIdx);
+static void BufferLruUnlink(uint16_t uIdx);
+static void BufferMakeLRU(uint16_t uIdx);
+static void BufferMakeMRU(uint16_t uIdx);
+static uint32_t BufferHash(uint8_t bVolNum, uint32_t ulBlock);
+static void BufferHashInsert(uint16_t uIdx);
+static void BufferHashRemove(uint16_t uIdx);
+static bool BufferFind(uint32_t ulBlock, uint16_t *puIdx);
+static bool BufferFindInRange(uint32_t ulBlockStart, uint32_t ulBlockCount, uint32_t *pulCursor, uint16_t *puIdx);
 
 #ifdef REDCONF_ENDIAN_SWAP
 static void BufferEndianSwap(const void *pBuffer, uint16_t uFlags);
@@ -174,18 +261,31 @@ static BUFFERCTX gBufCtx;
 */
 void RedBufferInit(void)
 {
-    uint8_t bIdx;
+    uint32_t ulIdx;
 
     RedMemSet(&gBufCtx, 0U, sizeof(gBufCtx));
 
-    for(bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++)
+    for(ulIdx = 0U; ulIdx < BUFFER_HASH_BUCKETS; ulIdx++)
     {
+        gBufCtx.auHash[ulIdx] = BIDX_INVALID;
+    }
+
+    for(ulIdx = 0U; ulIdx < REDCONF_BUFFER_COUNT; ulIdx++)
+    {
+        BUFFERHEAD *pHead = &gBufCtx.aHead[ulIdx];
+
         /*  When the buffers have been freshly initialized, acquire the buffers
-            in the order in which they appear in the array.
+            in the order in which they appear in the array: the first buffer is
+            the LRU buffer and the last one is the MRU buffer.
         */
-        gBufCtx.abMRU[bIdx] = (uint8_t)((REDCONF_BUFFER_COUNT - bIdx) - 1U);
-        gBufCtx.aHead[bIdx].ulBlock = BBLK_INVALID;
+        pHead->ulBlock = BBLK_INVALID;
+        pHead->uHashNext = BIDX_INVALID;
+        pHead->uLessRecent = (ulIdx == 0U) ? BIDX_INVALID : (uint16_t)(ulIdx - 1U);
+        pHead->uMoreRecent = (ulIdx == (REDCONF_BUFFER_COUNT - 1U)) ? BIDX_INVALID : (uint16_t)(ulIdx + 1U);
     }
+
+    gBufCtx.uLRU = 0U;
+    gBufCtx.uMRU = (uint16_t)(REDCONF_BUFFER_COUNT - 1U);
 }
 
 
@@ -208,7 +308,7 @@ REDSTATUS RedBufferGet(
     void      **ppBuffer)
 {
     REDSTATUS   ret = 0;
-    uint8_t     bIdx;
+    uint16_t    uIdx;
 
     if((ulBlock >= gpRedVolume->ulBlockCount) || ((uFlags & BFLAG_MASK) != uFlags) || (ppBuffer == NULL))
     {
@@ -217,7 +317,7 @@ REDSTATUS RedBufferGet(
     }
     else
     {
-        if(BufferFind(ulBlock, &bIdx))
+        if(BufferFind(ulBlock, &uIdx))
         {
             /*  Error if the buffer exists and BFLAG_NEW was specified, since
                 the new flag is used when a block is newly allocated/created, so
@@ -228,7 +328,7 @@ REDSTATUS RedBufferGet(
                 was requested.
             */
             if(    ((uFlags & BFLAG_NEW) != 0U)
-                || ((uFlags & BFLAG_META_MASK) != (gBufCtx.aHead[bIdx].uFlags & BFLAG_META_MASK)))
+                || ((uFlags & BFLAG_META_MASK) != (gBufCtx.aHead[uIdx].uFlags & BFLAG_META_MASK)))
             {
                 CRITICAL_ERROR();
                 ret = -RED_EFUBAR;
@@ -244,23 +344,22 @@ REDSTATUS RedBufferGet(
         }
         else
         {
-            BUFFERHEAD *pHead;
+            BUFFERHEAD *pHead = NULL;
 
             /*  Search for the least recently used buffer which is not
-                referenced.
+                referenced.  Only the few buffers referenced by the current
+                operation are skipped, so this stops close to the LRU end.
             */
-            for(bIdx = (uint8_t)(REDCONF_BUFFER_COUNT - 1U); bIdx > 0U; bIdx--)
+            for(uIdx = gBufCtx.uLRU; uIdx != BIDX_INVALID; uIdx = gBufCtx.aHead[uIdx].uMoreRecent)
             {
-                if(gBufCtx.aHead[gBufCtx.abMRU[bIdx]].bRefCount == 0U)
+                if(gBufCtx.aHead[uIdx].bRefCount == 0U)
                 {
+                    pHead = &gBufCtx.aHead[uIdx];
                     break;
                 }
             }
 
-            bIdx = gBufCtx.abMRU[bIdx];
-            pHead = &gBufCtx.aHead[bIdx];
-
-            if(pHead->bRefCount == 0U)
+            if(pHead != NULL)
             {
                 /*  If the LRU buffer is valid and dirty, write it out before
                     repurposing it.
@@ -271,7 +370,7 @@ REDSTATUS RedBufferGet(
                     CRITICAL_ERROR();
                     ret = -RED_EFUBAR;
                   #else
-                    ret = BufferWrite(bIdx);
+                    ret = BufferWrite(uIdx);
                   #endif
                 }
             }
@@ -286,24 +385,28 @@ REDSTATUS RedBufferGet(
 
             if(ret == 0)
             {
-                if((uFlags & BFLAG_NEW) == 0U)
+                /*  Invalidate the LRU buffer.  If the read fails, we do not
+                    want the buffer head to continue to refer to the old block
+                    number, since the read, even if it fails, may have partially
+                    overwritten the buffer data (consider the case where block
+                    size exceeds sector size, and some but not all of the
+                    sectors are read successfully), and if the buffer were to be
+                    used subsequently with its partially erroneous contents, bad
+                    things could happen.
+                */
+                if(pHead->ulBlock != BBLK_INVALID)
                 {
-                    /*  Invalidate the LRU buffer.  If the read fails, we do not
-                        want the buffer head to continue to refer to the old
-                        block number, since the read, even if it fails, may have
-                        partially overwritten the buffer data (consider the case
-                        where block size exceeds sector size, and some but not
-                        all of the sectors are read successfully), and if the
-                        buffer were to be used subsequently with its partially
-                        erroneous contents, bad things could happen.
-                    */
+                    BufferHashRemove(uIdx);
                     pHead->ulBlock = BBLK_INVALID;
+                }
 
-                    ret = RedIoRead(gbRedVolNum, ulBlock, 1U, gBufCtx.b.aabBuffer[bIdx]);
+                if((uFlags & BFLAG_NEW) == 0U)
+                {
+                    ret = RedIoRead(gbRedVolNum, ulBlock, 1U, gBufCtx.b.aabBuffer[uIdx]);
 
                     if((ret == 0) && ((uFlags & BFLAG_META) != 0U))
                     {
-                        if(!BufferIsValid(gBufCtx.b.aabBuffer[bIdx], uFlags))
+                        if(!BufferIsValid(gBufCtx.b.aabBuffer[uIdx], uFlags))
                         {
                             /*  A corrupt metadata node is usually a critical
                                 error.  The master block is an exception since
@@ -319,13 +422,13 @@ REDSTATUS RedBufferGet(
                   #ifdef REDCONF_ENDIAN_SWAP
                     if(ret == 0)
                     {
-                        BufferEndianSwap(gBufCtx.b.aabBuffer[bIdx], uFlags);
+                        BufferEndianSwap(gBufCtx.b.aabBuffer[uIdx], uFlags);
                     }
                   #endif
                 }
                 else
                 {
-                    RedMemSet(gBufCtx.b.aabBuffer[bIdx], 0U, REDCONF_BLOCK_SIZE);
+                    RedMemSet(gBufCtx.b.aabBuffer[uIdx], 0U, REDCONF_BLOCK_SIZE);
                 }
             }
 
@@ -334,6 +437,8 @@ REDSTATUS RedBufferGet(
                 pHead->bVolNum = gbRedVolNum;
                 pHead->ulBlock = ulBlock;
                 pHead->uFlags = 0U;
+
+                BufferHashInsert(uIdx);
             }
         }
 
@@ -344,7 +449,7 @@ REDSTATUS RedBufferGet(
         */
         if(ret == 0)
         {
-            BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+            BUFFERHEAD *pHead = &gBufCtx.aHead[uIdx];
 
             pHead->bRefCount++;
 
@@ -359,9 +464,9 @@ REDSTATUS RedBufferGet(
             */
             pHead->uFlags |= (uFlags & (~BFLAG_NEW));
 
-            BufferMakeMRU(bIdx);
+            BufferMakeMRU(uIdx);
 
-            *ppBuffer = gBufCtx.b.aabBuffer[bIdx];
+            *ppBuffer = gBufCtx.b.aabBuffer[uIdx];
         }
     }
 
@@ -376,18 +481,18 @@ REDSTATUS RedBufferGet(
 void RedBufferPut(
     const void *pBuffer)
 {
-    uint8_t     bIdx;
+    uint16_t    uIdx;
 
-    if(!BufferToIdx(pBuffer, &bIdx))
+    if(!BufferToIdx(pBuffer, &uIdx))
     {
         REDERROR();
     }
     else
     {
-        REDASSERT(gBufCtx.aHead[bIdx].bRefCount > 0U);
-        gBufCtx.aHead[bIdx].bRefCount--;
+        REDASSERT(gBufCtx.aHead[uIdx].bRefCount > 0U);
+        gBufCtx.aHead[uIdx].bRefCount--;
 
-        if(gBufCtx.aHead[bIdx].bRefCount == 0U)
+        if(gBufCtx.aHead[uIdx].bRefCount == 0U)
         {
             REDASSERT(gBufCtx.uNumUsed > 0U);
             gBufCtx.uNumUsed--;
@@ -424,29 +529,68 @@ REDSTATUS RedBufferFlush(
     }
     else
     {
-        uint8_t bIdx;
+        uint32_t ulCursor = 0U;
+        uint32_t ulDirty = 0U;
+        uint32_t ulRunStart = 0U;
+        uint16_t uIdx;
+
+        /*  Gather the dirty buffers and sort them by block number, so that the
+            blocks are written in ascending order, and runs of consecutive
+            blocks can be written with a single request.
+        */
+        while(BufferFindInRange(ulBlockStart, ulBlockCount, &ulCursor, &uIdx))
+        {
+            if((gBufCtx.aHead[uIdx].uFlags & BFLAG_DIRTY) != 0U)
+            {
+                gBufCtx.auFlush[ulDirty] = uIdx;
+                ulDirty++;
+            }
+        }
 
-        for(bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++)
+        BufferSortByBlock(gBufCtx.auFlush, ulDirty);
+
+        while((ulRunStart < ulDirty) && (ret == 0))
         {
-            BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+            uint32_t    ulRunEnd = ulRunStart + 1U;
+            bool        fAdjacent = true;
 
-            if(    (pHead->bVolNum == gbRedVolNum)
-                && (pHead->ulBlock != BBLK_INVALID)
-                && ((pHead->uFlags & BFLAG_DIRTY) != 0U)
-                && (pHead->ulBlock >= ulBlockStart)
-                && (pHead->ulBlock < (ulBlockStart + ulBlockCount)))
+            /*  Extend the run over consecutive blocks.  Blocks whose buffers
+                follow each other in memory can be written straight from the
+                buffers, however many there are; otherwise, the run is limited
+                to what fits in the bounce buffer.
+            */
+            while(ulRunEnd < ulDirty)
             {
-                ret = BufferWrite(bIdx);
+                const BUFFERHEAD   *pPrev = &gBufCtx.aHead[gBufCtx.auFlush[ulRunEnd - 1U]];
+                const BUFFERHEAD   *pNext = &gBufCtx.aHead[gBufCtx.auFlush[ulRunEnd]];
+                bool                fNextAdjacent = fAdjacent && (gBufCtx.auFlush[ulRunEnd] == (gBufCtx.auFlush[ulRunEnd - 1U] + 1U));
 
-                if(ret == 0)
+                if(    (pNext->ulBlock != (pPrev->ulBlock + 1U))
+                    || (!fNextAdjacent && ((ulRunEnd - ulRunStart) >= REDCONF_FLUSH_GATHER_BLOCKS)))
                 {
-                    pHead->uFlags &= (~BFLAG_DIRTY);
+                    break;
                 }
-                else
+
+                fAdjacent = fNextAdjacent;
+                ulRunEnd++;
+            }
+
+            ret = BufferWriteRun(&gBufCtx.auFlush[ulRunStart], ulRunEnd - ulRunStart, fAdjacent);
+
+            if(ret == 0)
+            {
+                uint32_t ulIdx;
+
+                for(ulIdx = ulRunStart; ulIdx < ulRunEnd; ulIdx++)
                 {
-                    break;
+                    gBufCtx.aHead[gBufCtx.auFlush[ulIdx]].uFlags &= (~BFLAG_DIRTY);
                 }
+
+                gBufCtx.ulFlushBlocks += ulRunEnd - ulRunStart;
+                gBufCtx.ulFlushWrites++;
             }
+
+            ulRunStart = ulRunEnd;
         }
     }
 
@@ -454,6 +598,34 @@ REDSTATUS RedBufferFlush(
 }
 
 
+/** @brief Get the write statistics of RedBufferFlush().
+
+    The counts accumulate from RedBufferInit().  The difference between the
+    two is the number of write requests saved by writing consecutive blocks
+    together; sampling them around RedVolTransact() gives the saving for one
+    transaction.
+
+    @param pulBlocks    Populated with the number of blocks written.  May be
+                        NULL.
+    @param pulWrites    Populated with the number of write requests issued.
+                        May be NULL.
+*/
+void RedBufferFlushStats(
+    uint32_t   *pulBlocks,
+    uint32_t   *pulWrites)
+{
+    if(pulBlocks != NULL)
+    {
+        *pulBlocks = gBufCtx.ulFlushBlocks;
+    }
+
+    if(pulWrites != NULL)
+    {
+        *pulWrites = gBufCtx.ulFlushWrites;
+    }
+}
+
+
 /** @brief Mark a buffer dirty
 
     @param pBuffer  The buffer to mark dirty.
@@ -461,17 +633,17 @@ REDSTATUS RedBufferFlush(
 void RedBufferDirty(
     const void *pBuffer)
 {
-    uint8_t     bIdx;
+    uint16_t    uIdx;
 
-    if(!BufferToIdx(pBuffer, &bIdx))
+    if(!BufferToIdx(pBuffer, &uIdx))
     {
         REDERROR();
     }
     else
     {
-        REDASSERT(gBufCtx.aHead[bIdx].bRefCount > 0U);
+        REDASSERT(gBufCtx.aHead[uIdx].bRefCount > 0U);
 
-        gBufCtx.aHead[bIdx].uFlags |= BFLAG_DIRTY;
+        gBufCtx.aHead[uIdx].uFlags |= BFLAG_DIRTY;
     }
 }
 
@@ -485,22 +657,28 @@ void RedBufferBranch(
     const void *pBuffer,
     uint32_t    ulBlockNew)
 {
-    uint8_t     bIdx;
+    uint16_t    uIdx;
 
-    if(    !BufferToIdx(pBuffer, &bIdx)
+    if(    !BufferToIdx(pBuffer, &uIdx)
         || (ulBlockNew >= gpRedVolume->ulBlockCount))
     {
         REDERROR();
     }
     else
     {
-        BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+        BUFFERHEAD *pHead = &gBufCtx.aHead[uIdx];
 
         REDASSERT(pHead->bRefCount > 0U);
         REDASSERT((pHead->uFlags & BFLAG_DIRTY) == 0U);
 
+        /*  The buffer moves to the hash chain of its new block number.
+        */
+        BufferHashRemove(uIdx);
+
         pHead->uFlags |= BFLAG_DIRTY;
         pHead->ulBlock = ulBlockNew;
+
+        BufferHashInsert(uIdx);
     }
 }
 
@@ -513,23 +691,25 @@ void RedBufferBranch(
 void RedBufferDiscard(
     const void *pBuffer)
 {
-    uint8_t     bIdx;
+    uint16_t    uIdx;
 
-    if(!BufferToIdx(pBuffer, &bIdx))
+    if(!BufferToIdx(pBuffer, &uIdx))
     {
         REDERROR();
     }
     else
     {
-        REDASSERT(gBufCtx.aHead[bIdx].bRefCount == 1U);
+        REDASSERT(gBufCtx.aHead[uIdx].bRefCount == 1U);
         REDASSERT(gBufCtx.uNumUsed > 0U);
 
-        gBufCtx.aHead[bIdx].bRefCount = 0U;
-        gBufCtx.aHead[bIdx].ulBlock = BBLK_INVALID;
+        BufferHashRemove(uIdx);
+
+        gBufCtx.aHead[uIdx].bRefCount = 0U;
+        gBufCtx.aHead[uIdx].ulBlock = BBLK_INVALID;
 
         gBufCtx.uNumUsed--;
 
-        BufferMakeLRU(bIdx);
+        BufferMakeLRU(uIdx);
     }
 }
 #endif
@@ -563,43 +743,39 @@ REDSTATUS RedBufferDiscardRange(
     }
     else
     {
-        uint8_t bIdx;
+        uint32_t ulCursor = 0U;
+        uint16_t uIdx;
 
-        for(bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++)
+        while(BufferFindInRange(ulBlockStart, ulBlockCount, &ulCursor, &uIdx))
         {
-            BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+            BUFFERHEAD *pHead = &gBufCtx.aHead[uIdx];
 
-            if(    (pHead->bVolNum == gbRedVolNum)
-                && (pHead->ulBlock != BBLK_INVALID)
-                && (pHead->ulBlock >= ulBlockStart)
-                && (pHead->ulBlock < (ulBlockStart + ulBlockCount)))
+            if(pHead->bRefCount == 0U)
             {
-                if(pHead->bRefCount == 0U)
-                {
-                    pHead->ulBlock = BBLK_INVALID;
+                BufferHashRemove(uIdx);
+                pHead->ulBlock = BBLK_INVALID;
 
-                    BufferMakeLRU(bIdx);
-                }
-                else
-                {
-                    /*  This should never happen.  There are three general cases
-                        when this function is used:
-
-                        1) Discarding every block, as happens during unmount
-                           and at the end of format.  There should no longer be
-                           any referenced buffers at those points.
-                        2) Discarding a block which has become free.  All
-                           buffers for such blocks should be put or branched
-                           beforehand.
-                        3) Discarding of blocks that were just written straight
-                           to disk, leaving stale data in the buffer.  The write
-                           code should never reference buffers for these blocks,
-                           since they would not be needed or used.
-                    */
-                    CRITICAL_ERROR();
-                    ret = -RED_EBUSY;
-                    break;
-                }
+                BufferMakeLRU(uIdx);
+            }
+            else
+            {
+                /*  This should never happen.  There are three general cases
+                    when this function is used:
+
+                    1) Discarding every block, as happens during unmount
+                       and at the end of format.  There should no longer be
+                       any referenced buffers at those points.
+                    2) Discarding a block which has become free.  All
+                       buffers for such blocks should be put or branched
+                       beforehand.
+                    3) Discarding of blocks that were just written straight
+                       to disk, leaving stale data in the buffer.  The write
+                       code should never reference buffers for these blocks,
+                       since they would not be needed or used.
+                */
+                CRITICAL_ERROR();
+                ret = -RED_EBUSY;
+                break;
             }
         }
     }
@@ -718,7 +894,7 @@ static bool BufferIsValid(
 /** @brief Derive the index of the buffer.
 
     @param pBuffer  The buffer to derive the index of.
-    @param pbIdx    On success, populated with the index of the buffer.
+    @param puIdx    On success, populated with the index of the buffer.
 
     @return Boolean indicating result.
 
@@ -727,37 +903,31 @@ static bool BufferIsValid(
 */
 static bool BufferToIdx(
     const void *pBuffer,
-    uint8_t    *pbIdx)
+    uint16_t   *puIdx)
 {
     bool        fRet = false;
 
-    if((pBuffer != NULL) && (pbIdx != NULL))
+    if((pBuffer != NULL) && (puIdx != NULL))
     {
-        uint8_t bIdx;
-
-        /*  pBuffer should be a pointer to one of the block buffers.
-
-            A good compiler should optimize this loop into a bounds check and an
-            alignment check, although GCC has been observed to not do so; if the
-            number of buffers is small, it should not make much difference.  The
-            alternative is to use pointer comparisons, but this both deviates
-            from MISRA-C:2012 and involves undefined behavior.
+        /*  pBuffer should be a pointer to one of the block buffers.  Its offset
+            from the first buffer gives the index, provided that it lies within
+            the array and at the start of a buffer.  A pointer below the array
+            yields a huge offset, since the subtraction is unsigned.
         */
-        for(bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++)
+        uintptr_t ulOffset = CAST_PTR_TO_UINTPTR(pBuffer) - CAST_PTR_TO_UINTPTR(&gBufCtx.b.aabBuffer[0U][0U]);
+
+        if(    (ulOffset < ((uintptr_t)REDCONF_BUFFER_COUNT * REDCONF_BLOCK_SIZE))
+            && ((ulOffset % REDCONF_BLOCK_SIZE) == 0U))
         {
-            if(pBuffer == &gBufCtx.b.aabBuffer[bIdx][0U])
+            uint16_t uIdx = (uint16_t)(ulOffset / REDCONF_BLOCK_SIZE);
+
+            if(    (gBufCtx.aHead[uIdx].ulBlock != BBLK_INVALID)
+                && (gBufCtx.aHead[uIdx].bVolNum == gbRedVolNum))
             {
-                break;
+                *puIdx = uIdx;
+                fRet = true;
             }
         }
-
-        if(    (bIdx < REDCONF_BUFFER_COUNT)
-            && (gBufCtx.aHead[bIdx].ulBlock != BBLK_INVALID)
-            && (gBufCtx.aHead[bIdx].bVolNum == gbRedVolNum))
-        {
-            *pbIdx = bIdx;
-            fRet = true;
-        }
     }
 
     return fRet;
@@ -767,7 +937,7 @@ static bool BufferToIdx(
 #if REDCONF_READ_ONLY == 0
 /** @brief Write out a dirty buffer.
 
-    @param bIdx The index of the buffer to write.
+    @param uIdx The index of the buffer to write.
 
     @return A negated ::REDSTATUS code indicating the operation result.
 
@@ -776,27 +946,27 @@ static bool BufferToIdx(
     @retval -RED_EINVAL Invalid parameters.
 */
 static REDSTATUS BufferWrite(
-    uint8_t     bIdx)
+    uint16_t    uIdx)
 {
     REDSTATUS   ret = 0;
 
-    if(bIdx < REDCONF_BUFFER_COUNT)
+    if(uIdx < REDCONF_BUFFER_COUNT)
     {
-        const BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+        const BUFFERHEAD *pHead = &gBufCtx.aHead[uIdx];
 
         REDASSERT((pHead->uFlags & BFLAG_DIRTY) != 0U);
 
         if((pHead->uFlags & BFLAG_META) != 0U)
         {
-            ret = BufferFinalize(gBufCtx.b.aabBuffer[bIdx], pHead->uFlags);
+            ret = BufferFinalize(gBufCtx.b.aabBuffer[uIdx], pHead->uFlags);
         }
 
         if(ret == 0)
         {
-            ret = RedIoWrite(pHead->bVolNum, pHead->ulBlock, 1U, gBufCtx.b.aabBuffer[bIdx]);
+            ret = RedIoWrite(pHead->bVolNum, pHead->ulBlock, 1U, gBufCtx.b.aabBuffer[uIdx]);
 
           #ifdef REDCONF_ENDIAN_SWAP
-            BufferEndianSwap(gBufCtx.b.aabBuffer[bIdx], pHead->uFlags);
+            BufferEndianSwap(gBufCtx.b.aabBuffer[uIdx], pHead->uFlags);
           #endif
         }
     }
@@ -810,6 +980,168 @@ static REDSTATUS BufferWrite(
 }
 
 
+/** @brief Write out a run of dirty buffers for consecutive blocks.
+
+    @param puIdx        Indexes of the buffers, in block number order.
+    @param ulCount      Number of buffers in the run.  Unless @p fAdjacent is
+                        true, this must not exceed REDCONF_FLUSH_GATHER_BLOCKS.
+    @param fAdjacent    Whether the buffers follow each other in memory, so
+                        that the run can be written straight from them.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EINVAL Invalid parameters.
+*/
+static REDSTATUS BufferWriteRun(
+    const uint16_t *puIdx,
+    uint32_t        ulCount,
+    bool            fAdjacent)
+{
+    REDSTATUS       ret = 0;
+
+    if((puIdx == NULL) || (ulCount == 0U) || (!fAdjacent && (ulCount > REDCONF_FLUSH_GATHER_BLOCKS)))
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else if(ulCount == 1U)
+    {
+        ret = BufferWrite(puIdx[0U]);
+    }
+    else
+    {
+        const BUFFERHEAD   *pFirst = &gBufCtx.aHead[puIdx[0U]];
+        uint32_t            ulFinalized;
+
+        for(ulFinalized = 0U; ulFinalized < ulCount; ulFinalized++)
+        {
+            uint16_t uFlags = gBufCtx.aHead[puIdx[ulFinalized]].uFlags;
+
+            REDASSERT((uFlags & BFLAG_DIRTY) != 0U);
+
+            if((uFlags & BFLAG_META) != 0U)
+            {
+                ret = BufferFinalize(gBufCtx.b.aabBuffer[puIdx[ulFinalized]], uFlags);
+
+                if(ret != 0)
+                {
+                    break;
+                }
+            }
+        }
+
+        if(ret == 0)
+        {
+            if(fAdjacent)
+            {
+                ret = RedIoWrite(pFirst->bVolNum, pFirst->ulBlock, ulCount, gBufCtx.b.aabBuffer[puIdx[0U]]);
+            }
+            else
+            {
+              #if REDCONF_FLUSH_GATHER_BLOCKS > 1U
+                uint32_t ulIdx;
+
+                for(ulIdx = 0U; ulIdx < ulCount; ulIdx++)
+                {
+                    RedMemCpy(gBufCtx.g.aabGather[ulIdx], gBufCtx.b.aabBuffer[puIdx[ulIdx]], REDCONF_BLOCK_SIZE);
+                }
+
+                ret = RedIoWrite(pFirst->bVolNum, pFirst->ulBlock, ulCount, gBufCtx.g.aabGather[0U]);
+              #else
+                /*  Without a bounce buffer, only single buffers and adjacent
+                    runs are written, which are both handled above.
+                */
+                REDERROR();
+                ret = -RED_EINVAL;
+              #endif
+            }
+        }
+
+      #ifdef REDCONF_ENDIAN_SWAP
+        {
+            uint32_t ulIdx;
+
+            /*  Swap the finalized buffers back to native byte order.
+            */
+            for(ulIdx = 0U; ulIdx < ulFinalized; ulIdx++)
+            {
+                BufferEndianSwap(gBufCtx.b.aabBuffer[puIdx[ulIdx]], gBufCtx.aHead[puIdx[ulIdx]].uFlags);
+            }
+        }
+      #endif
+    }
+
+    return ret;
+}
+
+
+/** @brief Sort buffer indexes by the block numbers of their buffers.
+
+    This is a heapsort, which runs in O(n log n) time without recursion or
+    extra memory.
+
+    @param puIdx    The buffer indexes to sort.
+    @param ulCount  Number of buffer indexes.
+*/
+static void BufferSortByBlock(
+    uint16_t   *puIdx,
+    uint32_t    ulCount)
+{
+    uint32_t    ulStart = ulCount / 2U;
+    uint32_t    ulEnd = ulCount;
+
+    while(ulEnd > 1U)
+    {
+        uint32_t ulRoot;
+        uint16_t uRootIdx;
+
+        if(ulStart > 0U)
+        {
+            /*  Building the heap: sift down the next parent.
+            */
+            ulStart--;
+            ulRoot = ulStart;
+        }
+        else
+        {
+            /*  Sorting: move the largest block to the end of the array and
+                sift down the element swapped into the root.
+            */
+            ulEnd--;
+            uRootIdx = puIdx[ulEnd];
+            puIdx[ulEnd] = puIdx[0U];
+            puIdx[0U] = uRootIdx;
+            ulRoot = 0U;
+        }
+
+        uRootIdx = puIdx[ulRoot];
+
+        while(((2U * ulRoot) + 1U) < ulEnd)
+        {
+            uint32_t ulChild = (2U * ulRoot) + 1U;
+
+            if(    ((ulChild + 1U) < ulEnd)
+                && (gBufCtx.aHead[puIdx[ulChild + 1U]].ulBlock > gBufCtx.aHead[puIdx[ulChild]].ulBlock))
+            {
+                ulChild++;
+            }
+
+            if(gBufCtx.aHead[puIdx[ulChild]].ulBlock <= gBufCtx.aHead[uRootIdx].ulBlock)
+            {
+                break;
+            }
+
+            puIdx[ulRoot] = puIdx[ulChild];
+            ulRoot = ulChild;
+        }
+
+        puIdx[ulRoot] = uRootIdx;
+    }
+}
+
+
 /** @brief Finalize a metadata buffer.
 
     This updates the CRC and the sequence number.  It also sets the signature,
@@ -1072,45 +1404,63 @@ static void BufferEndianSwapIndir(
 #endif /* #ifdef REDCONF_ENDIAN_SWAP */
 
 
+/** @brief Remove a buffer from the LRU list.
+
+    The buffer must be put back on the list with BufferMakeLRU() or
+    BufferMakeMRU().
+
+    @param uIdx The index of the buffer to unlink.
+*/
+static void BufferLruUnlink(
+    uint16_t    uIdx)
+{
+    BUFFERHEAD *pHead = &gBufCtx.aHead[uIdx];
+
+    if(pHead->uMoreRecent == BIDX_INVALID)
+    {
+        gBufCtx.uMRU = pHead->uLessRecent;
+    }
+    else
+    {
+        gBufCtx.aHead[pHead->uMoreRecent].uLessRecent = pHead->uLessRecent;
+    }
+
+    if(pHead->uLessRecent == BIDX_INVALID)
+    {
+        gBufCtx.uLRU = pHead->uMoreRecent;
+    }
+    else
+    {
+        gBufCtx.aHead[pHead->uLessRecent].uMoreRecent = pHead->uMoreRecent;
+    }
+}
+
+
 /** @brief Mark a buffer as least recently used.
 
-    @param bIdx The index of the buffer to make LRU.
+    @param uIdx The index of the buffer to make LRU.
 */
 static void BufferMakeLRU(
-    uint8_t bIdx)
+    uint16_t    uIdx)
 {
-    if(bIdx >= REDCONF_BUFFER_COUNT)
+    if(uIdx >= REDCONF_BUFFER_COUNT)
     {
         REDERROR();
     }
-    else if(bIdx != gBufCtx.abMRU[REDCONF_BUFFER_COUNT - 1U])
+    else if(uIdx != gBufCtx.uLRU)
     {
-        uint8_t bMruIdx;
+        BUFFERHEAD *pHead = &gBufCtx.aHead[uIdx];
 
-        /*  Find the current position of the buffer in the MRU array.  We do not
-            need to check the last slot, since we already know from the above
-            check that the index is not there.
+        /*  Move the buffer to the LRU end of the list.  The list holds every
+            buffer, so when the buffer is not LRU, there is an LRU buffer to
+            link it behind.
         */
-        for(bMruIdx = 0U; bMruIdx < (REDCONF_BUFFER_COUNT - 1U); bMruIdx++)
-        {
-            if(bIdx == gBufCtx.abMRU[bMruIdx])
-            {
-                break;
-            }
-        }
+        BufferLruUnlink(uIdx);
 
-        if(bMruIdx < (REDCONF_BUFFER_COUNT - 1U))
-        {
-            /*  Move the buffer index to the back of the MRU array, making it
-                the LRU buffer.
-            */
-            RedMemMove(&gBufCtx.abMRU[bMruIdx], &gBufCtx.abMRU[bMruIdx + 1U], REDCONF_BUFFER_COUNT - ((uint32_t)bMruIdx + 1U));
-            gBufCtx.abMRU[REDCONF_BUFFER_COUNT - 1U] = bIdx;
-        }
-        else
-        {
-            REDERROR();
-        }
+        pHead->uMoreRecent = gBufCtx.uLRU;
+        pHead->uLessRecent = BIDX_INVALID;
+        gBufCtx.aHead[gBufCtx.uLRU].uLessRecent = uIdx;
+        gBufCtx.uLRU = uIdx;
     }
     else
     {
@@ -1122,43 +1472,29 @@ static void BufferMakeLRU(
 
 /** @brief Mark a buffer as most recently used.
 
-    @param bIdx The index of the buffer to make MRU.
+    @param uIdx The index of the buffer to make MRU.
 */
 static void BufferMakeMRU(
-    uint8_t bIdx)
+    uint16_t    uIdx)
 {
-    if(bIdx >= REDCONF_BUFFER_COUNT)
+    if(uIdx >= REDCONF_BUFFER_COUNT)
     {
         REDERROR();
     }
-    else if(bIdx != gBufCtx.abMRU[0U])
+    else if(uIdx != gBufCtx.uMRU)
     {
-        uint8_t bMruIdx;
+        BUFFERHEAD *pHead = &gBufCtx.aHead[uIdx];
 
-        /*  Find the current position of the buffer in the MRU array.  We do not
-            need to check the first slot, since we already know from the above
-            check that the index is not there.
+        /*  Move the buffer to the MRU end of the list.  The list holds every
+            buffer, so when the buffer is not MRU, there is an MRU buffer to
+            link it ahead of.
         */
-        for(bMruIdx = 1U; bMruIdx < REDCONF_BUFFER_COUNT; bMruIdx++)
-        {
-            if(bIdx == gBufCtx.abMRU[bMruIdx])
-            {
-                break;
-            }
-        }
+        BufferLruUnlink(uIdx);
 
-        if(bMruIdx < REDCONF_BUFFER_COUNT)
-        {
-            /*  Move the buffer index to the front of the MRU array, making it
-                the MRU buffer.
-            */
-            RedMemMove(&gBufCtx.abMRU[1U], &gBufCtx.abMRU[0U], bMruIdx);
-            gBufCtx.abMRU[0U] = bIdx;
-        }
-        else
-        {
-            REDERROR();
-        }
+        pHead->uLessRecent = gBufCtx.uMRU;
+        pHead->uMoreRecent = BIDX_INVALID;
+        gBufCtx.aHead[gBufCtx.uMRU].uMoreRecent = uIdx;
+        gBufCtx.uMRU = uIdx;
     }
     else
     {
@@ -1168,39 +1504,111 @@ static void BufferMakeMRU(
 }
 
 
+/** @brief Compute the hash bucket of a block.
+
+    Fibonacci hashing: the key is multiplied by 2^32 divided by the golden
+    ratio and the top bits of the product are kept.  This spreads both runs of
+    consecutive blocks and blocks at regular strides over the buckets.
+
+    @param bVolNum  The volume the block resides on.
+    @param ulBlock  The block number.
+
+    @return The hash bucket, less than BUFFER_HASH_BUCKETS.
+*/
+static uint32_t BufferHash(
+    uint8_t     bVolNum,
+    uint32_t    ulBlock)
+{
+    uint32_t    ulKey = ulBlock ^ ((uint32_t)bVolNum << 24U);
+
+    return (ulKey * 0x9E3779B1U) >> (32U - BUFFER_HASH_BITS);
+}
+
+
+/** @brief Add a buffer to the hash chain of its block.
+
+    @param uIdx The index of the buffer, which must be associated with a block.
+*/
+static void BufferHashInsert(
+    uint16_t    uIdx)
+{
+    BUFFERHEAD *pHead = &gBufCtx.aHead[uIdx];
+    uint32_t    ulBucket;
+
+    REDASSERT(pHead->ulBlock != BBLK_INVALID);
+
+    ulBucket = BufferHash(pHead->bVolNum, pHead->ulBlock);
+
+    pHead->uHashNext = gBufCtx.auHash[ulBucket];
+    gBufCtx.auHash[ulBucket] = uIdx;
+}
+
+
+/** @brief Remove a buffer from the hash chain of its block.
+
+    @param uIdx The index of the buffer, which must be associated with a block.
+*/
+static void BufferHashRemove(
+    uint16_t    uIdx)
+{
+    BUFFERHEAD *pHead = &gBufCtx.aHead[uIdx];
+    uint16_t   *puLink;
+
+    REDASSERT(pHead->ulBlock != BBLK_INVALID);
+
+    /*  Walk the chain to the link which refers to the buffer.
+    */
+    puLink = &gBufCtx.auHash[BufferHash(pHead->bVolNum, pHead->ulBlock)];
+    while((*puLink != uIdx) && (*puLink != BIDX_INVALID))
+    {
+        puLink = &gBufCtx.aHead[*puLink].uHashNext;
+    }
+
+    if(*puLink == uIdx)
+    {
+        *puLink = pHead->uHashNext;
+        pHead->uHashNext = BIDX_INVALID;
+    }
+    else
+    {
+        REDERROR();
+    }
+}
+
+
 /** @brief Find a block in the buffers.
 
     @param ulBlock  The block number to find.
-    @param pbIdx    If the block is buffered (true is returned), populated with
+    @param puIdx    If the block is buffered (true is returned), populated with
                     the index of the buffer.
 
     @return Boolean indicating whether or not the block is buffered.
 
     @retval true    @p ulBlock is buffered, and its index has been stored in
-                    @p pbIdx.
+                    @p puIdx.
     @retval false   @p ulBlock is not buffered.
 */
 static bool BufferFind(
-    uint32_t ulBlock,
-    uint8_t *pbIdx)
+    uint32_t    ulBlock,
+    uint16_t   *puIdx)
 {
-    bool     ret = false;
+    bool        ret = false;
 
-    if((ulBlock >= gpRedVolume->ulBlockCount) || (pbIdx == NULL))
+    if((ulBlock >= gpRedVolume->ulBlockCount) || (puIdx == NULL))
     {
         REDERROR();
     }
     else
     {
-        uint8_t bIdx;
+        uint16_t uIdx;
 
-        for(bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++)
+        for(uIdx = gBufCtx.auHash[BufferHash(gbRedVolNum, ulBlock)]; uIdx != BIDX_INVALID; uIdx = gBufCtx.aHead[uIdx].uHashNext)
         {
-            const BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+            const BUFFERHEAD *pHead = &gBufCtx.aHead[uIdx];
 
             if((pHead->bVolNum == gbRedVolNum) && (pHead->ulBlock == ulBlock))
             {
-                *pbIdx = bIdx;
+                *puIdx = uIdx;
                 ret = true;
                 break;
             }
@@ -1210,3 +1618,59 @@ static bool BufferFind(
     return ret;
 }
 
+
+/** @brief Find the next buffer for the active volume in a range of blocks.
+
+    When the range is smaller than the cache, each block of the range is looked
+    up in the hash table; otherwise, the buffer heads are scanned.  Either way,
+    the cost is bounded by the smaller of the range and the cache, and buffers
+    found by earlier calls may be invalidated or moved without disturbing the
+    iteration.
+
+    @param ulBlockStart Starting block number of the range.
+    @param ulBlockCount Count of blocks in the range.
+    @param pulCursor    Iteration state; must be zero for the first call, and
+                        is updated by each call.
+    @param puIdx        If a buffer is found (true is returned), populated with
+                        its index.
+
+    @return Boolean indicating whether another buffer was found.
+*/
+static bool BufferFindInRange(
+    uint32_t    ulBlockStart,
+    uint32_t    ulBlockCount,
+    uint32_t   *pulCursor,
+    uint16_t   *puIdx)
+{
+    bool        fFound = false;
+
+    if(ulBlockCount < REDCONF_BUFFER_COUNT)
+    {
+        while(!fFound && (*pulCursor < ulBlockCount))
+        {
+            fFound = BufferFind(ulBlockStart + *pulCursor, puIdx);
+            (*pulCursor)++;
+        }
+    }
+    else
+    {
+        while(!fFound && (*pulCursor < REDCONF_BUFFER_COUNT))
+        {
+            const BUFFERHEAD *pHead = &gBufCtx.aHead[*pulCursor];
+
+            if(    (pHead->bVolNum == gbRedVolNum)
+                && (pHead->ulBlock != BBLK_INVALID)
+                && (pHead->ulBlock >= ulBlockStart)
+                && (pHead->ulBlock < (ulBlockStart + ulBlockCount)))
+            {
+                *puIdx = (uint16_t)*pulCursor;
+                fFound = true;
+            }
+
+            (*pulCursor)++;
+        }
+    }
+
+    return fFound;
+}
+
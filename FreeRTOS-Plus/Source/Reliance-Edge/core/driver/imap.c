@@ -33,6 +33,15 @@
 #include <redcore.h>
 
 
+#if REDCONF_READ_ONLY == 0
+static REDSTATUS ImapBlockFind(uint32_t ulBlockStart, uint32_t ulBlockEnd, bool fFree, uint32_t *pulBlock);
+static REDSTATUS ImapFindFree(uint32_t ulBlockStart, uint32_t ulBlockEnd, uint32_t *pulBlock);
+#if REDCONF_IMAP_SUMMARY_GROUPS > 0U
+static uint32_t ImapSummaryGroup(uint32_t ulBlock);
+#endif
+#endif
+
+
 /** @brief Get the allocation bit of a block from either metaroot.
 
     Will pass the call down either to the inline imap or to the external imap
@@ -165,6 +174,11 @@ REDSTATUS RedImapBlockSet(
         if(fAllocated)
         {
             gpRedMR->ulFreeBlocks--;
+
+          #if REDCONF_IMAP_SUMMARY_GROUPS > 0U
+            REDASSERT(gpRedCoreVol->aulSummaryFree[ImapSummaryGroup(ulBlock)] > 0U);
+            gpRedCoreVol->aulSummaryFree[ImapSummaryGroup(ulBlock)]--;
+          #endif
         }
         else
         {
@@ -182,10 +196,18 @@ REDSTATUS RedImapBlockSet(
                 if(fWasAllocated)
                 {
                     gpRedCoreVol->ulAlmostFreeBlocks++;
+
+                  #if REDCONF_IMAP_SUMMARY_GROUPS > 0U
+                    gpRedCoreVol->aulSummaryAlmostFree[ImapSummaryGroup(ulBlock)]++;
+                  #endif
                 }
                 else
                 {
                     gpRedMR->ulFreeBlocks++;
+
+                  #if REDCONF_IMAP_SUMMARY_GROUPS > 0U
+                    gpRedCoreVol->aulSummaryFree[ImapSummaryGroup(ulBlock)]++;
+                  #endif
                 }
             }
         }
@@ -217,58 +239,226 @@ REDSTATUS RedImapAllocBlock(
         REDERROR();
         ret = -RED_EINVAL;
     }
+    else
+    {
+        uint32_t ulCount;
+
+        ret = RedImapAllocExtent(1U, pulBlock, &ulCount);
+    }
+
+    return ret;
+}
+
+
+/** @brief Allocate a run of contiguous blocks.
+
+    The run starts at the first free block at or after the next block to
+    allocate, wrapping around at the end of the volume, and extends over the
+    free blocks which immediately follow it, up to @p ulMaxBlocks.  The run is
+    cut short by a block which is not free or by the end of the volume, so
+    fewer blocks than requested may be allocated.
+
+    The caller is responsible for ensuring that @p ulMaxBlocks does not exceed
+    the free blocks it is entitled to use, such as when blocks are reserved.
+
+    @param ulMaxBlocks  The maximum number of blocks to allocate.
+    @param pulBlock     On successful return, populated with the first
+                        allocated block number.
+    @param pulCount     On successful return, populated with the number of
+                        blocks allocated, which is between one and
+                        @p ulMaxBlocks.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p ulMaxBlocks is zero; or @p pulBlock or @p pulCount
+                        is `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_ENOSPC Insufficient free space to perform the allocation.
+*/
+REDSTATUS RedImapAllocExtent(
+    uint32_t    ulMaxBlocks,
+    uint32_t   *pulBlock,
+    uint32_t   *pulCount)
+{
+    REDSTATUS   ret;
+
+    if((ulMaxBlocks == 0U) || (pulBlock == NULL) || (pulCount == NULL))
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
     else if(gpRedMR->ulFreeBlocks == 0U)
     {
         ret = -RED_ENOSPC;
     }
     else
     {
-        uint32_t ulStopBlock = gpRedMR->ulAllocNextBlock;
-        bool     fAllocated = false;
+        uint32_t ulStart;
+
+        /*  Search from the next block to the end of the volume, then wrap
+            around and search the blocks before it.
+        */
+        ret = ImapFindFree(gpRedMR->ulAllocNextBlock, gpRedVolume->ulBlockCount, &ulStart);
+        CRITICAL_ASSERT(ret == 0);
+
+        if((ret == 0) && (ulStart == gpRedVolume->ulBlockCount))
+        {
+            ret = ImapFindFree(gpRedCoreVol->ulFirstAllocableBN, gpRedMR->ulAllocNextBlock, &ulStart);
+            CRITICAL_ASSERT(ret == 0);
+
+            if((ret == 0) && (ulStart == gpRedMR->ulAllocNextBlock))
+            {
+                /*  The free block count was already determined to be non-zero,
+                    no error occurred while looking for free blocks, but no free
+                    blocks were found.  This indicates metadata corruption.
+                */
+                CRITICAL_ERROR();
+                ret = -RED_EFUBAR;
+            }
+        }
 
-        do
+        if(ret == 0)
         {
-            ALLOCSTATE state;
+            uint32_t ulLimit;
+            uint32_t ulEnd;
+
+            if((gpRedVolume->ulBlockCount - ulStart) < ulMaxBlocks)
+            {
+                ulLimit = gpRedVolume->ulBlockCount;
+            }
+            else
+            {
+                ulLimit = ulStart + ulMaxBlocks;
+            }
 
-            ret = RedImapBlockState(gpRedMR->ulAllocNextBlock, &state);
+            /*  The first block is known to be free; the run ends at the next
+                block which is not.
+            */
+            ret = ImapBlockFind(ulStart + 1U, ulLimit, false, &ulEnd);
             CRITICAL_ASSERT(ret == 0);
 
             if(ret == 0)
             {
-                if(state == ALLOCSTATE_FREE)
+                uint32_t ulBlock;
+
+                for(ulBlock = ulStart; (ret == 0) && (ulBlock < ulEnd); ulBlock++)
                 {
-                    ret = RedImapBlockSet(gpRedMR->ulAllocNextBlock, true);
+                    ret = RedImapBlockSet(ulBlock, true);
                     CRITICAL_ASSERT(ret == 0);
-
-                    *pulBlock = gpRedMR->ulAllocNextBlock;
-                    fAllocated = true;
                 }
 
-                /*  Increment the next block number, wrapping it when the end of
-                    the volume is reached.
-                */
-                gpRedMR->ulAllocNextBlock++;
-                if(gpRedMR->ulAllocNextBlock == gpRedVolume->ulBlockCount)
+                if(ret == 0)
                 {
-                    gpRedMR->ulAllocNextBlock = gpRedCoreVol->ulFirstAllocableBN;
+                    *pulBlock = ulStart;
+                    *pulCount = ulEnd - ulStart;
+
+                    /*  Continue after the run next time, wrapping the block
+                        number when the end of the volume is reached.
+                    */
+                    if(ulEnd == gpRedVolume->ulBlockCount)
+                    {
+                        gpRedMR->ulAllocNextBlock = gpRedCoreVol->ulFirstAllocableBN;
+                    }
+                    else
+                    {
+                        gpRedMR->ulAllocNextBlock = ulEnd;
+                    }
                 }
             }
         }
-        while((ret == 0) && !fAllocated && (gpRedMR->ulAllocNextBlock != ulStopBlock));
+    }
 
-        if((ret == 0) && !fAllocated)
+    return ret;
+}
+
+
+#if REDCONF_IMAP_SUMMARY_GROUPS > 0U
+/** @brief Rebuild the free space summary from the imap.
+
+    The summary counts the free and almost free blocks in each group of
+    allocable blocks, so that the allocator can skip groups without free blocks
+    instead of searching them.  It is rebuilt when the volume is mounted, at
+    which point both metaroots are identical and no blocks are almost free.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+REDSTATUS RedImapSummaryRebuild(void)
+{
+    REDSTATUS   ret = 0;
+    uint32_t    ulGroup;
+    uint32_t    ulBlock = gpRedCoreVol->ulFirstAllocableBN;
+
+    gpRedCoreVol->ulSummaryGroupBlocks = (gpRedVolume->ulBlocksAllocable + (REDCONF_IMAP_SUMMARY_GROUPS - 1U)) / REDCONF_IMAP_SUMMARY_GROUPS;
+    if(gpRedCoreVol->ulSummaryGroupBlocks == 0U)
+    {
+        gpRedCoreVol->ulSummaryGroupBlocks = 1U;
+    }
+
+    for(ulGroup = 0U; ulGroup < REDCONF_IMAP_SUMMARY_GROUPS; ulGroup++)
+    {
+        gpRedCoreVol->aulSummaryFree[ulGroup] = 0U;
+        gpRedCoreVol->aulSummaryAlmostFree[ulGroup] = 0U;
+    }
+
+    /*  Alternate between finding the start and the end of each run of free
+        blocks, crediting each run to the groups it spans.
+    */
+    while((ret == 0) && (ulBlock < gpRedVolume->ulBlockCount))
+    {
+        uint32_t ulRunStart;
+
+        ret = ImapBlockFind(ulBlock, gpRedVolume->ulBlockCount, true, &ulRunStart);
+
+        if(ret == 0)
         {
-            /*  The free block count was already determined to be non-zero, no
-                error occurred while looking for free blocks, but no free blocks
-                were found.  This indicates metadata corruption.
-            */
-            CRITICAL_ERROR();
-            ret = -RED_EFUBAR;
+            ulBlock = ulRunStart;
+
+            if(ulRunStart < gpRedVolume->ulBlockCount)
+            {
+                ret = ImapBlockFind(ulRunStart + 1U, gpRedVolume->ulBlockCount, false, &ulBlock);
+            }
+        }
+
+        while((ret == 0) && (ulRunStart < ulBlock))
+        {
+            uint32_t ulGroupEnd;
+
+            ulGroup = ImapSummaryGroup(ulRunStart);
+            ulGroupEnd = gpRedCoreVol->ulFirstAllocableBN + ((ulGroup + 1U) * gpRedCoreVol->ulSummaryGroupBlocks);
+            if(ulGroupEnd > ulBlock)
+            {
+                ulGroupEnd = ulBlock;
+            }
+
+            gpRedCoreVol->aulSummaryFree[ulGroup] += ulGroupEnd - ulRunStart;
+            ulRunStart = ulGroupEnd;
         }
     }
 
     return ret;
 }
+
+
+/** @brief Update the free space summary for a transaction point.
+
+    Blocks which were almost free become free once the transaction is
+    committed, just as the metaroot free block count is updated.
+*/
+void RedImapSummaryTransact(void)
+{
+    uint32_t ulGroup;
+
+    for(ulGroup = 0U; ulGroup < REDCONF_IMAP_SUMMARY_GROUPS; ulGroup++)
+    {
+        gpRedCoreVol->aulSummaryFree[ulGroup] += gpRedCoreVol->aulSummaryAlmostFree[ulGroup];
+        gpRedCoreVol->aulSummaryAlmostFree[ulGroup] = 0U;
+    }
+}
+#endif /* REDCONF_IMAP_SUMMARY_GROUPS > 0U */
 #endif /* REDCONF_READ_ONLY == 0 */
 
 
@@ -347,3 +537,164 @@ REDSTATUS RedImapBlockState(
     return ret;
 }
 
+
+#if REDCONF_READ_ONLY == 0
+/** @brief Find the first free block, or the first block which is not free, in
+           a range of blocks.
+
+    Will pass the call down either to the inline imap or to the external imap
+    implementation, whichever is appropriate for the current volume.
+
+    @param ulBlockStart The first block to examine.
+    @param ulBlockEnd   The block after the last block to examine.
+    @param fFree        Whether to find a free block (true) or a block which is
+                        not free (false).
+    @param pulBlock     On successful return, populated with the first matching
+                        block, or @p ulBlockEnd if no block in the range
+                        matches.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL The range is invalid; or @p pulBlock is `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+static REDSTATUS ImapBlockFind(
+    uint32_t    ulBlockStart,
+    uint32_t    ulBlockEnd,
+    bool        fFree,
+    uint32_t   *pulBlock)
+{
+    REDSTATUS   ret;
+
+    if(    (ulBlockStart < gpRedCoreVol->ulInodeTableStartBN)
+        || (ulBlockStart > ulBlockEnd)
+        || (ulBlockEnd > gpRedVolume->ulBlockCount)
+        || (pulBlock == NULL))
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+      #if (REDCONF_IMAP_INLINE == 1) && (REDCONF_IMAP_EXTERNAL == 1)
+        if(gpRedCoreVol->fImapInline)
+        {
+            ret = RedImapIBlockFind(ulBlockStart, ulBlockEnd, fFree, pulBlock);
+        }
+        else
+        {
+            ret = RedImapEBlockFind(ulBlockStart, ulBlockEnd, fFree, pulBlock);
+        }
+      #elif REDCONF_IMAP_INLINE == 1
+        ret = RedImapIBlockFind(ulBlockStart, ulBlockEnd, fFree, pulBlock);
+      #else
+        ret = RedImapEBlockFind(ulBlockStart, ulBlockEnd, fFree, pulBlock);
+      #endif
+    }
+
+    return ret;
+}
+
+
+/** @brief Find the first free block in a range of allocable blocks.
+
+    When the free space summary is enabled, groups of blocks without free
+    blocks are skipped without examining the imap.
+
+    @param ulBlockStart The first block to examine.
+    @param ulBlockEnd   The block after the last block to examine.
+    @param pulBlock     On successful return, populated with the first free
+                        block, or @p ulBlockEnd if no block in the range is
+                        free.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL The range is invalid; or @p pulBlock is `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+static REDSTATUS ImapFindFree(
+    uint32_t    ulBlockStart,
+    uint32_t    ulBlockEnd,
+    uint32_t   *pulBlock)
+{
+    REDSTATUS   ret;
+
+  #if REDCONF_IMAP_SUMMARY_GROUPS > 0U
+    if(    (ulBlockStart < gpRedCoreVol->ulFirstAllocableBN)
+        || (ulBlockStart > ulBlockEnd)
+        || (ulBlockEnd > gpRedVolume->ulBlockCount)
+        || (pulBlock == NULL))
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        uint32_t ulBlock = ulBlockStart;
+        uint32_t ulFound = ulBlockEnd;
+
+        ret = 0;
+
+        while((ret == 0) && (ulFound == ulBlockEnd) && (ulBlock < ulBlockEnd))
+        {
+            uint32_t ulGroup = ImapSummaryGroup(ulBlock);
+            uint32_t ulGroupEnd = gpRedCoreVol->ulFirstAllocableBN + ((ulGroup + 1U) * gpRedCoreVol->ulSummaryGroupBlocks);
+
+            if(ulGroupEnd > ulBlockEnd)
+            {
+                ulGroupEnd = ulBlockEnd;
+            }
+
+            if(gpRedCoreVol->aulSummaryFree[ulGroup] > 0U)
+            {
+                uint32_t ulGroupFound;
+
+                ret = ImapBlockFind(ulBlock, ulGroupEnd, true, &ulGroupFound);
+
+                if((ret == 0) && (ulGroupFound < ulGroupEnd))
+                {
+                    ulFound = ulGroupFound;
+                }
+            }
+
+            ulBlock = ulGroupEnd;
+        }
+
+        if(ret == 0)
+        {
+            *pulBlock = ulFound;
+        }
+    }
+  #else
+    ret = ImapBlockFind(ulBlockStart, ulBlockEnd, true, pulBlock);
+  #endif
+
+    return ret;
+}
+
+
+#if REDCONF_IMAP_SUMMARY_GROUPS > 0U
+/** @brief Determine which free space summary group an allocable block is in.
+
+    @param ulBlock  The allocable block number.
+
+    @return The index of the group which contains @p ulBlock.
+*/
+static uint32_t ImapSummaryGroup(
+    uint32_t    ulBlock)
+{
+    uint32_t    ulGroup;
+
+    REDASSERT(ulBlock >= gpRedCoreVol->ulFirstAllocableBN);
+
+    ulGroup = (ulBlock - gpRedCoreVol->ulFirstAllocableBN) / gpRedCoreVol->ulSummaryGroupBlocks;
+
+    REDASSERT(ulGroup < REDCONF_IMAP_SUMMARY_GROUPS);
+
+    return ulGroup;
+}
+#endif
+#endif /* REDCONF_READ_ONLY == 0 */
+
@@ -173,6 +173,103 @@ REDSTATUS RedImapEBlockSet(
 }
 
 
+/** @brief Find the first free block, or the first block which is not free, in
+           a range of blocks.
+
+    A block is free when its allocation bit is clear in the imaps of both
+    metaroots.  Each imap node in the range is buffered once and searched a word
+    at a time, rather than buffered once per block.
+
+    @param ulBlockStart The first block to examine.
+    @param ulBlockEnd   The block after the last block to examine.
+    @param fFree        Whether to find a free block (true) or a block which is
+                        not free (false).
+    @param pulBlock     On successful return, populated with the first matching
+                        block, or @p ulBlockEnd if no block in the range
+                        matches.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL The range is invalid; or @p pulBlock is `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+REDSTATUS RedImapEBlockFind(
+    uint32_t    ulBlockStart,
+    uint32_t    ulBlockEnd,
+    bool        fFree,
+    uint32_t   *pulBlock)
+{
+    REDSTATUS   ret = 0;
+
+    if(    gpRedCoreVol->fImapInline
+        || (ulBlockStart < gpRedCoreVol->ulInodeTableStartBN)
+        || (ulBlockStart > ulBlockEnd)
+        || (ulBlockEnd > gpRedVolume->ulBlockCount)
+        || (pulBlock == NULL))
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        uint32_t    ulOffset = ulBlockStart - gpRedCoreVol->ulInodeTableStartBN;
+        uint32_t    ulOffsetEnd = ulBlockEnd - gpRedCoreVol->ulInodeTableStartBN;
+        uint32_t    ulFound = ulOffsetEnd;
+
+        while((ret == 0) && (ulFound == ulOffsetEnd) && (ulOffset < ulOffsetEnd))
+        {
+            uint32_t    ulImapNode = ulOffset / IMAPNODE_ENTRIES;
+            uint32_t    ulNodeStart = ulImapNode * IMAPNODE_ENTRIES;
+            uint32_t    ulNodeEnd = ((ulOffsetEnd - ulNodeStart) < IMAPNODE_ENTRIES) ? ulOffsetEnd : (ulNodeStart + IMAPNODE_ENTRIES);
+            IMAPNODE   *pImapCur;
+
+            ret = RedBufferGet(RedImapNodeBlock(gpRedCoreVol->bCurMR, ulImapNode), BFLAG_META_IMAP, CAST_VOID_PTR_PTR(&pImapCur));
+
+            if(ret == 0)
+            {
+                IMAPNODE *pImapOld = pImapCur;
+
+                /*  If the imap node is not branched, then both copies of the
+                    imap are identical and the current copy serves for both.
+                */
+                if(ImapNodeIsBranched(ulImapNode))
+                {
+                    ret = RedBufferGet(RedImapNodeBlock(1U - gpRedCoreVol->bCurMR, ulImapNode), BFLAG_META_IMAP, CAST_VOID_PTR_PTR(&pImapOld));
+                }
+
+                if(ret == 0)
+                {
+                    uint32_t ulEntry = RedBitFind(pImapCur->abEntries, pImapOld->abEntries,
+                                                  ulOffset - ulNodeStart, ulNodeEnd - ulNodeStart, !fFree);
+
+                    if(ulEntry < (ulNodeEnd - ulNodeStart))
+                    {
+                        ulFound = ulNodeStart + ulEntry;
+                    }
+
+                    if(pImapOld != pImapCur)
+                    {
+                        RedBufferPut(pImapOld);
+                    }
+                }
+
+                RedBufferPut(pImapCur);
+            }
+
+            ulOffset = ulNodeEnd;
+        }
+
+        if(ret == 0)
+        {
+            *pulBlock = gpRedCoreVol->ulInodeTableStartBN + ulFound;
+        }
+    }
+
+    return ret;
+}
+
+
 /** @brief Branch an imap node and get a buffer for it.
 
     If the imap node is already branched, it can be overwritten in its current
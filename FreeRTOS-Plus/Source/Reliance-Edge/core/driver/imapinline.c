@@ -127,6 +127,55 @@ REDSTATUS RedImapIBlockSet(
 
     return ret;
 }
+
+
+/** @brief Find the first free block, or the first block which is not free, in
+           a range of blocks.
+
+    A block is free when its allocation bit is clear in both metaroots.
+
+    @param ulBlockStart The first block to examine.
+    @param ulBlockEnd   The block after the last block to examine.
+    @param fFree        Whether to find a free block (true) or a block which is
+                        not free (false).
+    @param pulBlock     On successful return, populated with the first matching
+                        block, or @p ulBlockEnd if no block in the range
+                        matches.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL The range is invalid; @p pulBlock is `NULL`; or the
+                        current volume does not use the inline imap.
+*/
+REDSTATUS RedImapIBlockFind(
+    uint32_t    ulBlockStart,
+    uint32_t    ulBlockEnd,
+    bool        fFree,
+    uint32_t   *pulBlock)
+{
+    REDSTATUS   ret;
+
+    if(    (!gpRedCoreVol->fImapInline)
+        || (ulBlockStart < gpRedCoreVol->ulInodeTableStartBN)
+        || (ulBlockStart > ulBlockEnd)
+        || (ulBlockEnd > gpRedVolume->ulBlockCount)
+        || (pulBlock == NULL))
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        uint32_t ulBase = gpRedCoreVol->ulInodeTableStartBN;
+
+        *pulBlock = ulBase + RedBitFind(gpRedCoreVol->aMR[0U].abEntries, gpRedCoreVol->aMR[1U].abEntries,
+                                        ulBlockStart - ulBase, ulBlockEnd - ulBase, !fFree);
+        ret = 0;
+    }
+
+    return ret;
+}
 #endif
 
 #endif /* REDCONF_IMAP_INLINE == 1 */
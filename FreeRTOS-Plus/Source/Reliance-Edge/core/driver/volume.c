@@ -249,6 +249,19 @@ REDSTATUS RedVolMountMetaroot(void)
         ret = RedVolSeqNumIncrement();
     }
 
+  #if (REDCONF_READ_ONLY == 0) && (REDCONF_IMAP_SUMMARY_GROUPS > 0U)
+    /*  The free space summary is rebuilt with both metaroots identical, as
+        they will be once mounted, and before the volume is marked as mounted,
+        since rebuilding may fail.
+    */
+    if(ret == 0)
+    {
+        gpRedCoreVol->aMR[1U - gpRedCoreVol->bCurMR] = *gpRedMR;
+
+        ret = RedImapSummaryRebuild();
+    }
+  #endif
+
     if(ret == 0)
     {
         gpRedVolume->fMounted = true;
@@ -361,6 +374,9 @@ REDSTATUS RedVolTransact(void)
     {
         gpRedMR->ulFreeBlocks += gpRedCoreVol->ulAlmostFreeBlocks;
         gpRedCoreVol->ulAlmostFreeBlocks = 0U;
+      #if REDCONF_IMAP_SUMMARY_GROUPS > 0U
+        RedImapSummaryTransact();
+      #endif
 
         ret = RedBufferFlush(0U, gpRedVolume->ulBlockCount);
 
@@ -93,6 +93,7 @@ REDSTATUS RedBufferGet(uint32_t ulBlock, uint16_t uFlags, void **ppBuffer);
 void RedBufferPut(const void *pBuffer);
 #if REDCONF_READ_ONLY == 0
 REDSTATUS RedBufferFlush(uint32_t ulBlockStart, uint32_t ulBlockCount);
+void RedBufferFlushStats(uint32_t *pulBlocks, uint32_t *pulWrites);
 void RedBufferDirty(const void *pBuffer);
 void RedBufferBranch(const void *pBuffer, uint32_t ulBlockNew);
 #if (REDCONF_API_POSIX == 1) || FORMAT_SUPPORTED
@@ -116,17 +117,24 @@ REDSTATUS RedImapBlockGet(uint8_t bMR, uint32_t ulBlock, bool *pfAllocated);
 #if REDCONF_READ_ONLY == 0
 REDSTATUS RedImapBlockSet(uint32_t ulBlock, bool fAllocated);
 REDSTATUS RedImapAllocBlock(uint32_t *pulBlock);
+REDSTATUS RedImapAllocExtent(uint32_t ulMaxBlocks, uint32_t *pulBlock, uint32_t *pulCount);
+#endif
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_IMAP_SUMMARY_GROUPS > 0U)
+REDSTATUS RedImapSummaryRebuild(void);
+void RedImapSummaryTransact(void);
 #endif
 REDSTATUS RedImapBlockState(uint32_t ulBlock, ALLOCSTATE *pState);
 
 #if REDCONF_IMAP_INLINE == 1
 REDSTATUS RedImapIBlockGet(uint8_t bMR, uint32_t ulBlock, bool *pfAllocated);
 REDSTATUS RedImapIBlockSet(uint32_t ulBlock, bool fAllocated);
+REDSTATUS RedImapIBlockFind(uint32_t ulBlockStart, uint32_t ulBlockEnd, bool fFree, uint32_t *pulBlock);
 #endif
 
 #if REDCONF_IMAP_EXTERNAL == 1
 REDSTATUS RedImapEBlockGet(uint8_t bMR, uint32_t ulBlock, bool *pfAllocated);
 REDSTATUS RedImapEBlockSet(uint32_t ulBlock, bool fAllocated);
+REDSTATUS RedImapEBlockFind(uint32_t ulBlockStart, uint32_t ulBlockEnd, bool fFree, uint32_t *pulBlock);
 uint32_t RedImapNodeBlock(uint8_t bMR, uint32_t ulImapNode);
 #endif
 
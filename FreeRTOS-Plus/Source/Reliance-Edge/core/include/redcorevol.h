@@ -78,6 +78,21 @@ typedef struct
     */
     bool        fUseReservedBlocks;
   #endif
+
+  #if (REDCONF_READ_ONLY == 0) && (REDCONF_IMAP_SUMMARY_GROUPS > 0U)
+    /** The number of allocable blocks in each free space summary group; the
+        last group may be smaller.
+    */
+    uint32_t    ulSummaryGroupBlocks;
+
+    /** The number of free blocks in each free space summary group.
+    */
+    uint32_t    aulSummaryFree[REDCONF_IMAP_SUMMARY_GROUPS];
+
+    /** The number of almost free blocks in each free space summary group.
+    */
+    uint32_t    aulSummaryAlmostFree[REDCONF_IMAP_SUMMARY_GROUPS];
+  #endif
 } COREVOLUME;
 
 /*  Pointer to the core volume currently being accessed; populated during
@@ -172,6 +172,38 @@
   #error "Configuration error: REDCONF_CHECKER must be defined."
 #endif
 
+/*  The options below are not written by the Configuration Utility.  A redconf.h
+    which does not define them gets these defaults.
+*/
+
+/*  Most blocks RedBufferFlush() gathers into one write when their buffers are
+    not adjacent in memory.  Such blocks are copied into a bounce buffer of
+    this many blocks, so each one costs REDCONF_BLOCK_SIZE bytes of RAM.  With
+    the default of 1, there is no bounce buffer, and only runs of blocks whose
+    buffers are adjacent in memory are written together.
+*/
+#ifndef REDCONF_FLUSH_GATHER_BLOCKS
+  #define REDCONF_FLUSH_GATHER_BLOCKS 1U
+#endif
+
+/*  Set REDCONF_MEMORY_SIMD to 1 to let RedMemCpy(), RedMemSet() and
+    RedMemCmp() use 16-byte SSE2 or NEON loads and stores, where the compiler
+    targets them.  These need no alignment, so unlike the word loops they also
+    help buffers whose addresses differ in alignment.
+*/
+#ifndef REDCONF_MEMORY_SIMD
+  #define REDCONF_MEMORY_SIMD 0
+#endif
+
+/*  The number of groups the allocable blocks are divided into for the in-memory
+    free space summary, which lets the allocator skip groups without free
+    blocks on a nearly full volume.  Each group costs eight bytes of RAM per
+    volume.  Zero disables the summary.
+*/
+#ifndef REDCONF_IMAP_SUMMARY_GROUPS
+  #define REDCONF_IMAP_SUMMARY_GROUPS 0U
+#endif
+
 
 #if (REDCONF_READ_ONLY != 0) && (REDCONF_READ_ONLY != 1)
   #error "Configuration error: REDCONF_READ_ONLY must be either 0 or 1"
@@ -304,6 +336,9 @@
 #if (REDCONF_IMAP_INLINE == 0) && (REDCONF_IMAP_EXTERNAL == 0)
   #error "Configuration error: At least one of REDCONF_IMAP_INLINE and REDCONF_IMAP_EXTERNAL must be set"
 #endif
+#if REDCONF_IMAP_SUMMARY_GROUPS > 65535U
+  #error "Configuration error: REDCONF_IMAP_SUMMARY_GROUPS cannot be greater than 65535."
+#endif
 
 #if (REDCONF_OUTPUT != 0) && (REDCONF_OUTPUT != 1)
   #error "Configuration error: REDCONF_OUTPUT must be either 0 or 1."
@@ -324,10 +359,15 @@
   #error "Configuration error: REDCONF_DISCARDS must be either 0 or 1."
 #endif
 
-/*  REDCONF_BUFFER_COUNT lower limit checked in buffer.c
+/*  REDCONF_BUFFER_COUNT lower limit checked in buffer.c.  Buffers are indexed
+    with 16-bit values, one of which is reserved as an invalid index.
 */
-#if REDCONF_BUFFER_COUNT > 255U
-  #error "REDCONF_BUFFER_COUNT cannot be greater than 255"
+#if REDCONF_BUFFER_COUNT > 65535U
+  #error "REDCONF_BUFFER_COUNT cannot be greater than 65535"
+#endif
+
+#if (REDCONF_FLUSH_GATHER_BLOCKS < 1U) || (REDCONF_FLUSH_GATHER_BLOCKS > REDCONF_BUFFER_COUNT)
+  #error "Configuration error: REDCONF_FLUSH_GATHER_BLOCKS must be between 1 and REDCONF_BUFFER_COUNT."
 #endif
 
 #if (REDCONF_IMAGE_BUILDER != 0) && (REDCONF_IMAGE_BUILDER != 1)
@@ -338,6 +378,10 @@
   #error "Configuration error: REDCONF_CHECKER must be either 0 or 1."
 #endif
 
+#if (REDCONF_MEMORY_SIMD != 0) && (REDCONF_MEMORY_SIMD != 1)
+  #error "Configuration error: REDCONF_MEMORY_SIMD must be either 0 or 1."
+#endif
+
 
 #if (REDCONF_DISCARDS == 1) && (RED_KIT == RED_KIT_GPL)
   #error "REDCONF_DISCARDS not supported in Reliance Edge under GPL. Contact sales@datalight.com to upgrade."
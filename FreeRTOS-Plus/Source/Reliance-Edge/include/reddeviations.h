@@ -119,6 +119,17 @@
 #define CAST_CONST_UINT32_PTR(PTR) ((const uint32_t *)(const void *)(PTR))
 
 
+/** @brief Cast a pointer to a uint32_t pointer.
+
+    The non-const counterpart of CAST_CONST_UINT32_PTR(), used by the
+    word-at-a-time loops in memory.c once the pointer has been aligned to a
+    uint32_t.  The same deviations, from MISRA C:2012 Rule 11.5 (advisory) and
+    Rule 11.3 (required), apply; as Rule 11.3 is required, a separate deviation
+    record is required.
+*/
+#define CAST_UINT32_PTR(PTR) ((uint32_t *)(void *)(PTR))
+
+
 /** @brief Cast a pointer to a pointer to (void **).
 
     Usages of this macro deviate from MISRA C:2012 Rule 11.3 (required).
@@ -220,5 +231,25 @@
 #define IS_ALIGNED_PTR(ptr) (((uintptr_t)(ptr) & (REDCONF_ALIGNMENT_SIZE - 1U)) == 0U)
 
 
+/** @brief Cast a pointer to an unsigned integer.
+
+    This is used in buffer.c to derive the index of a block buffer from a
+    pointer into the buffer array in constant time.  The alternatives are to
+    compare the pointer against every buffer, which costs time proportional to
+    the number of buffers, or to use relational pointer comparisons, which are
+    undefined unless both pointers point into the same array.
+
+    Usages of this macro deviate from MISRA C:2012 Rule 11.4 (advisory).  As
+    with IS_ALIGNED_PTR(), uintptr_t can represent the pointer, and the integer
+    is only used in arithmetic and comparisons: it is never converted back into
+    a pointer.
+
+    As Rule 11.4 is advisory, a deviation record is not required.  This notice
+    and the PC-Lint error inhibition option are the only records of the
+    deviation.
+*/
+#define CAST_PTR_TO_UINTPTR(PTR) ((uintptr_t)(PTR))
+
+
 #endif
 
@@ -57,6 +57,7 @@ uint32_t RedNameLen(const char *pszName);
 bool RedBitGet(const uint8_t *pbBitmap, uint32_t ulBit);
 void RedBitSet(uint8_t *pbBitmap, uint32_t ulBit);
 void RedBitClear(uint8_t *pbBitmap, uint32_t ulBit);
+uint32_t RedBitFind(const uint8_t *pbBitmap1, const uint8_t *pbBitmap2, uint32_t ulBitStart, uint32_t ulBitEnd, bool fSet);
 
 #ifdef REDCONF_ENDIAN_SWAP
 uint64_t RedRev64(uint64_t ullToRev);
@@ -28,6 +28,10 @@
 #include <redfs.h>
 
 
+static uint32_t BitmapWord(const uint8_t *pbBitmap, uint32_t ulBit, uint32_t ulBitEnd);
+static uint32_t BitLeadingZeros(uint32_t ulWord);
+
+
 /** @brief Query the state of a bit in a bitmap.
 
     Bits are counted from most significant to least significant.  Thus, the mask
@@ -99,3 +103,157 @@ void RedBitClear(
     }
 }
 
+
+/** @brief Find the first bit which is set in either of two bitmaps, or clear in
+           both.
+
+    Bits are counted as in RedBitGet().  The bitmaps are examined 32 bits at a
+    time, so runs of bits which do not match are skipped quickly.  To search a
+    single bitmap, pass it as both @p pbBitmap1 and @p pbBitmap2.
+
+    @param pbBitmap1    Pointer to the first bitmap.
+    @param pbBitmap2    Pointer to the second bitmap.
+    @param ulBitStart   The first bit to examine.
+    @param ulBitEnd     The bit after the last bit to examine.
+    @param fSet         Whether to find a bit set in either bitmap (true) or a
+                        bit clear in both bitmaps (false).
+
+    @return The first matching bit from @p ulBitStart, or @p ulBitEnd if no
+            bit before @p ulBitEnd matches.
+*/
+uint32_t RedBitFind(
+    const uint8_t  *pbBitmap1,
+    const uint8_t  *pbBitmap2,
+    uint32_t        ulBitStart,
+    uint32_t        ulBitEnd,
+    bool            fSet)
+{
+    uint32_t        ulFound = ulBitEnd;
+
+    if((pbBitmap1 == NULL) || (pbBitmap2 == NULL) || (ulBitStart > ulBitEnd))
+    {
+        REDERROR();
+    }
+    else
+    {
+        uint32_t ulBit = ulBitStart & ~31U;
+
+        while((ulFound == ulBitEnd) && (ulBit < ulBitEnd))
+        {
+            uint32_t ulWord = BitmapWord(pbBitmap1, ulBit, ulBitEnd) | BitmapWord(pbBitmap2, ulBit, ulBitEnd);
+
+            /*  Turn the bits which match into ones, then drop those before the
+                start and after the end.
+            */
+            if(!fSet)
+            {
+                ulWord = ~ulWord;
+            }
+
+            if(ulBit < ulBitStart)
+            {
+                ulWord &= UINT32_MAX >> (ulBitStart - ulBit);
+            }
+
+            if((ulBitEnd - ulBit) < 32U)
+            {
+                ulWord &= ~(UINT32_MAX >> (ulBitEnd - ulBit));
+            }
+
+            if(ulWord != 0U)
+            {
+                ulFound = ulBit + BitLeadingZeros(ulWord);
+            }
+
+            ulBit += 32U;
+        }
+    }
+
+    return ulFound;
+}
+
+
+/** @brief Read 32 bits of a bitmap as a word.
+
+    The first bit is the most significant bit of the word, as in RedBitGet().
+    Bytes at or after @p ulBitEnd are not read; their bits are zero.
+
+    @param pbBitmap Pointer to the bitmap.
+    @param ulBit    The first bit to read; a multiple of 32.
+    @param ulBitEnd The bit after the last bit which may be read.
+
+    @return The 32 bits from @p ulBit.
+*/
+static uint32_t BitmapWord(
+    const uint8_t  *pbBitmap,
+    uint32_t        ulBit,
+    uint32_t        ulBitEnd)
+{
+    uint32_t        ulByte = ulBit >> 3U;
+    uint32_t        ulWord;
+
+    if((ulBitEnd - ulBit) >= 32U)
+    {
+        ulWord =   ((uint32_t)pbBitmap[ulByte] << 24U)
+                 | ((uint32_t)pbBitmap[ulByte + 1U] << 16U)
+                 | ((uint32_t)pbBitmap[ulByte + 2U] << 8U)
+                 |  (uint32_t)pbBitmap[ulByte + 3U];
+    }
+    else
+    {
+        uint32_t ulByteEnd = (ulBitEnd >> 3U) + (((ulBitEnd & 7U) != 0U) ? 1U : 0U);
+        uint32_t ulIdx;
+
+        ulWord = 0U;
+
+        for(ulIdx = 0U; ulIdx < 4U; ulIdx++)
+        {
+            ulWord <<= 8U;
+
+            if((ulByte + ulIdx) < ulByteEnd)
+            {
+                ulWord |= pbBitmap[ulByte + ulIdx];
+            }
+        }
+    }
+
+    return ulWord;
+}
+
+
+/** @brief Count the leading zero bits of a word.
+
+    @param ulWord   The word to examine; must not be zero.
+
+    @return The number of zero bits above the most significant one bit.
+*/
+static uint32_t BitLeadingZeros(
+    uint32_t    ulWord)
+{
+    uint32_t    ulCount;
+
+    REDASSERT(ulWord != 0U);
+
+  #if defined(__GNUC__)
+    ulCount = (uint32_t)__builtin_clzl((unsigned long)ulWord) - (uint32_t)((sizeof(unsigned long) * 8U) - 32U);
+  #else
+    {
+        uint32_t ulRemaining = ulWord;
+        uint32_t ulShift;
+
+        ulCount = 0U;
+
+        for(ulShift = 16U; ulShift > 0U; ulShift >>= 1U)
+        {
+            if((ulRemaining >> (32U - ulShift)) == 0U)
+            {
+                ulCount += ulShift;
+                ulRemaining <<= ulShift;
+            }
+        }
+    }
+  #endif
+
+    return ulCount;
+}
+
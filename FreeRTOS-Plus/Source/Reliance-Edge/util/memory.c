@@ -25,10 +25,12 @@
 /** @file
     @brief Default implementations of memory manipulation functions.
 
-    These implementations are intended to be small and simple, and thus forego
-    all optimizations.  If the C library is available, or if there are better
-    third-party implementations available in the system, those can be used
-    instead by defining the appropriate macros in redconf.h.
+    These implementations are intended to be small and simple.  They move a
+    32-bit word at a time where both buffers allow it, and, when
+    REDCONF_MEMORY_SIMD is 1, sixteen bytes at a time with SSE2 or NEON.  If
+    the C library is available, or if there are better third-party
+    implementations available in the system, those can be used instead by
+    defining the appropriate macros in redconf.h.
 
     These functions are not intended to be completely 100% ANSI C compatible
     implementations, but rather are designed to meet the needs of Reliance Edge.
@@ -38,11 +40,68 @@
 #include <redfs.h>
 
 
+#if REDCONF_MEMORY_SIMD == 1
+  #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #define MEM_SIMD_SSE2
+    #include <emmintrin.h>
+  #elif defined(__ARM_NEON)
+    #define MEM_SIMD_NEON
+    #include <arm_neon.h>
+  #endif
+#endif
+
+#if defined(MEM_SIMD_SSE2) || defined(MEM_SIMD_NEON)
+  #define MEM_SIMD
+#endif
+
+#define MEM_WORD_SIZE   (4U)
+#define MEM_WORD_MASK   ((uintptr_t)MEM_WORD_SIZE - 1U)
+
+/*  Whether an address is word aligned, and whether two addresses become word
+    aligned together, which is what the word loops need.
+*/
+#define MEM_IS_ALIGNED(ptr)         ((CAST_PTR_TO_UINTPTR(ptr) & MEM_WORD_MASK) == 0U)
+#define MEM_CO_ALIGNED(ptr1, ptr2)  (((CAST_PTR_TO_UINTPTR(ptr1) ^ CAST_PTR_TO_UINTPTR(ptr2)) & MEM_WORD_MASK) == 0U)
+
+#define MEM_VEC_SIZE    (16U)
+
+/*  One 16-byte vector, and the operations on it.  None of them need the
+    memory to be aligned.
+*/
+#if defined(MEM_SIMD_SSE2)
+typedef __m128i MEMVEC;
+
+/*  MISRA-C:2012 R11.3 deviation: the SSE2 unaligned load and store
+    intrinsics take pointers to the vector type.  The memory is only accessed
+    through them by _mm_loadu_si128() and _mm_storeu_si128(), which have no
+    alignment requirement.
+*/
+#define MEMVEC_LOAD(pb)             _mm_loadu_si128((const __m128i *)(const void *)(pb))
+#define MEMVEC_STORE(pb, vec)       _mm_storeu_si128((__m128i *)(void *)(pb), (vec))
+#define MEMVEC_SPLAT(b)             _mm_set1_epi8((char)(b))
+#define MEMVEC_EQUAL(vec1, vec2)    (_mm_movemask_epi8(_mm_cmpeq_epi8((vec1), (vec2))) == 0xFFFF)
+#elif defined(MEM_SIMD_NEON)
+typedef uint8x16_t MEMVEC;
+
+#define MEMVEC_LOAD(pb)             vld1q_u8(pb)
+#define MEMVEC_STORE(pb, vec)       vst1q_u8((pb), (vec))
+#define MEMVEC_SPLAT(b)             vdupq_n_u8(b)
+#define MEMVEC_EQUAL(vec1, vec2)    MemVecEqual((vec1), (vec2))
+#endif
+
+
 #ifndef RedMemCpyUnchecked
 static void RedMemCpyUnchecked(void *pDest, const void *pSrc, uint32_t ulLen);
 #endif
 #ifndef RedMemMoveUnchecked
 static void RedMemMoveUnchecked(void *pDest, const void *pSrc, uint32_t ulLen);
+static uint32_t MemCopyWordsBackward(uint8_t *pbDest, const uint8_t *pbSrc, uint32_t ulLen);
+#endif
+#if !defined(RedMemMoveUnchecked) || (!defined(RedMemCpyUnchecked) && !defined(MEM_SIMD))
+static uint32_t MemCopyWords(uint8_t *pbDest, const uint8_t *pbSrc, uint32_t ulLen);
+#endif
+#if defined(MEM_SIMD_NEON) && !defined(RedMemCmpUnchecked)
+static bool MemVecEqual(MEMVEC vec1, MEMVEC vec2);
 #endif
 #ifndef RedMemSetUnchecked
 static void RedMemSetUnchecked(void *pDest, uint8_t bVal, uint32_t ulLen);
@@ -93,16 +152,79 @@ static void RedMemCpyUnchecked(
 {
     uint8_t        *pbDest = CAST_VOID_PTR_TO_UINT8_PTR(pDest);
     const uint8_t  *pbSrc = CAST_VOID_PTR_TO_CONST_UINT8_PTR(pSrc);
-    uint32_t        ulIdx;
+    uint32_t        ulIdx = 0U;
+
+  #ifdef MEM_SIMD
+    while((ulLen - ulIdx) >= MEM_VEC_SIZE)
+    {
+        MEMVEC_STORE(&pbDest[ulIdx], MEMVEC_LOAD(&pbSrc[ulIdx]));
+        ulIdx += MEM_VEC_SIZE;
+    }
+  #else
+    ulIdx = MemCopyWords(pbDest, pbSrc, ulLen);
+  #endif
 
-    for(ulIdx = 0U; ulIdx < ulLen; ulIdx++)
+    while(ulIdx < ulLen)
     {
         pbDest[ulIdx] = pbSrc[ulIdx];
+        ulIdx++;
     }
 }
 #endif
 
 
+#if !defined(RedMemMoveUnchecked) || (!defined(RedMemCpyUnchecked) && !defined(MEM_SIMD))
+/** @brief Copy the leading words of one buffer to another.
+
+    If the buffers become word aligned together, bytes are copied up to the
+    first aligned address, then whole words from there.  Otherwise, bytes are
+    copied four at a time.  Either way the copy is in ascending order, so that
+    it is also safe for RedMemMove() when the destination is below the source.
+
+    @param pbDest   The destination buffer.
+    @param pbSrc    The source buffer.
+    @param ulLen    The number of bytes to copy.
+
+    @return The number of leading bytes copied; the caller copies the rest.
+*/
+static uint32_t MemCopyWords(
+    uint8_t        *pbDest,
+    const uint8_t  *pbSrc,
+    uint32_t        ulLen)
+{
+    uint32_t        ulIdx = 0U;
+
+    if((ulLen >= MEM_WORD_SIZE) && MEM_CO_ALIGNED(pbDest, pbSrc))
+    {
+        while(!MEM_IS_ALIGNED(&pbDest[ulIdx]))
+        {
+            pbDest[ulIdx] = pbSrc[ulIdx];
+            ulIdx++;
+        }
+
+        while((ulLen - ulIdx) >= MEM_WORD_SIZE)
+        {
+            *CAST_UINT32_PTR(&pbDest[ulIdx]) = *CAST_CONST_UINT32_PTR(&pbSrc[ulIdx]);
+            ulIdx += MEM_WORD_SIZE;
+        }
+    }
+    else
+    {
+        while((ulLen - ulIdx) >= MEM_WORD_SIZE)
+        {
+            pbDest[ulIdx] = pbSrc[ulIdx];
+            pbDest[ulIdx + 1U] = pbSrc[ulIdx + 1U];
+            pbDest[ulIdx + 2U] = pbSrc[ulIdx + 2U];
+            pbDest[ulIdx + 3U] = pbSrc[ulIdx + 3U];
+            ulIdx += MEM_WORD_SIZE;
+        }
+    }
+
+    return ulIdx;
+}
+#endif
+
+
 /** @brief Move memory from one address to another.
 
     Supports overlapping memory regions.  If memory regions do not overlap, it
@@ -155,16 +277,17 @@ static void RedMemMoveUnchecked(
             Don't use RedMemCpy() to do this.  It is possible that RedMemCpy()
             has been replaced (even though this function has not been replaced)
             with an implementation that cannot handle any kind of buffer
-            overlap.
+            overlap.  Words can be copied, since buffers which become aligned
+            together are at least a word apart.
         */
-        for(ulIdx = 0U; ulIdx < ulLen; ulIdx++)
+        for(ulIdx = MemCopyWords(pbDest, pbSrc, ulLen); ulIdx < ulLen; ulIdx++)
         {
             pbDest[ulIdx] = pbSrc[ulIdx];
         }
     }
     else
     {
-        ulIdx = ulLen;
+        ulIdx = MemCopyWordsBackward(pbDest, pbSrc, ulLen);
 
         while(ulIdx > 0U)
         {
@@ -173,6 +296,44 @@ static void RedMemMoveUnchecked(
         }
     }
 }
+
+
+/** @brief Copy the trailing words of one buffer to another.
+
+    The mirror image of MemCopyWords(): bytes are copied down to the last
+    aligned address, then whole words, in descending order, so that it is
+    safe when the destination is above the source.
+
+    @param pbDest   The destination buffer.
+    @param pbSrc    The source buffer.
+    @param ulLen    The number of bytes to copy.
+
+    @return The number of leading bytes left for the caller to copy.
+*/
+static uint32_t MemCopyWordsBackward(
+    uint8_t        *pbDest,
+    const uint8_t  *pbSrc,
+    uint32_t        ulLen)
+{
+    uint32_t        ulIdx = ulLen;
+
+    if((ulLen >= MEM_WORD_SIZE) && MEM_CO_ALIGNED(pbDest, pbSrc))
+    {
+        while(!MEM_IS_ALIGNED(&pbDest[ulIdx]))
+        {
+            ulIdx--;
+            pbDest[ulIdx] = pbSrc[ulIdx];
+        }
+
+        while(ulIdx >= MEM_WORD_SIZE)
+        {
+            ulIdx -= MEM_WORD_SIZE;
+            *CAST_UINT32_PTR(&pbDest[ulIdx]) = *CAST_CONST_UINT32_PTR(&pbSrc[ulIdx]);
+        }
+    }
+
+    return ulIdx;
+}
 #endif /* RedMemMoveUnchecked */
 
 
@@ -213,11 +374,42 @@ static void RedMemSetUnchecked(
     uint32_t    ulLen)
 {
     uint8_t    *pbDest = CAST_VOID_PTR_TO_UINT8_PTR(pDest);
-    uint32_t    ulIdx;
+    uint32_t    ulIdx = 0U;
+
+  #ifdef MEM_SIMD
+    if(ulLen >= MEM_VEC_SIZE)
+    {
+        const MEMVEC vecVal = MEMVEC_SPLAT(bVal);
+
+        while((ulLen - ulIdx) >= MEM_VEC_SIZE)
+        {
+            MEMVEC_STORE(&pbDest[ulIdx], vecVal);
+            ulIdx += MEM_VEC_SIZE;
+        }
+    }
+  #else
+    if(ulLen >= MEM_WORD_SIZE)
+    {
+        uint32_t ulVal = (uint32_t)bVal * 0x01010101U;
+
+        while(!MEM_IS_ALIGNED(&pbDest[ulIdx]))
+        {
+            pbDest[ulIdx] = bVal;
+            ulIdx++;
+        }
 
-    for(ulIdx = 0U; ulIdx < ulLen; ulIdx++)
+        while((ulLen - ulIdx) >= MEM_WORD_SIZE)
+        {
+            *CAST_UINT32_PTR(&pbDest[ulIdx]) = ulVal;
+            ulIdx += MEM_WORD_SIZE;
+        }
+    }
+  #endif
+
+    while(ulIdx < ulLen)
     {
         pbDest[ulIdx] = bVal;
+        ulIdx++;
     }
 }
 #endif
@@ -277,6 +469,32 @@ static int32_t RedMemCmpUnchecked(
     uint32_t        ulIdx = 0U;
     int32_t         lResult;
 
+    /*  Skip the leading vectors or words which are equal.  The byte loop
+        below then finds the first difference, if any.
+    */
+  #ifdef MEM_SIMD
+    while(((ulLen - ulIdx) >= MEM_VEC_SIZE) && MEMVEC_EQUAL(MEMVEC_LOAD(&pbMem1[ulIdx]), MEMVEC_LOAD(&pbMem2[ulIdx])))
+    {
+        ulIdx += MEM_VEC_SIZE;
+    }
+  #else
+    if((ulLen >= MEM_WORD_SIZE) && MEM_CO_ALIGNED(pbMem1, pbMem2))
+    {
+        while(!MEM_IS_ALIGNED(&pbMem1[ulIdx]) && (pbMem1[ulIdx] == pbMem2[ulIdx]))
+        {
+            ulIdx++;
+        }
+
+        if(MEM_IS_ALIGNED(&pbMem1[ulIdx]))
+        {
+            while(((ulLen - ulIdx) >= MEM_WORD_SIZE) && (*CAST_CONST_UINT32_PTR(&pbMem1[ulIdx]) == *CAST_CONST_UINT32_PTR(&pbMem2[ulIdx])))
+            {
+                ulIdx += MEM_WORD_SIZE;
+            }
+        }
+    }
+  #endif
+
     while((ulIdx < ulLen) && (pbMem1[ulIdx] == pbMem2[ulIdx]))
     {
         ulIdx++;
@@ -299,3 +517,22 @@ static int32_t RedMemCmpUnchecked(
 }
 #endif
 
+
+#if defined(MEM_SIMD_NEON) && !defined(RedMemCmpUnchecked)
+/** @brief Determine whether two NEON vectors are equal.
+
+    @param vec1 The first vector to compare.
+    @param vec2 The second vector to compare.
+
+    @return Whether all sixteen bytes of @p vec1 and @p vec2 are equal.
+*/
+static bool MemVecEqual(
+    MEMVEC      vec1,
+    MEMVEC      vec2)
+{
+    uint64x2_t  vecEqual = vreinterpretq_u64_u8(vceqq_u8(vec1, vec2));
+
+    return (vgetq_lane_u64(vecEqual, 0) & vgetq_lane_u64(vecEqual, 1)) == UINT64_MAX;
+}
+#endif
+
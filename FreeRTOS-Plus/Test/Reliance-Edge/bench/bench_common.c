@@ -0,0 +1,200 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file bench_common.c */
+
+/* clock_gettime( CLOCK_MONOTONIC_RAW ) is used where no cycle counter is read. */
+#ifndef _GNU_SOURCE
+    #define _GNU_SOURCE
+#endif
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include "bench_common.h"
+
+/* ===========================  LOCAL DEFINITIONS  ========================== */
+
+typedef struct BenchResult
+{
+    const char * pcName;
+    uint32_t ulSize;
+    uint64_t ullMin;
+    uint64_t ullP50;
+    uint64_t ullP90;
+    uint64_t ullP99;
+    uint64_t ullMax;
+    uint64_t ullMean;
+} BenchResult_t;
+
+/* ============================  LOCAL VARIABLES  =========================== */
+
+static BenchResult_t xResults[ benchMAX_RESULTS ];
+static uint32_t ulNumResults = 0;
+static uint32_t ulRandomState = 1U;
+
+/* =============================  HELPER FUNCTIONS  ========================= */
+
+uint64_t ullBenchTimestamp( void )
+{
+    #if defined( __x86_64__ ) || defined( __i386__ )
+        return __builtin_ia32_rdtsc();
+    #elif defined( __aarch64__ )
+        uint64_t ullValue;
+
+        __asm volatile ( "isb\n mrs %0, cntvct_el0" : "=r" ( ullValue ) );
+        return ullValue;
+    #else
+        struct timespec xNow;
+
+        clock_gettime( CLOCK_MONOTONIC_RAW, &xNow );
+        return ( ( uint64_t ) xNow.tv_sec * 1000000000ULL ) + ( uint64_t ) xNow.tv_nsec;
+    #endif
+}
+
+void vBenchSeed( uint32_t ulSeed )
+{
+    ulRandomState = ulSeed;
+}
+
+uint32_t ulBenchRandom( void )
+{
+    ulRandomState = ( ulRandomState * 1103515245U ) + 12345U;
+
+    return ulRandomState >> 8;
+}
+
+void vBenchCheck( int xCondition,
+                  const char * pcMessage )
+{
+    if( xCondition == 0 )
+    {
+        printf( "Check failed: %s\n", pcMessage );
+        exit( 1 );
+    }
+}
+
+static int prvCompareSamples( const void * pvA,
+                              const void * pvB )
+{
+    uint64_t ullA = *( const uint64_t * ) pvA;
+    uint64_t ullB = *( const uint64_t * ) pvB;
+
+    return ( ullA > ullB ) - ( ullA < ullB );
+}
+
+void vBenchRecordResult( const char * pcName,
+                         uint32_t ulSize,
+                         uint64_t * pullSamples,
+                         uint32_t ulNumSamples )
+{
+    BenchResult_t * pxResult;
+    uint64_t ullSum = 0;
+    uint32_t i;
+
+    vBenchCheck( ulNumResults < benchMAX_RESULTS, "too many results" );
+    vBenchCheck( ulNumSamples > 0U, "no samples" );
+
+    qsort( pullSamples, ulNumSamples, sizeof( pullSamples[ 0 ] ), prvCompareSamples );
+
+    for( i = 0; i < ulNumSamples; i++ )
+    {
+        ullSum += pullSamples[ i ];
+    }
+
+    pxResult = &xResults[ ulNumResults++ ];
+    pxResult->pcName = pcName;
+    pxResult->ulSize = ulSize;
+    pxResult->ullMin = pullSamples[ 0 ];
+    pxResult->ullP50 = pullSamples[ ( ulNumSamples * 50U ) / 100U ];
+    pxResult->ullP90 = pullSamples[ ( ulNumSamples * 90U ) / 100U ];
+    pxResult->ullP99 = pullSamples[ ( ulNumSamples * 99U ) / 100U ];
+    pxResult->ullMax = pullSamples[ ulNumSamples - 1U ];
+    pxResult->ullMean = ullSum / ulNumSamples;
+
+    printf( "%-24s size=%-6lu p50=%-8llu p90=%-8llu p99=%-8llu max=%llu %s\n",
+            pcName, ( unsigned long ) ulSize,
+            ( unsigned long long ) pxResult->ullP50,
+            ( unsigned long long ) pxResult->ullP90,
+            ( unsigned long long ) pxResult->ullP99,
+            ( unsigned long long ) pxResult->ullMax,
+            benchTIME_UNIT );
+}
+
+int iBenchWriteResults( const char * pcFileName,
+                        const char * pcSizeName )
+{
+    char cPath[ 256 ];
+    FILE * pxFile;
+    uint32_t i;
+
+    if( ( mkdir( BENCH_OUTPUT_DIR, 0755 ) != 0 ) && ( errno != EEXIST ) )
+    {
+        printf( "Unable to create %s\n", BENCH_OUTPUT_DIR );
+        return 1;
+    }
+
+    snprintf( cPath, sizeof( cPath ), "%s/%s", BENCH_OUTPUT_DIR, pcFileName );
+    pxFile = fopen( cPath, "w" );
+
+    if( pxFile == NULL )
+    {
+        printf( "Unable to open %s\n", cPath );
+        return 1;
+    }
+
+    fprintf( pxFile, "{\n" );
+    fprintf( pxFile, "  \"unit\": \"%s\",\n", benchTIME_UNIT );
+    fprintf( pxFile, "  \"results\": [\n" );
+
+    for( i = 0; i < ulNumResults; i++ )
+    {
+        fprintf( pxFile,
+                 "    { \"op\": \"%s\", \"%s\": %lu, \"min\": %llu, \"p50\": %llu, "
+                 "\"p90\": %llu, \"p99\": %llu, \"max\": %llu, \"mean\": %llu }%s\n",
+                 xResults[ i ].pcName,
+                 pcSizeName,
+                 ( unsigned long ) xResults[ i ].ulSize,
+                 ( unsigned long long ) xResults[ i ].ullMin,
+                 ( unsigned long long ) xResults[ i ].ullP50,
+                 ( unsigned long long ) xResults[ i ].ullP90,
+                 ( unsigned long long ) xResults[ i ].ullP99,
+                 ( unsigned long long ) xResults[ i ].ullMax,
+                 ( unsigned long long ) xResults[ i ].ullMean,
+                 ( i + 1U < ulNumResults ) ? "," : "" );
+    }
+
+    fprintf( pxFile, "  ]\n}\n" );
+    fclose( pxFile );
+
+    printf( "Benchmark results written to %s\n", cPath );
+
+    return 0;
+}
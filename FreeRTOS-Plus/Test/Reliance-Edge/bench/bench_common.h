@@ -0,0 +1,96 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file bench_common.h
+ *
+ * Timing, percentile and JSON report helpers shared by the Reliance Edge host
+ * benchmarks.
+ */
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <stdint.h>
+
+#ifndef BENCH_OUTPUT_DIR
+    #define BENCH_OUTPUT_DIR    "."
+#endif
+
+/* Number of timed calls per operation and size. */
+#define benchSAMPLES            ( 10000U )
+
+/* Most results one benchmark run may record. */
+#define benchMAX_RESULTS        ( 64U )
+
+/* Timestamp source and the unit it counts in. */
+#if defined( __x86_64__ ) || defined( __i386__ )
+    #define benchTIME_UNIT    "cycles"
+#elif defined( __aarch64__ )
+    #define benchTIME_UNIT    "cntvct_ticks"
+#else
+    #define benchTIME_UNIT    "ns"
+#endif
+
+/**
+ * @brief Read the timestamp counter.
+ */
+uint64_t ullBenchTimestamp( void );
+
+/**
+ * @brief Deterministic pseudo random sequence, so runs can be compared.
+ * The sequence restarts at every vBenchSeed().
+ */
+void vBenchSeed( uint32_t ulSeed );
+uint32_t ulBenchRandom( void );
+
+/**
+ * @brief Stop the benchmark with an error when xCondition is false.
+ */
+void vBenchCheck( int xCondition,
+                  const char * pcMessage );
+
+/**
+ * @brief Reduce ulNumSamples timings to percentiles, print them and keep them
+ * for vBenchWriteResults(). The samples are sorted in place.
+ *
+ * @param pcName Name of the timed operation.
+ * @param ulSize Size the operation was timed at, e.g. a buffer count or a
+ * length in bytes.
+ */
+void vBenchRecordResult( const char * pcName,
+                         uint32_t ulSize,
+                         uint64_t * pullSamples,
+                         uint32_t ulNumSamples );
+
+/**
+ * @brief Write the recorded results as JSON into BENCH_OUTPUT_DIR/pcFileName.
+ *
+ * @param pcSizeName JSON key the ulSize of each result is written under.
+ *
+ * @return 0 on success, 1 if the file could not be written.
+ */
+int iBenchWriteResults( const char * pcFileName,
+                        const char * pcSizeName );
+
+#endif /* BENCH_COMMON_H */
@@ -0,0 +1,68 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file bench_stubs.c
+ *
+ * Stubs of the parts of Reliance Edge the benchmarks do not link. These are
+ * kept apart from bench_common.c, as the st_* macros of the host sys/stat.h
+ * clash with the members of the Reliance Edge REDSTAT structure.
+ */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdio.h>
+
+/* Reliance Edge includes. */
+#include <redfs.h>
+#include <redcore.h>
+
+/* The benchmarks run on a single volume, which is never mounted, so metadata
+ * sequence numbers are not checked. */
+VOLUME gaRedVolume[ REDCONF_VOLUME_COUNT ];
+VOLUME * const gpRedVolume = &gaRedVolume[ 0U ];
+const uint8_t gbRedVolNum = 0U;
+
+#if REDCONF_ASSERTS == 1
+    void RedOsAssertFail( const char * pszFileName,
+                          uint32_t ulLineNum )
+    {
+        printf( "Assertion failed at %s:%lu\n", pszFileName, ( unsigned long ) ulLineNum );
+        exit( 1 );
+    }
+#endif
+
+void RedVolCriticalError( const char * pszFileName,
+                          uint32_t ulLineNum )
+{
+    printf( "Critical error at %s:%lu\n", pszFileName, ( unsigned long ) ulLineNum );
+    exit( 1 );
+}
+
+REDSTATUS RedVolSeqNumIncrement( void )
+{
+    gpRedVolume->ullSequence++;
+
+    return 0;
+}
@@ -0,0 +1,354 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file buffer_bench.c
+ *
+ * Block buffer cache micro-benchmarks. Built once for each
+ * REDCONF_BUFFER_COUNT in BENCH_BUFFER_COUNTS, this times RedBufferGet()
+ * followed by RedBufferPut() on cached and uncached blocks, and
+ * RedBufferDiscardRange() of a single block, as done whenever a block is
+ * freed, and RedBufferFlush() of the blocks dirtied by a transaction. The
+ * block device is a stub which only tags each block read with its block
+ * number, so the timings are those of the cache itself.
+ */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Reliance Edge includes. */
+#include <redfs.h>
+#include <redcore.h>
+
+#include "bench_common.h"
+
+/* ===========================  LOCAL DEFINITIONS  ========================== */
+
+/* Blocks in the stub volume. Uncached blocks are drawn from above the cached
+ * ones, so they rarely repeat. */
+#define benchVOLUME_BLOCKS    ( 1UL << 24 )
+
+/* Flushed transactions timed, and the longest run of consecutive blocks each
+ * one writes, as when a file is written sequentially. */
+#define benchFLUSH_SAMPLES    ( benchSAMPLES / 50U )
+#define benchFLUSH_RUN        ( 8U )
+
+/* ============================  LOCAL VARIABLES  =========================== */
+
+static uint64_t ullSamples[ benchSAMPLES ];
+static uint32_t ulReads = 0;
+static uint32_t ulWrites = 0;
+static uint32_t ulWriteBlocks = 0;
+
+/* =========================  RELIANCE EDGE STUBS  ========================== */
+
+REDSTATUS RedIoRead( uint8_t bVolNum,
+                     uint32_t ulBlockStart,
+                     uint32_t ulBlockCount,
+                     void * pBuffer )
+{
+    ( void ) bVolNum;
+    vBenchCheck( ulBlockCount == 1U, "multi-block read" );
+
+    *( uint32_t * ) pBuffer = ulBlockStart;
+    ulReads++;
+
+    return 0;
+}
+
+REDSTATUS RedIoWrite( uint8_t bVolNum,
+                      uint32_t ulBlockStart,
+                      uint32_t ulBlockCount,
+                      const void * pBuffer )
+{
+    uint32_t i;
+
+    ( void ) bVolNum;
+
+    /* Every block of a multi-block write must be the one its buffer held. */
+    for( i = 0; i < ulBlockCount; i++ )
+    {
+        vBenchCheck( *( const uint32_t * ) &( ( const uint8_t * ) pBuffer )[ i * REDCONF_BLOCK_SIZE ] == ulBlockStart + i,
+                     "wrong block written" );
+    }
+
+    ulWrites++;
+    ulWriteBlocks += ulBlockCount;
+
+    return 0;
+}
+
+/* =============================  HELPER FUNCTIONS  ========================= */
+
+/* Get and put a data block, checking the buffer holds that block. */
+static void prvGetPut( uint32_t ulBlock )
+{
+    void * pBuffer;
+
+    vBenchCheck( RedBufferGet( ulBlock, 0U, &pBuffer ) == 0, "RedBufferGet() failed" );
+    vBenchCheck( *( uint32_t * ) pBuffer == ulBlock, "buffer holds the wrong block" );
+    RedBufferPut( pBuffer );
+}
+
+/* Start every benchmark from an empty cache, then cache blocks
+ * 0 to REDCONF_BUFFER_COUNT - 1. */
+static void prvFillCache( void )
+{
+    uint32_t i;
+
+    RedBufferInit();
+
+    for( i = 0; i < REDCONF_BUFFER_COUNT; i++ )
+    {
+        prvGetPut( i );
+    }
+}
+
+/* ==============================  Benchmarks  ============================== */
+
+/* Time looking up a random cached block, which is then made MRU. */
+static void prvBenchGetHit( void )
+{
+    uint64_t ullStart;
+    uint32_t i, ulBlock, ulReadsBefore;
+    void * pBuffer;
+
+    prvFillCache();
+    ulReadsBefore = ulReads;
+
+    for( i = 0; i < benchSAMPLES; i++ )
+    {
+        ulBlock = ulBenchRandom() % REDCONF_BUFFER_COUNT;
+
+        ullStart = ullBenchTimestamp();
+        ( void ) RedBufferGet( ulBlock, 0U, &pBuffer );
+        RedBufferPut( pBuffer );
+        ullSamples[ i ] = ullBenchTimestamp() - ullStart;
+
+        vBenchCheck( *( uint32_t * ) pBuffer == ulBlock, "buffer holds the wrong block" );
+    }
+
+    vBenchCheck( ulReads == ulReadsBefore, "a cached block was read" );
+    vBenchRecordResult( "get_put_hit", REDCONF_BUFFER_COUNT, ullSamples, benchSAMPLES );
+}
+
+/* Time reading an uncached block into the LRU buffer. */
+static void prvBenchGetMiss( void )
+{
+    uint64_t ullStart;
+    uint32_t i, ulBlock;
+    void * pBuffer;
+
+    prvFillCache();
+
+    for( i = 0; i < benchSAMPLES; i++ )
+    {
+        ulBlock = REDCONF_BUFFER_COUNT + ( ulBenchRandom() % ( benchVOLUME_BLOCKS - REDCONF_BUFFER_COUNT ) );
+
+        ullStart = ullBenchTimestamp();
+        ( void ) RedBufferGet( ulBlock, 0U, &pBuffer );
+        RedBufferPut( pBuffer );
+        ullSamples[ i ] = ullBenchTimestamp() - ullStart;
+
+        vBenchCheck( *( uint32_t * ) pBuffer == ulBlock, "buffer holds the wrong block" );
+    }
+
+    vBenchRecordResult( "get_put_miss", REDCONF_BUFFER_COUNT, ullSamples, benchSAMPLES );
+}
+
+/* Time discarding one block, cached or not, as when a block is freed. */
+static void prvBenchDiscardOne( void )
+{
+    uint64_t ullStart;
+    uint32_t i, ulBlock;
+
+    prvFillCache();
+
+    for( i = 0; i < benchSAMPLES; i++ )
+    {
+        ulBlock = ulBenchRandom() % ( 2U * REDCONF_BUFFER_COUNT );
+
+        ullStart = ullBenchTimestamp();
+        ( void ) RedBufferDiscardRange( ulBlock, 1U );
+        ullSamples[ i ] = ullBenchTimestamp() - ullStart;
+
+        /* Cache the block again, evicting another, for the next sample. */
+        prvGetPut( ulBlock );
+    }
+
+    vBenchRecordResult( "discard_range_1", REDCONF_BUFFER_COUNT, ullSamples, benchSAMPLES );
+}
+
+/* Dirty a block, caching it first if need be. */
+static void prvDirty( uint32_t ulBlock )
+{
+    void * pBuffer;
+
+    vBenchCheck( RedBufferGet( ulBlock, 0U, &pBuffer ) == 0, "RedBufferGet() failed" );
+    vBenchCheck( *( uint32_t * ) pBuffer == ulBlock, "buffer holds the wrong block" );
+    RedBufferDirty( pBuffer );
+    RedBufferPut( pBuffer );
+}
+
+/* Time flushing the blocks dirtied by a transaction: half of them in runs of
+ * consecutive blocks, the rest scattered over the volume. Also reports how
+ * many write requests writing runs together saved, against one request per
+ * dirty block. */
+static void prvBenchFlush( void )
+{
+    uint64_t ullStart;
+    uint32_t i, j, ulRun, ulBlock, ulBlocksBefore, ulWritesBefore, ulBlocks, ulWriteRequests;
+    uint32_t ulTxnBlocks = ( ( REDCONF_BUFFER_COUNT / 2U ) < 64U ) ? ( REDCONF_BUFFER_COUNT / 2U ) : 64U;
+    uint32_t ulRunBlocks = ( ( ulTxnBlocks / 2U ) < benchFLUSH_RUN ) ? ( ulTxnBlocks / 2U ) : benchFLUSH_RUN;
+    uint32_t ulRuns = ( ulTxnBlocks / 2U ) / ulRunBlocks;
+
+    prvFillCache();
+    RedBufferFlushStats( &ulBlocksBefore, &ulWritesBefore );
+    ulWriteBlocks = 0;
+    ulWrites = 0;
+
+    for( i = 0; i < benchFLUSH_SAMPLES; i++ )
+    {
+        /* Runs start in separate slices of the volume, so never overlap. */
+        for( ulRun = 0; ulRun < ulRuns; ulRun++ )
+        {
+            ulBlock = ( ( ulRun + 1U ) * ( benchVOLUME_BLOCKS / 64U ) ) + ( ulBenchRandom() % 4096U );
+
+            for( j = 0; j < ulRunBlocks; j++ )
+            {
+                prvDirty( ulBlock + j );
+            }
+        }
+
+        /* Scattered blocks may repeat or adjoin a run; the flush takes care
+         * of either. */
+        for( j = ulRuns * ulRunBlocks; j < ulTxnBlocks; j++ )
+        {
+            prvDirty( ulBenchRandom() % benchVOLUME_BLOCKS );
+        }
+
+        ullStart = ullBenchTimestamp();
+        ( void ) RedBufferFlush( 0U, gpRedVolume->ulBlockCount );
+        ullSamples[ i ] = ullBenchTimestamp() - ullStart;
+    }
+
+    RedBufferFlushStats( &ulBlocks, &ulWriteRequests );
+    ulBlocks -= ulBlocksBefore;
+    ulWriteRequests -= ulWritesBefore;
+    vBenchCheck( ( ulBlocks == ulWriteBlocks ) && ( ulWriteRequests == ulWrites ), "flush statistics disagree with the writes" );
+
+    vBenchRecordResult( "flush_transaction", REDCONF_BUFFER_COUNT, ullSamples, benchFLUSH_SAMPLES );
+    printf( "flush_transaction: %.1f blocks in %.1f write requests, %.1f requests saved per transaction\n",
+            ( double ) ulBlocks / benchFLUSH_SAMPLES,
+            ( double ) ulWriteRequests / benchFLUSH_SAMPLES,
+            ( double ) ( ulBlocks - ulWriteRequests ) / benchFLUSH_SAMPLES );
+}
+
+/* Mix hits, misses, dirty buffers, branches and discards, then check every
+ * cached block is found, in its own buffer, and flushed exactly once. */
+static void prvCheckConsistency( void )
+{
+    uint32_t i, ulBlock, ulDirty;
+    void * pBuffer;
+
+    prvFillCache();
+
+    for( i = 0; i < 4U * benchSAMPLES; i++ )
+    {
+        ulBlock = ulBenchRandom() % ( 4U * REDCONF_BUFFER_COUNT );
+
+        switch( ulBenchRandom() % 4U )
+        {
+            case 0:
+                ( void ) RedBufferDiscardRange( ulBlock, 1U );
+                break;
+
+            case 1:
+                vBenchCheck( RedBufferGet( ulBlock, 0U, &pBuffer ) == 0, "RedBufferGet() failed" );
+                RedBufferDirty( pBuffer );
+                RedBufferPut( pBuffer );
+                break;
+
+            case 2:
+                /* Move a clean block to a block past every other one, as when
+                 * copy-on-write branches it. */
+                vBenchCheck( RedBufferGet( ulBlock, 0U, &pBuffer ) == 0, "RedBufferGet() failed" );
+
+                if( ( RedBufferFlush( ulBlock, 1U ) == 0 ) &&
+                    ( RedBufferDiscardRange( ulBlock + ( 4U * REDCONF_BUFFER_COUNT ), 1U ) == 0 ) )
+                {
+                    RedBufferBranch( pBuffer, ulBlock + ( 4U * REDCONF_BUFFER_COUNT ) );
+                    *( uint32_t * ) pBuffer = ulBlock + ( 4U * REDCONF_BUFFER_COUNT );
+                }
+
+                RedBufferPut( pBuffer );
+                break;
+
+            default:
+                prvGetPut( ulBlock );
+                break;
+        }
+    }
+
+    for( i = 0; i < 8U * REDCONF_BUFFER_COUNT; i++ )
+    {
+        void * pFound;
+
+        /* Dirty buffers are never evicted by a lookup of themselves. */
+        if( RedBufferGet( i, 0U, &pFound ) == 0 )
+        {
+            vBenchCheck( *( uint32_t * ) pFound == i, "buffer holds the wrong block" );
+            RedBufferPut( pFound );
+        }
+    }
+
+    ulWriteBlocks = 0;
+    vBenchCheck( RedBufferFlush( 0U, gpRedVolume->ulBlockCount ) == 0, "RedBufferFlush() failed" );
+    ulDirty = ulWriteBlocks;
+    vBenchCheck( RedBufferFlush( 0U, gpRedVolume->ulBlockCount ) == 0, "RedBufferFlush() failed" );
+    vBenchCheck( ulWriteBlocks == ulDirty, "a buffer was flushed twice" );
+    vBenchCheck( RedBufferDiscardRange( 0U, gpRedVolume->ulBlockCount ) == 0, "RedBufferDiscardRange() failed" );
+}
+
+int main( void )
+{
+    char cFileName[ 64 ];
+
+    gpRedVolume->ulBlockCount = benchVOLUME_BLOCKS;
+
+    vBenchSeed( 1U );
+    prvCheckConsistency();
+
+    vBenchSeed( 1U );
+    prvBenchGetHit();
+    prvBenchGetMiss();
+    prvBenchDiscardOne();
+    prvBenchFlush();
+
+    snprintf( cFileName, sizeof( cFileName ), "buffer_bench_count_%lu.json", ( unsigned long ) REDCONF_BUFFER_COUNT );
+
+    return iBenchWriteResults( cFileName, "buffer_count" );
+}
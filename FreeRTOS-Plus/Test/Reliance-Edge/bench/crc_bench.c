@@ -0,0 +1,167 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file crc_bench.c
+ *
+ * CRC-32 micro-benchmarks. Built once for each REDCONF_CRC_ALGORITHM in
+ * BENCH_CRC_ALGORITHMS, this first cross-checks RedCrc32Update() and
+ * RedCrcNode() against a bitwise reference over every alignment, many
+ * lengths and chained updates, then times RedCrc32Update() over buffers of
+ * the lengths in xLengths.
+ */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Reliance Edge includes. */
+#include <redfs.h>
+#include <redcore.h>
+
+#include "bench_common.h"
+
+/* ===========================  LOCAL DEFINITIONS  ========================== */
+
+/* Longest buffer timed or checked. */
+#define benchCRC_MAX_LENGTH    ( 65536U )
+
+/* CRC-32 of "123456789", the standard check value of the CCITT-32 CRC. */
+#define benchCRC_CHECK_VALUE    ( 0xCBF43926U )
+
+/* ============================  LOCAL VARIABLES  =========================== */
+
+static uint64_t ullSamples[ benchSAMPLES ];
+
+/* Receives every CRC timed, so none is optimized away. */
+static volatile uint32_t ulCrcSink;
+
+/* Room for the longest buffer at any alignment. */
+static uint8_t ucData[ benchCRC_MAX_LENGTH + 16U ];
+
+/* Lengths timed: a buffer too short to fold, a metadata node CRC'd by
+ * RedCrcNode(), a block, and a large buffer. */
+static const uint32_t xLengths[] = { 32U, REDCONF_BLOCK_SIZE - 8U, 4096U, benchCRC_MAX_LENGTH };
+
+/* =============================  HELPER FUNCTIONS  ========================= */
+
+/* Bitwise CCITT-32 CRC, the definition every algorithm must match. */
+static uint32_t prvCrcReference( uint32_t ulInitCrc32,
+                                 const uint8_t * pucBuffer,
+                                 uint32_t ulLength )
+{
+    uint32_t ulCrc32 = ~ulInitCrc32;
+    uint32_t i, ulBit;
+
+    for( i = 0; i < ulLength; i++ )
+    {
+        ulCrc32 ^= pucBuffer[ i ];
+
+        for( ulBit = 0; ulBit < 8U; ulBit++ )
+        {
+            ulCrc32 = ( ulCrc32 >> 1 ) ^ ( ( ulCrc32 & 1U ) ? 0xEDB88320U : 0U );
+        }
+    }
+
+    return ~ulCrc32;
+}
+
+/* ==============================  Benchmarks  ============================== */
+
+/* Check RedCrc32Update() matches the reference whatever the alignment,
+ * length and starting CRC, and that RedCrcNode() does too. */
+static void prvCheckCrc( void )
+{
+    uint32_t i, ulOffset, ulLength, ulSplit, ulInit;
+
+    vBenchCheck( RedCrc32Update( 0U, "123456789", 9U ) == benchCRC_CHECK_VALUE, "wrong check value" );
+
+    for( i = 0; i < sizeof( ucData ); i++ )
+    {
+        ucData[ i ] = ( uint8_t ) ulBenchRandom();
+    }
+
+    for( ulOffset = 0; ulOffset < 16U; ulOffset++ )
+    {
+        for( ulLength = 0; ulLength <= 1024U; ulLength++ )
+        {
+            ulInit = ulBenchRandom();
+            vBenchCheck( RedCrc32Update( ulInit, &ucData[ ulOffset ], ulLength ) ==
+                         prvCrcReference( ulInit, &ucData[ ulOffset ], ulLength ), "CRC differs from the reference" );
+        }
+    }
+
+    for( i = 0; i < 1000U; i++ )
+    {
+        ulOffset = ulBenchRandom() % 16U;
+        ulLength = ulBenchRandom() % ( benchCRC_MAX_LENGTH + 1U );
+        ulSplit = ulBenchRandom() % ( ulLength + 1U );
+
+        /* A CRC computed in two updates must equal one computed in one. */
+        vBenchCheck( RedCrc32Update( RedCrc32Update( 0U, &ucData[ ulOffset ], ulSplit ), &ucData[ ulOffset + ulSplit ], ulLength - ulSplit ) ==
+                     prvCrcReference( 0U, &ucData[ ulOffset ], ulLength ), "chained CRC differs from the reference" );
+    }
+
+    vBenchCheck( RedCrcNode( ucData ) == prvCrcReference( 0U, &ucData[ 8U ], REDCONF_BLOCK_SIZE - 8U ),
+                 "node CRC differs from the reference" );
+}
+
+/* Time RedCrc32Update() over each length, from an aligned buffer. */
+static void prvBenchCrc( void )
+{
+    uint64_t ullStart;
+    uint32_t i, ulLength;
+    size_t x;
+
+    for( x = 0; x < sizeof( xLengths ) / sizeof( xLengths[ 0 ] ); x++ )
+    {
+        ulLength = xLengths[ x ];
+
+        for( i = 0; i < benchSAMPLES; i++ )
+        {
+            ullStart = ullBenchTimestamp();
+            ulCrcSink = RedCrc32Update( ulCrcSink, ucData, ulLength );
+            ullSamples[ i ] = ullBenchTimestamp() - ullStart;
+        }
+
+        vBenchRecordResult( "crc32_update", ulLength, ullSamples, benchSAMPLES );
+        printf( "crc32_update: %.3f %s per byte at length %lu\n",
+                ( double ) ullSamples[ benchSAMPLES / 2U ] / ( double ) ulLength,
+                benchTIME_UNIT, ( unsigned long ) ulLength );
+    }
+}
+
+int main( void )
+{
+    char cFileName[ 64 ];
+
+    vBenchSeed( 1U );
+    prvCheckCrc();
+    prvBenchCrc();
+
+    snprintf( cFileName, sizeof( cFileName ), "crc_bench_algorithm_%lu.json", ( unsigned long ) REDCONF_CRC_ALGORITHM );
+
+    return iBenchWriteResults( cFileName, "length" );
+}
@@ -0,0 +1,405 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file imap_bench.c
+ *
+ * Block allocator micro-benchmarks. Built once for each
+ * REDCONF_IMAP_SUMMARY_GROUPS in BENCH_IMAP_SUMMARY_GROUPS, this times
+ * RedImapAllocBlock() and RedImapAllocExtent() on a volume with an external
+ * imap which is kept 50%, 90% and 99% full, with the allocated blocks
+ * scattered at random, by freeing a random block for every block allocated
+ * and committing a transaction every few allocations. The imap nodes live on
+ * a RAM disk stub; data blocks are never read or written.
+ */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Reliance Edge includes. */
+#include <redfs.h>
+#include <redcore.h>
+
+#include "bench_common.h"
+
+/* ===========================  LOCAL DEFINITIONS  ========================== */
+
+/* Blocks in the stub volume, and the blocks of its inode table. */
+#define benchVOLUME_BLOCKS    ( 1UL << 18 )
+#define benchINODE_BLOCKS     ( 128U )
+
+/* Allocations between transactions, and the most blocks each extent
+ * allocation asks for. */
+#define benchTXN_ALLOCS       ( 64U )
+#define benchEXTENT_BLOCKS    ( 16U )
+
+/* Imap nodes needed to cover the volume, and the metadata blocks in front of
+ * the allocable blocks: master block, metaroots, imap and inode table. */
+#define benchIMAP_NODES       ( ( benchVOLUME_BLOCKS + IMAPNODE_ENTRIES - 1U ) / IMAPNODE_ENTRIES )
+#define benchIMAP_START       ( BLOCK_NUM_FIRST_METAROOT + 2U )
+#define benchMETA_BLOCKS      ( benchIMAP_START + ( 2U * benchIMAP_NODES ) + benchINODE_BLOCKS )
+
+/* ============================  LOCAL VARIABLES  =========================== */
+
+static COREVOLUME xCoreVol;
+COREVOLUME * const gpRedCoreVol = &xCoreVol;
+METAROOT * gpRedMR = &xCoreVol.aMR[ 0U ];
+
+static uint8_t ucMetaDisk[ benchMETA_BLOCKS ][ REDCONF_BLOCK_SIZE ];
+static uint64_t ullSamples[ benchSAMPLES ];
+
+/* Allocated blocks, from which the blocks to free are drawn at random. */
+static uint32_t ulAllocated[ benchVOLUME_BLOCKS ];
+static uint32_t ulAllocatedCount = 0;
+
+/* Expected allocation state of every block, for the consistency check. */
+static uint8_t ucShadow[ benchVOLUME_BLOCKS ];
+
+/* =========================  RELIANCE EDGE STUBS  ========================== */
+
+/* Only the metadata blocks exist on the RAM disk. */
+REDSTATUS RedIoRead( uint8_t bVolNum,
+                     uint32_t ulBlockStart,
+                     uint32_t ulBlockCount,
+                     void * pBuffer )
+{
+    ( void ) bVolNum;
+    vBenchCheck( ulBlockStart + ulBlockCount <= benchMETA_BLOCKS, "data block read" );
+
+    memcpy( pBuffer, ucMetaDisk[ ulBlockStart ], ulBlockCount * REDCONF_BLOCK_SIZE );
+
+    return 0;
+}
+
+REDSTATUS RedIoWrite( uint8_t bVolNum,
+                      uint32_t ulBlockStart,
+                      uint32_t ulBlockCount,
+                      const void * pBuffer )
+{
+    ( void ) bVolNum;
+    vBenchCheck( ulBlockStart + ulBlockCount <= benchMETA_BLOCKS, "data block written" );
+
+    memcpy( ucMetaDisk[ ulBlockStart ], pBuffer, ulBlockCount * REDCONF_BLOCK_SIZE );
+
+    return 0;
+}
+
+/* =============================  HELPER FUNCTIONS  ========================= */
+
+/* Commit a transaction as RedVolTransact() does, without writing the
+ * metaroot: almost free blocks become free and the working metaroot becomes
+ * the committed one. */
+static void prvTransact( void )
+{
+    uint32_t i;
+
+    gpRedMR->ulFreeBlocks += gpRedCoreVol->ulAlmostFreeBlocks;
+    gpRedCoreVol->ulAlmostFreeBlocks = 0U;
+    #if REDCONF_IMAP_SUMMARY_GROUPS > 0U
+        RedImapSummaryTransact();
+    #endif
+
+    vBenchCheck( RedBufferFlush( 0U, gpRedVolume->ulBlockCount ) == 0, "RedBufferFlush() failed" );
+
+    gpRedCoreVol->aMR[ 1U - gpRedCoreVol->bCurMR ] = *gpRedMR;
+    gpRedCoreVol->bCurMR = 1U - gpRedCoreVol->bCurMR;
+    gpRedMR = &gpRedCoreVol->aMR[ gpRedCoreVol->bCurMR ];
+    gpRedCoreVol->fBranched = false;
+
+    for( i = gpRedCoreVol->ulFirstAllocableBN; i < benchVOLUME_BLOCKS; i++ )
+    {
+        if( ucShadow[ i ] == ( uint8_t ) ALLOCSTATE_NEW )
+        {
+            ucShadow[ i ] = ( uint8_t ) ALLOCSTATE_USED;
+        }
+        else if( ucShadow[ i ] == ( uint8_t ) ALLOCSTATE_AFREE )
+        {
+            ucShadow[ i ] = ( uint8_t ) ALLOCSTATE_FREE;
+        }
+    }
+}
+
+/* Record a newly allocated block. */
+static void prvAllocated( uint32_t ulBlock )
+{
+    vBenchCheck( ucShadow[ ulBlock ] == ( uint8_t ) ALLOCSTATE_FREE, "allocated a block which was not free" );
+    ucShadow[ ulBlock ] = ( uint8_t ) ALLOCSTATE_NEW;
+    ulAllocated[ ulAllocatedCount++ ] = ulBlock;
+}
+
+/* Free a block drawn at random from the allocated ones. */
+static void prvFreeRandom( void )
+{
+    uint32_t ulIdx = ulBenchRandom() % ulAllocatedCount;
+    uint32_t ulBlock = ulAllocated[ ulIdx ];
+
+    ulAllocated[ ulIdx ] = ulAllocated[ --ulAllocatedCount ];
+
+    vBenchCheck( RedImapBlockSet( ulBlock, false ) == 0, "RedImapBlockSet() failed" );
+    ucShadow[ ulBlock ] = ( ucShadow[ ulBlock ] == ( uint8_t ) ALLOCSTATE_NEW ) ? ( uint8_t ) ALLOCSTATE_FREE : ( uint8_t ) ALLOCSTATE_AFREE;
+}
+
+/* Format the stub volume and mount it, then allocate ulPercent of its
+ * allocable blocks at random and commit them. */
+static void prvFormat( uint32_t ulPercent )
+{
+    uint32_t i;
+    void * pBuffer;
+
+    RedBufferInit();
+    memset( &xCoreVol, 0, sizeof( xCoreVol ) );
+    memset( ucMetaDisk, 0, sizeof( ucMetaDisk ) );
+    memset( ucShadow, ( int ) ALLOCSTATE_FREE, sizeof( ucShadow ) );
+    ulAllocatedCount = 0;
+
+    gpRedVolume->ulBlockCount = benchVOLUME_BLOCKS;
+    gpRedCoreVol->fImapInline = false;
+    gpRedCoreVol->ulImapStartBN = benchIMAP_START;
+    gpRedCoreVol->ulImapNodeCount = benchIMAP_NODES;
+    gpRedCoreVol->ulInodeTableStartBN = benchIMAP_START + ( 2U * benchIMAP_NODES );
+    gpRedCoreVol->ulFirstAllocableBN = benchMETA_BLOCKS;
+    gpRedVolume->ulBlocksAllocable = benchVOLUME_BLOCKS - benchMETA_BLOCKS;
+
+    gpRedCoreVol->bCurMR = 0U;
+    gpRedMR = &gpRedCoreVol->aMR[ 0U ];
+    gpRedMR->ulFreeBlocks = gpRedVolume->ulBlocksAllocable;
+    gpRedMR->ulAllocNextBlock = gpRedCoreVol->ulFirstAllocableBN;
+
+    /* Write the first copy of every imap node, empty. */
+    for( i = 0; i < benchIMAP_NODES; i++ )
+    {
+        vBenchCheck( RedBufferGet( RedImapNodeBlock( 0U, i ), BFLAG_META_IMAP | BFLAG_NEW | BFLAG_DIRTY, &pBuffer ) == 0, "RedBufferGet() failed" );
+        RedBufferPut( pBuffer );
+    }
+
+    vBenchCheck( RedBufferFlush( 0U, gpRedVolume->ulBlockCount ) == 0, "RedBufferFlush() failed" );
+    gpRedCoreVol->aMR[ 1U ] = *gpRedMR;
+
+    #if REDCONF_IMAP_SUMMARY_GROUPS > 0U
+        vBenchCheck( RedImapSummaryRebuild() == 0, "RedImapSummaryRebuild() failed" );
+    #endif
+
+    for( i = gpRedCoreVol->ulFirstAllocableBN; i < benchVOLUME_BLOCKS; i++ )
+    {
+        if( ( ulBenchRandom() % 1000U ) < ( ulPercent * 10U ) )
+        {
+            vBenchCheck( RedImapBlockSet( i, true ) == 0, "RedImapBlockSet() failed" );
+            prvAllocated( i );
+        }
+    }
+
+    prvTransact();
+}
+
+/* ==============================  Benchmarks  ============================== */
+
+/* Time allocating one block, the next free one after the previous
+ * allocation. */
+static void prvBenchAllocBlock( uint32_t ulPercent )
+{
+    uint64_t ullStart;
+    uint32_t i, ulBlock;
+    REDSTATUS ret;
+
+    prvFormat( ulPercent );
+
+    for( i = 0; i < benchSAMPLES; i++ )
+    {
+        ullStart = ullBenchTimestamp();
+        ret = RedImapAllocBlock( &ulBlock );
+        ullSamples[ i ] = ullBenchTimestamp() - ullStart;
+
+        vBenchCheck( ret == 0, "RedImapAllocBlock() failed" );
+        prvAllocated( ulBlock );
+        prvFreeRandom();
+
+        if( ( i % benchTXN_ALLOCS ) == ( benchTXN_ALLOCS - 1U ) )
+        {
+            prvTransact();
+        }
+    }
+
+    vBenchRecordResult( "alloc_block", ulPercent, ullSamples, benchSAMPLES );
+}
+
+/* Time allocating up to benchEXTENT_BLOCKS contiguous blocks. Also reports
+ * how many blocks each allocation got on average. */
+static void prvBenchAllocExtent( uint32_t ulPercent )
+{
+    uint64_t ullStart;
+    uint32_t i, j, ulBlock, ulCount, ulBlocks = 0;
+    REDSTATUS ret;
+
+    prvFormat( ulPercent );
+
+    for( i = 0; i < benchSAMPLES; i++ )
+    {
+        ullStart = ullBenchTimestamp();
+        ret = RedImapAllocExtent( benchEXTENT_BLOCKS, &ulBlock, &ulCount );
+        ullSamples[ i ] = ullBenchTimestamp() - ullStart;
+
+        vBenchCheck( ( ret == 0 ) && ( ulCount >= 1U ) && ( ulCount <= benchEXTENT_BLOCKS ), "RedImapAllocExtent() failed" );
+        ulBlocks += ulCount;
+
+        for( j = 0; j < ulCount; j++ )
+        {
+            prvAllocated( ulBlock + j );
+            prvFreeRandom();
+        }
+
+        if( ( i % benchTXN_ALLOCS ) == ( benchTXN_ALLOCS - 1U ) )
+        {
+            prvTransact();
+        }
+    }
+
+    vBenchRecordResult( "alloc_extent_16", ulPercent, ullSamples, benchSAMPLES );
+    printf( "alloc_extent_16: %.2f blocks per allocation at %lu%% full\n",
+            ( double ) ulBlocks / benchSAMPLES, ( unsigned long ) ulPercent );
+}
+
+/* The first free block at or after ulBlock, wrapping around, according to the
+ * expected allocation states. */
+static uint32_t prvShadowFindFree( uint32_t ulBlock )
+{
+    uint32_t i, ulCandidate;
+
+    for( i = 0; i < gpRedVolume->ulBlocksAllocable; i++ )
+    {
+        ulCandidate = ulBlock + i;
+
+        if( ulCandidate >= benchVOLUME_BLOCKS )
+        {
+            ulCandidate -= gpRedVolume->ulBlocksAllocable;
+        }
+
+        if( ucShadow[ ulCandidate ] == ( uint8_t ) ALLOCSTATE_FREE )
+        {
+            return ulCandidate;
+        }
+    }
+
+    return UINT32_MAX;
+}
+
+/* Mix allocations of extents of random length, frees and transactions, checking
+ * every allocation against the expected states, then check the state of
+ * every block and, if enabled, the free space summary. */
+static void prvCheckConsistency( void )
+{
+    uint32_t i, j, ulBlock, ulCount, ulMax, ulExpected;
+    ALLOCSTATE state;
+
+    prvFormat( 95U );
+
+    for( i = 0; i < 4U * benchSAMPLES; i++ )
+    {
+        switch( ulBenchRandom() % 8U )
+        {
+            case 0:
+                prvTransact();
+                break;
+
+            case 1:
+            case 2:
+            case 3:
+                prvFreeRandom();
+                break;
+
+            default:
+                ulMax = 1U + ( ulBenchRandom() % benchEXTENT_BLOCKS );
+                ulExpected = prvShadowFindFree( gpRedMR->ulAllocNextBlock );
+
+                if( ( ulExpected == UINT32_MAX ) || ( gpRedMR->ulFreeBlocks < ulMax ) )
+                {
+                    prvTransact();
+                    break;
+                }
+
+                vBenchCheck( RedImapAllocExtent( ulMax, &ulBlock, &ulCount ) == 0, "RedImapAllocExtent() failed" );
+                vBenchCheck( ulBlock == ulExpected, "allocation did not start at the next free block" );
+
+                for( j = 0; j < ulCount; j++ )
+                {
+                    prvAllocated( ulBlock + j );
+                }
+
+                vBenchCheck( ( ulCount == ulMax ) ||
+                             ( ulBlock + ulCount == benchVOLUME_BLOCKS ) ||
+                             ( ucShadow[ ulBlock + ulCount ] != ( uint8_t ) ALLOCSTATE_FREE ), "extent stopped short" );
+                break;
+        }
+    }
+
+    for( i = gpRedCoreVol->ulFirstAllocableBN; i < benchVOLUME_BLOCKS; i++ )
+    {
+        vBenchCheck( RedImapBlockState( i, &state ) == 0, "RedImapBlockState() failed" );
+        vBenchCheck( ( uint8_t ) state == ucShadow[ i ], "wrong allocation state" );
+    }
+
+    #if REDCONF_IMAP_SUMMARY_GROUPS > 0U
+        for( i = 0; i < REDCONF_IMAP_SUMMARY_GROUPS; i++ )
+        {
+            uint32_t ulFree = 0, ulAlmostFree = 0;
+
+            for( j = 0; j < gpRedCoreVol->ulSummaryGroupBlocks; j++ )
+            {
+                ulBlock = gpRedCoreVol->ulFirstAllocableBN + ( i * gpRedCoreVol->ulSummaryGroupBlocks ) + j;
+
+                if( ulBlock < benchVOLUME_BLOCKS )
+                {
+                    ulFree += ( ucShadow[ ulBlock ] == ( uint8_t ) ALLOCSTATE_FREE ) ? 1U : 0U;
+                    ulAlmostFree += ( ucShadow[ ulBlock ] == ( uint8_t ) ALLOCSTATE_AFREE ) ? 1U : 0U;
+                }
+            }
+
+            vBenchCheck( ( gpRedCoreVol->aulSummaryFree[ i ] == ulFree ) &&
+                         ( gpRedCoreVol->aulSummaryAlmostFree[ i ] == ulAlmostFree ), "free space summary is wrong" );
+        }
+    #endif
+}
+
+int main( void )
+{
+    static const uint32_t ulPercents[] = { 50U, 90U, 99U };
+    char cFileName[ 64 ];
+    uint32_t i;
+
+    vBenchSeed( 1U );
+    prvCheckConsistency();
+
+    for( i = 0; i < sizeof( ulPercents ) / sizeof( ulPercents[ 0 ] ); i++ )
+    {
+        vBenchSeed( 1U );
+        prvBenchAllocBlock( ulPercents[ i ] );
+        prvBenchAllocExtent( ulPercents[ i ] );
+    }
+
+    snprintf( cFileName, sizeof( cFileName ), "imap_bench_summary_%lu.json", ( unsigned long ) REDCONF_IMAP_SUMMARY_GROUPS );
+
+    return iBenchWriteResults( cFileName, "percent_full" );
+}
@@ -0,0 +1,215 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file memory_bench.c
+ *
+ * Memory primitive micro-benchmarks. Built once for each REDCONF_MEMORY_SIMD
+ * in BENCH_MEMORY_SIMD, this first checks RedMemCpy(), RedMemMove(),
+ * RedMemSet() and RedMemCmp() against the C library over every alignment of
+ * both buffers, many lengths and overlaps, then times each of them from
+ * 16 bytes to 64 KiB, with the buffers word aligned and misaligned.
+ */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Reliance Edge includes. */
+#include <redfs.h>
+
+#include "bench_common.h"
+
+/* ===========================  LOCAL DEFINITIONS  ========================== */
+
+/* Longest length timed or checked. */
+#define benchMEM_MAX_LENGTH    ( 65536U )
+
+/* Misalignment of the destination in the misaligned timings. */
+#define benchMEM_MISALIGN      ( 1U )
+
+/* ============================  LOCAL VARIABLES  =========================== */
+
+static uint64_t ullSamples[ benchSAMPLES ];
+
+/* Source and destination, with room for any alignment, and a copy of the
+ * destination the C library works on for the checks. */
+static uint8_t ucSrc[ benchMEM_MAX_LENGTH + 16U ] __attribute__( ( aligned( 16 ) ) );
+static uint8_t ucDest[ benchMEM_MAX_LENGTH + 16U ] __attribute__( ( aligned( 16 ) ) );
+static uint8_t ucExpected[ benchMEM_MAX_LENGTH + 16U ];
+
+static const uint32_t xLengths[] = { 16U, 64U, 256U, 1024U, 4096U, benchMEM_MAX_LENGTH };
+
+/* Receives every comparison timed, so none is optimized away. */
+static volatile int32_t lCmpSink;
+
+/* =============================  HELPER FUNCTIONS  ========================= */
+
+static void prvFillRandom( uint8_t * pucBuffer,
+                           uint32_t ulLength )
+{
+    uint32_t i;
+
+    for( i = 0; i < ulLength; i++ )
+    {
+        pucBuffer[ i ] = ( uint8_t ) ulBenchRandom();
+    }
+}
+
+/* The sign of a comparison, as RedMemCmp() returns it. */
+static int32_t prvSign( int iResult )
+{
+    return ( iResult > 0 ) - ( iResult < 0 );
+}
+
+/* ==============================  Benchmarks  ============================== */
+
+/* Check each primitive against the C library, including the bytes around
+ * what it should have written. */
+static void prvCheckMemory( void )
+{
+    uint32_t ulDestOff, ulSrcOff, ulLength, ulDiff;
+    uint8_t ucVal;
+
+    for( ulDestOff = 0; ulDestOff < 8U; ulDestOff++ )
+    {
+        for( ulSrcOff = 0; ulSrcOff < 8U; ulSrcOff++ )
+        {
+            for( ulLength = 0; ulLength <= 300U; ulLength++ )
+            {
+                prvFillRandom( ucSrc, sizeof( ucSrc ) );
+                prvFillRandom( ucDest, sizeof( ucDest ) );
+                memcpy( ucExpected, ucDest, sizeof( ucDest ) );
+
+                RedMemCpy( &ucDest[ ulDestOff ], &ucSrc[ ulSrcOff ], ulLength );
+                memcpy( &ucExpected[ ulDestOff ], &ucSrc[ ulSrcOff ], ulLength );
+                vBenchCheck( memcmp( ucDest, ucExpected, sizeof( ucDest ) ) == 0, "RedMemCpy() differs from memcpy()" );
+
+                ucVal = ( uint8_t ) ulBenchRandom();
+                RedMemSet( &ucDest[ ulDestOff ], ucVal, ulLength );
+                memset( &ucExpected[ ulDestOff ], ucVal, ulLength );
+                vBenchCheck( memcmp( ucDest, ucExpected, sizeof( ucDest ) ) == 0, "RedMemSet() differs from memset()" );
+
+                /* Overlapping moves, in both directions, within ucDest. */
+                RedMemMove( &ucDest[ ulDestOff ], &ucDest[ ulSrcOff + 8U ], ulLength );
+                memmove( &ucExpected[ ulDestOff ], &ucExpected[ ulSrcOff + 8U ], ulLength );
+                vBenchCheck( memcmp( ucDest, ucExpected, sizeof( ucDest ) ) == 0, "RedMemMove() down differs from memmove()" );
+
+                RedMemMove( &ucDest[ ulSrcOff + 8U ], &ucDest[ ulDestOff ], ulLength );
+                memmove( &ucExpected[ ulSrcOff + 8U ], &ucExpected[ ulDestOff ], ulLength );
+                vBenchCheck( memcmp( ucDest, ucExpected, sizeof( ucDest ) ) == 0, "RedMemMove() up differs from memmove()" );
+
+                /* Compare equal buffers, then ones differing at one byte. */
+                memcpy( &ucDest[ ulDestOff ], &ucSrc[ ulSrcOff ], ulLength );
+                vBenchCheck( RedMemCmp( &ucDest[ ulDestOff ], &ucSrc[ ulSrcOff ], ulLength ) == 0, "RedMemCmp() of equal buffers" );
+
+                if( ulLength > 0U )
+                {
+                    ulDiff = ulBenchRandom() % ulLength;
+                    ucDest[ ulDestOff + ulDiff ] = ( uint8_t ) ( ucDest[ ulDestOff + ulDiff ] + 1U + ( ulBenchRandom() % 255U ) );
+                    vBenchCheck( RedMemCmp( &ucDest[ ulDestOff ], &ucSrc[ ulSrcOff ], ulLength ) ==
+                                 prvSign( memcmp( &ucDest[ ulDestOff ], &ucSrc[ ulSrcOff ], ulLength ) ),
+                                 "RedMemCmp() differs from memcmp()" );
+                }
+            }
+        }
+    }
+}
+
+/* Time each primitive over each length, with the destination offset by
+ * ulDestOff from a word boundary. */
+static void prvBenchMemory( uint32_t ulDestOff,
+                            const char * pcCpyName,
+                            const char * pcMoveName,
+                            const char * pcSetName,
+                            const char * pcCmpName )
+{
+    uint64_t ullStart;
+    uint32_t i, ulLength;
+    uint8_t * pucDest = &ucDest[ ulDestOff ];
+    size_t x;
+
+    for( x = 0; x < sizeof( xLengths ) / sizeof( xLengths[ 0 ] ); x++ )
+    {
+        ulLength = xLengths[ x ];
+
+        for( i = 0; i < benchSAMPLES; i++ )
+        {
+            ullStart = ullBenchTimestamp();
+            RedMemCpy( pucDest, ucSrc, ulLength );
+            ullSamples[ i ] = ullBenchTimestamp() - ullStart;
+        }
+
+        vBenchRecordResult( pcCpyName, ulLength, ullSamples, benchSAMPLES );
+
+        for( i = 0; i < benchSAMPLES; i++ )
+        {
+            /* Overlapping, as when a directory entry is moved up a block. */
+            ullStart = ullBenchTimestamp();
+            RedMemMove( pucDest, &pucDest[ 8U ], ulLength );
+            ullSamples[ i ] = ullBenchTimestamp() - ullStart;
+        }
+
+        vBenchRecordResult( pcMoveName, ulLength, ullSamples, benchSAMPLES );
+
+        for( i = 0; i < benchSAMPLES; i++ )
+        {
+            ullStart = ullBenchTimestamp();
+            RedMemSet( pucDest, ( uint8_t ) i, ulLength );
+            ullSamples[ i ] = ullBenchTimestamp() - ullStart;
+        }
+
+        /* Equal buffers, the worst case, which compares every byte. */
+        memcpy( pucDest, ucSrc, ulLength );
+
+        vBenchRecordResult( pcSetName, ulLength, ullSamples, benchSAMPLES );
+
+        for( i = 0; i < benchSAMPLES; i++ )
+        {
+            ullStart = ullBenchTimestamp();
+            lCmpSink = RedMemCmp( pucDest, ucSrc, ulLength );
+            ullSamples[ i ] = ullBenchTimestamp() - ullStart;
+        }
+
+        vBenchRecordResult( pcCmpName, ulLength, ullSamples, benchSAMPLES );
+    }
+}
+
+int main( void )
+{
+    char cFileName[ 64 ];
+
+    vBenchSeed( 1U );
+    prvCheckMemory();
+
+    prvFillRandom( ucSrc, sizeof( ucSrc ) );
+    prvBenchMemory( 0U, "memcpy_aligned", "memmove_aligned", "memset_aligned", "memcmp_aligned" );
+    prvBenchMemory( benchMEM_MISALIGN, "memcpy_misaligned", "memmove_misaligned", "memset_misaligned", "memcmp_misaligned" );
+
+    snprintf( cFileName, sizeof( cFileName ), "memory_bench_simd_%d.json", REDCONF_MEMORY_SIMD );
+
+    return iBenchWriteResults( cFileName, "length" );
+}
@@ -0,0 +1,122 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file redconf.h
+ *
+ * Reliance Edge configuration for the host benchmarks, derived from the
+ * Windows simulator demo configuration.  The portable RedMem*() functions in
+ * util/memory.c are used, as on targets which do not map them to the C
+ * library.  Settings a benchmark varies may be overridden on the command line.
+ */
+#ifndef REDCONF_H
+#define REDCONF_H
+
+#define REDCONF_READ_ONLY                0
+
+#define REDCONF_API_POSIX                1
+
+#define REDCONF_API_FSE                  0
+
+#define REDCONF_API_POSIX_FORMAT         1
+
+#define REDCONF_API_POSIX_LINK           1
+
+#define REDCONF_API_POSIX_UNLINK         1
+
+#define REDCONF_API_POSIX_MKDIR          1
+
+#define REDCONF_API_POSIX_RMDIR          1
+
+#define REDCONF_API_POSIX_RENAME         1
+
+#define REDCONF_RENAME_ATOMIC            1
+
+#define REDCONF_API_POSIX_FTRUNCATE      1
+
+#define REDCONF_API_POSIX_READDIR        1
+
+#define REDCONF_NAME_MAX                 28U
+
+#define REDCONF_PATH_SEPARATOR           '/'
+
+#define REDCONF_TASK_COUNT               10U
+
+#define REDCONF_HANDLE_COUNT             10U
+
+#define REDCONF_API_FSE_FORMAT           0
+
+#define REDCONF_API_FSE_TRUNCATE         0
+
+#define REDCONF_API_FSE_TRANSMASKGET     0
+
+#define REDCONF_API_FSE_TRANSMASKSET     0
+
+#define REDCONF_OUTPUT                   0
+
+#define REDCONF_ASSERTS                  1
+
+#define REDCONF_BLOCK_SIZE               512U
+
+#define REDCONF_VOLUME_COUNT             1U
+
+#define REDCONF_ENDIAN_BIG               0
+
+#define REDCONF_ALIGNMENT_SIZE           8U
+
+#ifndef REDCONF_CRC_ALGORITHM
+    #define REDCONF_CRC_ALGORITHM        CRC_SLICEBY8
+#endif
+
+#define REDCONF_INODE_BLOCKS             1
+
+#define REDCONF_INODE_TIMESTAMPS         1
+
+#define REDCONF_ATIME                    0
+
+#define REDCONF_DIRECT_POINTERS          4U
+
+#define REDCONF_INDIRECT_POINTERS        32U
+
+#ifndef REDCONF_BUFFER_COUNT
+    #define REDCONF_BUFFER_COUNT         12U
+#endif
+
+#define REDCONF_TRANSACT_DEFAULT         ( ( RED_TRANSACT_CREAT | RED_TRANSACT_MKDIR | RED_TRANSACT_RENAME | RED_TRANSACT_LINK | RED_TRANSACT_UNLINK | RED_TRANSACT_FSYNC | RED_TRANSACT_CLOSE | RED_TRANSACT_VOLFULL | RED_TRANSACT_UMOUNT ) & RED_TRANSACT_MASK )
+
+#define REDCONF_IMAP_INLINE              0
+
+#define REDCONF_IMAP_EXTERNAL            1
+
+#define REDCONF_DISCARDS                 0
+
+#define REDCONF_IMAGE_BUILDER            0
+
+#define REDCONF_CHECKER                  0
+
+#define RED_CONFIG_UTILITY_VERSION       0x2000000U
+
+#define RED_CONFIG_MINCOMPAT_VER         0x1000200U
+
+#endif /* REDCONF_H */
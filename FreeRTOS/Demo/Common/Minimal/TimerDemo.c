@@ -53,6 +53,29 @@
     #define tmrTIMER_TEST_TASK_STACK_SIZE    configMINIMAL_STACK_SIZE
 #endif
 
+/* The number of timers kept active at once by the stress test. */
+#ifndef tmrdemoSTRESS_TIMERS
+    #define tmrdemoSTRESS_TIMERS    ( ( size_t ) 10000 )
+#endif
+
+/* The shortest stress timer period.  Every start, reset and stop command of a
+ * stress run must be processed within this time, so no stress timer expires
+ * before the test has finished manipulating it. */
+#ifndef tmrdemoSTRESS_MIN_PERIOD
+    #define tmrdemoSTRESS_MIN_PERIOD    pdMS_TO_TICKS( 2000 )
+#endif
+
+/* The stress timer periods are spread over this many ticks above the minimum,
+ * so many timers share each expiry tick. */
+#define tmrdemoSTRESS_PERIOD_SPREAD    ( xBasePeriod * ( TickType_t ) 4 )
+
+/* The number of timers re-armed in a single burst by the re-arm burst test.
+ * More commands are sent than the timer command queue can hold, so a kernel
+ * that defers all commands to the timer service task will drop some. */
+#ifndef tmrdemoREARM_BURST_TIMERS
+    #define tmrdemoREARM_BURST_TIMERS    ( ( size_t ) configTIMER_QUEUE_LENGTH * ( size_t ) 4 )
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* The callback functions used by the timers.  These each increment a counter
@@ -67,6 +90,8 @@ static void prvOneShotTimerCallback( TimerHandle_t pxExpiredTimer );
 static void prvTimerTestTask( void * pvParameters );
 static void prvISRAutoReloadTimerCallback( TimerHandle_t pxExpiredTimer );
 static void prvISROneShotTimerCallback( TimerHandle_t pxExpiredTimer );
+static void prvStressTimerCallback( TimerHandle_t pxExpiredTimer );
+static void prvRearmBurstTimerCallback( TimerHandle_t pxExpiredTimer );
 
 /* The test functions used by the timer test task.  These manipulate the auto
  * reload and one-shot timers in various ways, then delay, then inspect the timers
@@ -78,6 +103,8 @@ static void prvTest4_CheckAutoReloadTimersCanBeStopped( void );
 static void prvTest5_CheckBasicOneShotTimerBehaviour( void );
 static void prvTest6_CheckAutoReloadResetBehaviour( void );
 static void prvTest7_CheckBacklogBehaviour( void );
+static void prvTest8_CheckStressBehaviour( void );
+static void prvTest9_CheckRearmBurstBehaviour( void );
 static void prvResetStartConditionsForNextIteration( void );
 
 /*-----------------------------------------------------------*/
@@ -91,6 +118,13 @@ static volatile BaseType_t xTestStatus = pdPASS;
  * calling xTaskCatchUpTicks(). */
 static uint8_t ucIsBacklogDemoEnabled = ( uint8_t ) pdFALSE;
 
+/* Flag indicating whether the testing includes the stress demo.  The stress
+ * demo allocates tmrdemoSTRESS_TIMERS timers, so is not included by default. */
+static uint8_t ucIsStressDemoEnabled = ( uint8_t ) pdFALSE;
+
+/* Flag indicating whether the testing includes the re-arm burst demo. */
+static uint8_t ucIsRearmBurstDemoEnabled = ( uint8_t ) pdFALSE;
+
 /* Counter that is incremented on each cycle of a test.  This is used to
  * detect a stalled task - a test that is no longer running. */
 static volatile uint32_t ulLoopCounter = 0;
@@ -126,6 +160,39 @@ static uint8_t ucISROneShotTimerCounter = ( uint8_t ) 0;
  * period is configured by the parameter to vStartTimerDemoTask(). */
 static TickType_t xBasePeriod = 0;
 
+/* The stress test timers, and a count of the number of times each has expired.
+ * Both are allocated the first time the stress test runs.  The timer ID of each
+ * stress timer is its index into these arrays. */
+static TimerHandle_t * pxStressTimers = NULL;
+static uint8_t * pucStressTimerCounters = NULL;
+
+/* The tick count at which the current stress run started, and the expiry time
+ * of the most recently executed stress timer callback.  Callbacks must execute
+ * in expiry time order. */
+static TickType_t xStressStartTime = 0;
+static TickType_t xStressLastExpiryTime = 0;
+
+/* The longest time, in ticks, between a stress timer's expiry time and the
+ * execution of its callback over all stress runs.  Not checked, but reported by
+ * vTimerDemoGetStressResults() to compare timer service task latency between
+ * builds. */
+static volatile TickType_t xStressMaxLatency = 0;
+
+/* The re-arm burst test timers, a count of the number of times each has
+ * expired, and whether the command that re-armed each was accepted.  All are
+ * allocated the first time the re-arm burst test runs.  The timer ID of each
+ * timer is its index into these arrays. */
+static TimerHandle_t * pxRearmBurstTimers = NULL;
+static uint8_t * pucRearmBurstTimerCounters = NULL;
+static uint8_t * pucRearmBurstAccepted = NULL;
+
+/* The number of re-arm commands that could not be sent during the most recent
+ * re-arm burst, and the longest time, in ticks, between a re-armed timer's
+ * expiry time and the execution of its callback over all bursts.  Both are
+ * reported by vTimerDemoGetRearmBurstResults(). */
+static volatile UBaseType_t uxRearmBurstCommandsDropped = 0;
+static volatile TickType_t xRearmBurstMaxLatency = 0;
+
 /*-----------------------------------------------------------*/
 
 void vStartTimerDemoTask( TickType_t xBasePeriodIn )
@@ -160,6 +227,32 @@ void vTimerDemoIncludeBacklogTests( BaseType_t includeBacklogTests )
 }
 /*-----------------------------------------------------------*/
 
+void vTimerDemoIncludeStressTests( BaseType_t includeStressTests )
+{
+    ucIsStressDemoEnabled = ( uint8_t ) includeStressTests;
+}
+/*-----------------------------------------------------------*/
+
+void vTimerDemoGetStressResults( TickType_t * pxMaxLatency )
+{
+    *pxMaxLatency = xStressMaxLatency;
+}
+/*-----------------------------------------------------------*/
+
+void vTimerDemoIncludeRearmBurstTests( BaseType_t includeRearmBurstTests )
+{
+    ucIsRearmBurstDemoEnabled = ( uint8_t ) includeRearmBurstTests;
+}
+/*-----------------------------------------------------------*/
+
+void vTimerDemoGetRearmBurstResults( UBaseType_t * puxCommandsDropped,
+                                     TickType_t * pxMaxLatency )
+{
+    *puxCommandsDropped = uxRearmBurstCommandsDropped;
+    *pxMaxLatency = xRearmBurstMaxLatency;
+}
+/*-----------------------------------------------------------*/
+
 static void prvTimerTestTask( void * pvParameters )
 {
     ( void ) pvParameters;
@@ -219,6 +312,19 @@ static void prvTimerTestTask( void * pvParameters )
             prvTest7_CheckBacklogBehaviour();
         }
 
+        /* Check timer behaviour when a large number of timers are active. */
+        if( ucIsStressDemoEnabled == ( uint8_t ) pdTRUE )
+        {
+            prvTest8_CheckStressBehaviour();
+        }
+
+        /* Check timer behaviour when more timers are re-armed at once than the
+         * timer command queue can hold. */
+        if( ucIsRearmBurstDemoEnabled == ( uint8_t ) pdTRUE )
+        {
+            prvTest9_CheckRearmBurstBehaviour();
+        }
+
         /* Start the timers again to restart all the tests over again. */
         prvResetStartConditionsForNextIteration();
     }
@@ -246,6 +352,18 @@ BaseType_t xAreTimerDemoTasksStillRunning( TickType_t xCycleFrequency )
      * necessary because the tests in this file block for extended periods, and the
      * block period might be longer than the time between calls to this function. */
     xMaxBlockTimeUsedByTheseTests = ( ( TickType_t ) configTIMER_QUEUE_LENGTH ) * xBasePeriod;
+
+    if( ucIsStressDemoEnabled == ( uint8_t ) pdTRUE )
+    {
+        /* The stress test blocks for longer than any of the other tests. */
+        xMaxBlockTimeUsedByTheseTests += ( tmrdemoSTRESS_MIN_PERIOD * ( TickType_t ) 2 ) + tmrdemoSTRESS_PERIOD_SPREAD + xBasePeriod;
+    }
+
+    if( ucIsRearmBurstDemoEnabled == ( uint8_t ) pdTRUE )
+    {
+        xMaxBlockTimeUsedByTheseTests += xBasePeriod * ( TickType_t ) 2;
+    }
+
     xLoopCounterIncrementTimeMax = ( xMaxBlockTimeUsedByTheseTests / xCycleFrequency ) + 1;
 
     /* If the demo task is still running then the loop counter is expected to
@@ -799,6 +917,211 @@ static void prvTest7_CheckBacklogBehaviour( void )
 }
 /*-----------------------------------------------------------*/
 
+static void prvTest8_CheckStressBehaviour( void )
+{
+    size_t uxTimer;
+    TickType_t xPeriod;
+
+    /* Create the stress timers the first time this test runs.  They are one-shot
+     * timers, so are inactive between runs. */
+    if( pxStressTimers == NULL )
+    {
+        pxStressTimers = ( TimerHandle_t * ) pvPortMalloc( tmrdemoSTRESS_TIMERS * sizeof( TimerHandle_t ) );
+        pucStressTimerCounters = ( uint8_t * ) pvPortMalloc( tmrdemoSTRESS_TIMERS * sizeof( uint8_t ) );
+
+        if( ( pxStressTimers == NULL ) || ( pucStressTimerCounters == NULL ) )
+        {
+            xTestStatus = pdFAIL;
+            configASSERT( xTestStatus );
+            return;
+        }
+
+        for( uxTimer = 0; uxTimer < tmrdemoSTRESS_TIMERS; uxTimer++ )
+        {
+            pxStressTimers[ uxTimer ] = xTimerCreate( "Stress",                 /* Text name to facilitate debugging.  The kernel does not use this itself. */
+                                                      tmrdemoSTRESS_MIN_PERIOD, /* The period is set again before the timer is started. */
+                                                      pdFALSE,                  /* One-shot timer. */
+                                                      ( void * ) uxTimer,       /* The ID is the index into the stress arrays. */
+                                                      prvStressTimerCallback ); /* The callback executed when the timer expires. */
+
+            if( pxStressTimers[ uxTimer ] == NULL )
+            {
+                xTestStatus = pdFAIL;
+                configASSERT( xTestStatus );
+                return;
+            }
+        }
+    }
+
+    memset( pucStressTimerCounters, 0x00, tmrdemoSTRESS_TIMERS * sizeof( uint8_t ) );
+    xStressStartTime = xTaskGetTickCount();
+    xStressLastExpiryTime = xStressStartTime;
+
+    /* Start every timer with a period that does not follow the order in which
+     * the timers are started, so each start inserts somewhere in the middle of
+     * the set of active timers.  Changing the period of a dormant timer also
+     * starts it.  This task runs below the timer service task, so each command
+     * is processed before the next is sent. */
+    for( uxTimer = 0; uxTimer < tmrdemoSTRESS_TIMERS; uxTimer++ )
+    {
+        xPeriod = tmrdemoSTRESS_MIN_PERIOD + ( ( TickType_t ) ( ( uxTimer * ( size_t ) 7919 ) % ( size_t ) tmrdemoSTRESS_PERIOD_SPREAD ) );
+        xTimerChangePeriod( pxStressTimers[ uxTimer ], xPeriod, portMAX_DELAY );
+    }
+
+    /* Reset every third timer, which moves it later, and stop every fifth. */
+    for( uxTimer = 0; uxTimer < tmrdemoSTRESS_TIMERS; uxTimer++ )
+    {
+        if( ( uxTimer % ( size_t ) 5 ) == ( size_t ) 0 )
+        {
+            xTimerStop( pxStressTimers[ uxTimer ], portMAX_DELAY );
+        }
+        else if( ( uxTimer % ( size_t ) 3 ) == ( size_t ) 0 )
+        {
+            xTimerReset( pxStressTimers[ uxTimer ], portMAX_DELAY );
+        }
+    }
+
+    /* If sending the commands took longer than the shortest period then some
+     * timers may have expired before they were reset or stopped, and the counts
+     * checked below are meaningless.  Either the timer service task is too slow
+     * for this many timers or tmrdemoSTRESS_MIN_PERIOD needs increasing. */
+    if( ( xTaskGetTickCount() - xStressStartTime ) >= tmrdemoSTRESS_MIN_PERIOD )
+    {
+        xTestStatus = pdFAIL;
+        configASSERT( xTestStatus );
+    }
+
+    /* Wait until every timer that is still active has expired. */
+    vTaskDelay( tmrdemoSTRESS_MIN_PERIOD + tmrdemoSTRESS_PERIOD_SPREAD + xBasePeriod );
+
+    /* Every timer that was not stopped must have expired exactly once, and
+     * every timer that was stopped must not have expired at all. */
+    for( uxTimer = 0; uxTimer < tmrdemoSTRESS_TIMERS; uxTimer++ )
+    {
+        if( xTimerIsTimerActive( pxStressTimers[ uxTimer ] ) != pdFALSE )
+        {
+            xTestStatus = pdFAIL;
+            configASSERT( xTestStatus );
+        }
+
+        if( ( uxTimer % ( size_t ) 5 ) == ( size_t ) 0 )
+        {
+            if( pucStressTimerCounters[ uxTimer ] != ( uint8_t ) 0 )
+            {
+                xTestStatus = pdFAIL;
+                configASSERT( xTestStatus );
+            }
+        }
+        else if( pucStressTimerCounters[ uxTimer ] != ( uint8_t ) 1 )
+        {
+            xTestStatus = pdFAIL;
+            configASSERT( xTestStatus );
+        }
+    }
+
+    if( xTestStatus == pdPASS )
+    {
+        /* No errors have been reported so increment the loop counter so the check
+         * task knows this task is still running. */
+        ulLoopCounter++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvTest9_CheckRearmBurstBehaviour( void )
+{
+    size_t uxTimer;
+    UBaseType_t uxCommandsDropped = 0;
+
+    /* Create the re-arm burst timers the first time this test runs.  They are
+     * one-shot timers, so are inactive between runs. */
+    if( pxRearmBurstTimers == NULL )
+    {
+        pxRearmBurstTimers = ( TimerHandle_t * ) pvPortMalloc( tmrdemoREARM_BURST_TIMERS * sizeof( TimerHandle_t ) );
+        pucRearmBurstTimerCounters = ( uint8_t * ) pvPortMalloc( tmrdemoREARM_BURST_TIMERS * sizeof( uint8_t ) );
+        pucRearmBurstAccepted = ( uint8_t * ) pvPortMalloc( tmrdemoREARM_BURST_TIMERS * sizeof( uint8_t ) );
+
+        if( ( pxRearmBurstTimers == NULL ) || ( pucRearmBurstTimerCounters == NULL ) || ( pucRearmBurstAccepted == NULL ) )
+        {
+            xTestStatus = pdFAIL;
+            configASSERT( xTestStatus );
+            return;
+        }
+
+        for( uxTimer = 0; uxTimer < tmrdemoREARM_BURST_TIMERS; uxTimer++ )
+        {
+            pxRearmBurstTimers[ uxTimer ] = xTimerCreate( "Rearm",                      /* Text name to facilitate debugging.  The kernel does not use this itself. */
+                                                          xBasePeriod,                  /* All the timers in a burst expire together. */
+                                                          pdFALSE,                      /* One-shot timer. */
+                                                          ( void * ) uxTimer,           /* The ID is the index into the re-arm burst arrays. */
+                                                          prvRearmBurstTimerCallback ); /* The callback executed when the timer expires. */
+
+            if( pxRearmBurstTimers[ uxTimer ] == NULL )
+            {
+                xTestStatus = pdFAIL;
+                configASSERT( xTestStatus );
+                return;
+            }
+        }
+    }
+
+    memset( pucRearmBurstTimerCounters, 0x00, tmrdemoREARM_BURST_TIMERS * sizeof( uint8_t ) );
+    memset( pucRearmBurstAccepted, 0x00, tmrdemoREARM_BURST_TIMERS * sizeof( uint8_t ) );
+
+    /* Re-arm every timer with the scheduler suspended, so the timer service task
+     * cannot drain the timer command queue part way through the burst.  With the
+     * scheduler suspended the commands are sent without blocking, so a command
+     * that does not fit in the queue is dropped and reported as a failure - which
+     * is what happens to a burst sent from a task that has a higher priority
+     * than the timer service task. */
+    vTaskSuspendAll();
+    {
+        for( uxTimer = 0; uxTimer < tmrdemoREARM_BURST_TIMERS; uxTimer++ )
+        {
+            if( xTimerReset( pxRearmBurstTimers[ uxTimer ], tmrdemoDONT_BLOCK ) == pdPASS )
+            {
+                pucRearmBurstAccepted[ uxTimer ] = ( uint8_t ) pdTRUE;
+            }
+            else
+            {
+                uxCommandsDropped++;
+            }
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    uxRearmBurstCommandsDropped = uxCommandsDropped;
+
+    /* Wait until every timer that was re-armed has expired. */
+    vTaskDelay( xBasePeriod * ( TickType_t ) 2 );
+
+    /* Every timer whose re-arm command was accepted must have expired exactly
+     * once, and every timer whose command was dropped must not have been
+     * started at all. */
+    for( uxTimer = 0; uxTimer < tmrdemoREARM_BURST_TIMERS; uxTimer++ )
+    {
+        if( xTimerIsTimerActive( pxRearmBurstTimers[ uxTimer ] ) != pdFALSE )
+        {
+            xTestStatus = pdFAIL;
+            configASSERT( xTestStatus );
+        }
+
+        if( pucRearmBurstTimerCounters[ uxTimer ] != pucRearmBurstAccepted[ uxTimer ] )
+        {
+            xTestStatus = pdFAIL;
+            configASSERT( xTestStatus );
+        }
+    }
+
+    if( xTestStatus == pdPASS )
+    {
+        /* No errors have been reported so increment the loop counter so the check
+         * task knows this task is still running. */
+        ulLoopCounter++;
+    }
+}
+/*-----------------------------------------------------------*/
+
 static void prvResetStartConditionsForNextIteration( void )
 {
     uint8_t ucTimer;
@@ -1222,3 +1545,71 @@ static void prvISROneShotTimerCallback( TimerHandle_t pxExpiredTimer )
     ucISROneShotTimerCounter++;
 }
 /*-----------------------------------------------------------*/
+
+static void prvStressTimerCallback( TimerHandle_t pxExpiredTimer )
+{
+    size_t uxTimerID;
+    TickType_t xExpiryTime, xLatency;
+
+    uxTimerID = ( size_t ) pvTimerGetTimerID( pxExpiredTimer );
+    xExpiryTime = xTimerGetExpiryTime( pxExpiredTimer );
+
+    if( uxTimerID < tmrdemoSTRESS_TIMERS )
+    {
+        ( pucStressTimerCounters[ uxTimerID ] )++;
+    }
+    else
+    {
+        /* The timer ID appears to be unexpected (invalid). */
+        xTestStatus = pdFAIL;
+        configASSERT( xTestStatus );
+    }
+
+    /* Callbacks must execute in expiry time order.  Times are compared relative
+     * to the start of the run so the comparison survives the tick count
+     * overflowing during the run. */
+    if( ( xExpiryTime - xStressStartTime ) < ( xStressLastExpiryTime - xStressStartTime ) )
+    {
+        xTestStatus = pdFAIL;
+        configASSERT( xTestStatus );
+    }
+
+    xStressLastExpiryTime = xExpiryTime;
+
+    xLatency = xTaskGetTickCount() - xExpiryTime;
+
+    if( xLatency > xStressMaxLatency )
+    {
+        xStressMaxLatency = xLatency;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvRearmBurstTimerCallback( TimerHandle_t pxExpiredTimer )
+{
+    size_t uxTimerID;
+    TickType_t xLatency;
+
+    uxTimerID = ( size_t ) pvTimerGetTimerID( pxExpiredTimer );
+
+    if( uxTimerID < tmrdemoREARM_BURST_TIMERS )
+    {
+        ( pucRearmBurstTimerCounters[ uxTimerID ] )++;
+    }
+    else
+    {
+        /* The timer ID appears to be unexpected (invalid). */
+        xTestStatus = pdFAIL;
+        configASSERT( xTestStatus );
+    }
+
+    /* Commands that wait in the timer command queue are time stamped when they
+     * are sent, so a slow drain shows up as callback latency. */
+    xLatency = xTaskGetTickCount() - xTimerGetExpiryTime( pxExpiredTimer );
+
+    if( xLatency > xRearmBurstMaxLatency )
+    {
+        xRearmBurstMaxLatency = xLatency;
+    }
+}
+/*-----------------------------------------------------------*/
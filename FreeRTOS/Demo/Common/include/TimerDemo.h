@@ -40,4 +40,32 @@ void vTimerPeriodicISRTests( void );
  */
 void vTimerDemoIncludeBacklogTests( BaseType_t includeBacklogTests );
 
+/*
+ * Run a stress test on each cycle that keeps tmrdemoSTRESS_TIMERS (10000 by
+ * default) one-shot timers active at once, starting, resetting and stopping
+ * them while checking every callback executes once, in expiry time order.  The
+ * timers are allocated from the FreeRTOS heap the first time the test runs.
+ */
+void vTimerDemoIncludeStressTests( BaseType_t includeStressTests );
+
+/*
+ * Obtain the longest callback latency, in ticks, of any stress test timer so
+ * far.
+ */
+void vTimerDemoGetStressResults( TickType_t * pxMaxLatency );
+
+/*
+ * Run a test on each cycle that re-arms more one-shot timers at once than the
+ * timer command queue can hold, checking that every timer whose command was
+ * accepted expires once and every other timer does not start.
+ */
+void vTimerDemoIncludeRearmBurstTests( BaseType_t includeRearmBurstTests );
+
+/*
+ * Obtain the number of re-arm commands dropped by the most recent burst, and the
+ * longest callback latency, in ticks, of any re-armed timer so far.
+ */
+void vTimerDemoGetRearmBurstResults( UBaseType_t * puxCommandsDropped,
+                                     TickType_t * pxMaxLatency );
+
 #endif /* TIMER_DEMO_H */
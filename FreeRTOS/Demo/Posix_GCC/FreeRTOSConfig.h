@@ -71,9 +71,11 @@
 
 #define configMAX_PRIORITIES                       ( 7 )
 
-/* Run time stats gathering configuration options. */
-unsigned long ulGetRunTimeCounterValue( void ); /* Prototype of function that returns run time counter. */
-void vConfigureTimerForRunTimeStats( void );    /* Prototype of function that initialises the run time counter. */
+/* Run time stats gathering configuration options.  The counter is 64-bit so
+ * the nanosecond count does not wrap after 4.3 seconds. */
+#define configRUN_TIME_COUNTER_TYPE               uint64_t
+configRUN_TIME_COUNTER_TYPE ulGetRunTimeCounterValue( void ); /* Prototype of function that returns run time counter. */
+void vConfigureTimerForRunTimeStats( void );                  /* Prototype of function that initialises the run time counter. */
 #define configGENERATE_RUN_TIME_STATS             1
 
 /* Co-routine related configuration options. */
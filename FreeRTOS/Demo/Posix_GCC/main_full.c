@@ -242,6 +242,22 @@ int main_full( void )
         {
             /* Don't expect these tasks to pass when preemption is not used. */
             vStartTimerDemoTask( mainTIMER_TEST_PERIOD );
+
+            #if ( projTIMER_BENCHMARK == 1 )
+                {
+                    /* Measure how the timer service task copes with more
+                     * commands than its command queue can hold. */
+                    vTimerDemoIncludeRearmBurstTests( pdTRUE );
+                }
+            #endif
+
+            #if ( projTIMER_STRESS == 1 )
+                {
+                    /* Keep thousands of timers active at once to measure the
+                     * timer service task's latency at that scale. */
+                    vTimerDemoIncludeStressTests( pdTRUE );
+                }
+            #endif
         }
     #endif
 
@@ -430,6 +446,28 @@ static void prvCheckTask( void * pvParameters )
                 pcStatusMessage,
                 xTaskGetTickCount() );
 
+        #if ( ( configUSE_PREEMPTION != 0 ) && ( projTIMER_BENCHMARK == 1 ) )
+            {
+                UBaseType_t uxCommandsDropped;
+                TickType_t xMaxLatency;
+
+                vTimerDemoGetRearmBurstResults( &uxCommandsDropped, &xMaxLatency );
+                printf( "Timer re-arm burst - commands dropped %u, max latency %u ticks \r\n",
+                        ( unsigned int ) uxCommandsDropped,
+                        ( unsigned int ) xMaxLatency );
+            }
+        #endif
+
+        #if ( ( configUSE_PREEMPTION != 0 ) && ( projTIMER_STRESS == 1 ) )
+            {
+                TickType_t xMaxLatency;
+
+                vTimerDemoGetStressResults( &xMaxLatency );
+                printf( "Timer stress - max latency %u ticks \r\n",
+                        ( unsigned int ) xMaxLatency );
+            }
+        #endif
+
         if( xErrorCount != 0 )
         {
             exit( 1 );
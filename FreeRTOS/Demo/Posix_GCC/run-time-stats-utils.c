@@ -32,8 +32,8 @@
  * real time, therefore the run time counter values have no real meaningful
  * units.
  *
- * Also note that it is assumed this demo is going to be used for short periods
- * of time only, and therefore timer overflows are not handled.
+ * The counter is a 64-bit count of nanoseconds, which does not overflow for
+ * about 584 years, so timer overflows are not handled.
  */
 
 #include <time.h>
@@ -42,7 +42,7 @@
 #include <FreeRTOS.h>
 
 /* Time at start of day (in ns). */
-static unsigned long ulStartTimeNs;
+static uint64_t ullStartTimeNs;
 
 /*-----------------------------------------------------------*/
 
@@ -51,17 +51,17 @@ void vConfigureTimerForRunTimeStats( void )
     struct timespec xNow;
 
     clock_gettime( CLOCK_MONOTONIC, &xNow );
-    ulStartTimeNs = xNow.tv_sec * 1000000000ul + xNow.tv_nsec;
+    ullStartTimeNs = ( uint64_t ) xNow.tv_sec * 1000000000ULL + ( uint64_t ) xNow.tv_nsec;
 }
 /*-----------------------------------------------------------*/
 
-unsigned long ulGetRunTimeCounterValue( void )
+configRUN_TIME_COUNTER_TYPE ulGetRunTimeCounterValue( void )
 {
     struct timespec xNow;
 
     /* Time at start. */
     clock_gettime( CLOCK_MONOTONIC, &xNow );
 
-    return xNow.tv_sec * 1000000000ul + xNow.tv_nsec - ulStartTimeNs;
+    return ( uint64_t ) xNow.tv_sec * 1000000000ULL + ( uint64_t ) xNow.tv_nsec - ullStartTimeNs;
 }
 /*-----------------------------------------------------------*/
@@ -100,6 +100,12 @@ typedef unsigned long    UBaseType_t;
 #define portBYTE_ALIGNMENT    8
 #define portNOP()    __asm volatile ( "NOP" )
 
+/* Size of the host's cache lines, used by the smp harness to give the state of
+ * each simulated core a cache line of its own. 0 packs the state together. */
+#ifndef configCACHE_LINE_SIZE
+    #define configCACHE_LINE_SIZE    0
+#endif
+
 /*
  * These define the timer to use for generating the tick interrupt.
  * They are put in this file so they can be shared between "port.c"
@@ -5,42 +5,48 @@ PROJ_GCDA_LIST  :=  $(PROJ_SRC_LIST:.c=.gcda)
 COV_REPORT_DIR  :=  $(SCRATCH_DIR)/coverage
 COVINFO_COMBINE :=  $(SCRATCH_DIR)/$(EXEC_PREFIX)_combined.info
 
+# Each test executable writes its .gcda files below a GCOV_PREFIX tree of its
+# own, so executables sharing the same kernel objects can run concurrently.
+# The per executable coverage is merged afterwards from the lcov tracefiles.
+GCOV_RUN_DIR    :=  $(BUILD_DIR)/gcov/$(EXEC_PREFIX)
+GCOV_RUN_LIST   :=  $(addprefix $(GCOV_RUN_DIR)/,$(SUITE_UT_SRC:.c=.run))
 
 GCOV_OPTS       :=  --unconditional-branches --branch-probabilities
 
-# Cases that run test binaries cannot be run in parallel.
-.NOTPARALLEL : $(COVINFO) $(LCOV_LIST) $(PROJ_GCDA_LIST)
-
 # Prevent deletion of intermediate files
 NO_DELETE : $(MOCK_HDR_LIST) $(MOCK_SRC_LIST) $(MOCK_OBJ_LIST)      \
             $(DEPS_OBJ_LIST) $(SF_OBJ_LIST) $(EXEC_LIST)            \
             $(PROJ_PP_LIST) $(PROJ_OBJ_LIST) $(PROJ_GCDA_LIST)      \
             $(SUITE_OBJ_LIST) $(RUNNER_SRC_LIST) $(RUNNER_OBJ_LIST) \
-            $(COVINFO) $(LCOV_LIST)
+            $(COVINFO) $(LCOV_LIST) $(GCOV_RUN_LIST)
 
 
 # Generate gcov files by default
 run : gcov
 
-gcov : $(PROJ_GCDA_LIST)
+gcov : $(GCOV_RUN_LIST)
 
 clean :
     rm -rf $(SCRATCH_DIR)
+    rm -rf $(GCOV_RUN_DIR)
     rm -f $(BIN_DIR)/$(PROJECT)_utest_*
     rm -f $(COVINFO)
 
 libs :
-    make -C $(UT_ROOT_DIR) libs
-
-define run-test
-$(1)
-endef
-
-$(PROJ_GCDA_LIST) : $(EXEC_LIST)
-    rm -f $(PROJ_DIR)/*.gcda
-    mkdir -p $(BIN_DIR)
-    # run each test case
-    $(foreach bin,$^,$(call run-test,$(bin)))
+    $(MAKE) -C $(UT_ROOT_DIR) libs
+
+# Run a test executable with its own GCOV_PREFIX tree, then copy the .gcno notes
+# of each .gcda file produced next to it so that lcov can process the tree.
+$(GCOV_RUN_DIR)/%_utest.run : $(BIN_DIR)/$(EXEC_PREFIX)_%_utest
+    rm -rf $(GCOV_RUN_DIR)/$*_utest
+    mkdir -p $(GCOV_RUN_DIR)/$*_utest
+    GCOV_PREFIX=$(GCOV_RUN_DIR)/$*_utest GCOV_PREFIX_STRIP=0 $<
+    cd $(GCOV_RUN_DIR)/$*_utest &&                                            \
+        find . -name '*.gcda' | while read gcda ; do                           \
+            gcno="$${gcda#.}" ;                                                \
+            cp "$${gcno%.gcda}.gcno" "$${gcda%.gcda}.gcno" ;                   \
+        done
+    touch $@
 
 # Run and generate lcov
 lcov : $(COVINFO)
@@ -51,6 +57,13 @@ lcovhtml : $(COVINFO)
 
 bin: $(EXEC_LIST)
 
+# Describe each test executable and its tracefiles for tools/impacted.py
+list_tests :
+    @$(foreach ut,$(SUITE_UT_SRC:.c=),                                         \
+        printf 'test\t%s\t%s\t%s\n' '$(CURDIR)' '$(SCRATCH_DIR)/$(ut).info'   \
+            '$(GCOV_RUN_DIR)/$(ut).run' ; )
+    @printf 'initial\t%s\t%s\n' '$(CURDIR)' '$(COVINFO_INITIAL)'
+
 # Run and append to gcov data files
 
 # Generate callgraph for coverage filtering
@@ -63,15 +76,9 @@ $(COVINFO_INITIAL) : $(EXEC_LIST)
     lcov $(LCOV_OPTS) --capture --initial --directory $(SCRATCH_DIR) -o $@
 
 # Run the test runner and genrate a filtered gcov.json.gz file
-$(SCRATCH_DIR)/%_utest.info : $(BIN_DIR)/$(EXEC_PREFIX)_%_utest                \
+$(SCRATCH_DIR)/%_utest.info : $(GCOV_RUN_DIR)/%_utest.run                     \
                               $(PROJ_DIR)/callgraph.json
-    # Remove any existing coverage data
-    rm -f $(PROJ_DIR)/*.gcda
-
-    # run the testrunner
-    $<
-
-    lcov $(LCOV_OPTS) --directory $(SCRATCH_DIR) --capture -o $@
+    lcov $(LCOV_OPTS) --directory $(GCOV_RUN_DIR)/$*_utest --capture -o $@
     # Gather coverage into a json.gz file
 
 #gcov $(GCOV_OPTS) $(SCRATCH_DIR)/$*/$(PROJECT).gcda \
@@ -87,7 +94,6 @@ $(SCRATCH_DIR)/%_utest.info : $(BIN_DIR)/$(EXEC_PREFIX)_%_utest                \
 
     # Remove temporary files
     rm -f $(subst .info,.json.gz,$@)
-    rm -f $(PROJ_GCDA_LIST)
 
 # Combine lcov from each test bin into one lcov info file for the suite
 $(COVINFO_COMBINE) : $(LCOV_LIST)
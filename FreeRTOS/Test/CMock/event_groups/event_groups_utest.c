@@ -28,6 +28,7 @@
 /* C runtime includes. */
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 /* List includes */
 #include "FreeRTOS.h"
@@ -53,6 +54,28 @@
 #define BIT_4            ( 1 << 4 )
 #define ALL_SYNC_BITS    ( BIT_0 | BIT_2 | BIT_4 )
 
+/* Number of tasks blocked on the event group by the scalability tests. */
+#define WAITER_COUNT     ( 500 )
+
+/* Control bits stored in the top byte of a waiting task's event list item value,
+ * as defined in event_groups.c. */
+#ifndef eventCLEAR_EVENTS_ON_EXIT_BIT
+    #if configUSE_16_BIT_TICKS == 1
+        #define eventCLEAR_EVENTS_ON_EXIT_BIT    0x0100U
+        #define eventUNBLOCKED_DUE_TO_BIT_SET    0x0200U
+        #define eventWAIT_FOR_ALL_BITS           0x0400U
+        #define eventEVENT_BITS_CONTROL_BYTES    0xff00U
+    #else
+        #define eventCLEAR_EVENTS_ON_EXIT_BIT    0x01000000UL
+        #define eventUNBLOCKED_DUE_TO_BIT_SET    0x02000000UL
+        #define eventWAIT_FOR_ALL_BITS           0x04000000UL
+        #define eventEVENT_BITS_CONTROL_BYTES    0xff000000UL
+    #endif
+#endif
+
+/* Number of event bits available to the application. */
+#define EVENT_BIT_COUNT    ( ( UBaseType_t ) ( sizeof( EventBits_t ) * 8U ) - 8U )
+
 /* ===========================  GLOBAL VARIABLES  =========================== */
 
 /**
@@ -64,6 +87,15 @@ static List_t * pxListTemp = &xListTemp;
 static ListItem_t xListItemDummy = { 0 };
 static ListItem_t * pxListItem_HasTaskBlockOnBit0 = &xListItemDummy;
 
+/**
+ * @brief Event list items of the tasks blocked on the event group by the
+ * scalability tests, and the value each was unblocked with (0 if the task is
+ * still blocked).
+ */
+static ListItem_t xWaiterItems[ WAITER_COUNT ];
+static TickType_t xWaiterUnblockedValue[ WAITER_COUNT ];
+static UBaseType_t uxWaitersUnblocked;
+
 /* ===========================  EXTERN VARIABLES  =========================== */
 
 /* ==========================  CALLBACK FUNCTIONS =========================== */
@@ -77,6 +109,49 @@ void vPortFree( void * pv )
     return unity_free( pv );
 }
 
+static ListItem_t * listGET_NEXT_WaiterCallback( ListItem_t * pxListItem,
+                                                 int cmock_num_calls )
+{
+    ( void ) cmock_num_calls;
+
+    return pxListItem->pxNext;
+}
+
+static TickType_t listGET_LIST_ITEM_VALUE_WaiterCallback( ListItem_t * pxListItem,
+                                                          int cmock_num_calls )
+{
+    ( void ) cmock_num_calls;
+
+    return pxListItem->xItemValue;
+}
+
+static void vTaskRemoveFromUnorderedEventList_WaiterCallback( ListItem_t * pxEventListItem,
+                                                              const TickType_t xItemValue,
+                                                              int cmock_num_calls )
+{
+    ptrdiff_t xIndex = pxEventListItem - xWaiterItems;
+
+    ( void ) cmock_num_calls;
+
+    TEST_ASSERT_TRUE( ( xIndex >= 0 ) && ( xIndex < WAITER_COUNT ) );
+    TEST_ASSERT_EQUAL( 0, xWaiterUnblockedValue[ xIndex ] );
+
+    xWaiterUnblockedValue[ xIndex ] = xItemValue;
+    uxWaitersUnblocked++;
+
+    /* Unlink the item as the kernel would.  xEventGroupSetBits() has already
+     * read the next item. */
+    pxEventListItem->pxPrevious->pxNext = pxEventListItem->pxNext;
+
+    if( pxEventListItem->pxNext != NULL )
+    {
+        pxEventListItem->pxNext->pxPrevious = pxEventListItem->pxPrevious;
+    }
+
+    pxEventListItem->pxNext = NULL;
+    pxEventListItem->pxPrevious = NULL;
+}
+
 /* ============================  Unity Fixtures  ============================ */
 /*! called before each testcase */
 void setUp( void )
@@ -120,6 +195,85 @@ int suiteTearDown( int numFailures )
 
 /* ===========================  Static Functions  =========================== */
 
+/**
+ * @brief Create an event group and block WAITER_COUNT tasks on it.
+ *
+ * Waiter i waits with the event list item value returned by
+ * pxWaiterValue( i ).  The waiters are linked after the end marker of
+ * xListTemp, which the event group's copy of the list starts from.  The end
+ * marker's own value is 0 so it never matches.  listGET_END_MARKER() returns
+ * NULL, so the walk finishes at the last waiter's NULL next pointer.
+ */
+static void prvCreateEventGroupWithWaiters( StaticEventGroup_t * pxCreatedEventGroup,
+                                            TickType_t ( * pxWaiterValue )( UBaseType_t ) )
+{
+    ListItem_t * pxPrevious = ( ListItem_t * ) &( pxListTemp->xListEnd );
+    UBaseType_t uxWaiter;
+
+    /* Expectation of Function: xEventGroupCreate */
+    vListInitialise_Expect( 0 );
+    vListInitialise_IgnoreArg_pxList();
+    vListInitialise_ReturnThruPtr_pxList( pxListTemp );
+
+    /* Expectation of Function: xEventGroupSetBits */
+    listGET_END_MARKER_IgnoreAndReturn( ( ListItem_t * ) NULL );
+    vTaskSuspendAll_Ignore();
+    listGET_NEXT_StubWithCallback( listGET_NEXT_WaiterCallback );
+    listGET_LIST_ITEM_VALUE_StubWithCallback( listGET_LIST_ITEM_VALUE_WaiterCallback );
+    vTaskRemoveFromUnorderedEventList_StubWithCallback( vTaskRemoveFromUnorderedEventList_WaiterCallback );
+    xTaskResumeAll_IgnoreAndReturn( 1 );
+
+    xEventGroupHandle = xEventGroupCreateStatic( pxCreatedEventGroup );
+    TEST_ASSERT_NOT_NULL( xEventGroupHandle );
+
+    pxListTemp->xListEnd.xItemValue = 0;
+
+    for( uxWaiter = 0; uxWaiter < WAITER_COUNT; uxWaiter++ )
+    {
+        xWaiterItems[ uxWaiter ].xItemValue = pxWaiterValue( uxWaiter );
+        xWaiterItems[ uxWaiter ].pxPrevious = pxPrevious;
+        xWaiterItems[ uxWaiter ].pxNext = NULL;
+        pxPrevious->pxNext = &( xWaiterItems[ uxWaiter ] );
+        pxPrevious = &( xWaiterItems[ uxWaiter ] );
+        xWaiterUnblockedValue[ uxWaiter ] = 0;
+    }
+
+    uxWaitersUnblocked = 0;
+}
+
+/* Waiter i waits for bit ( i % EVENT_BIT_COUNT ) to be set. */
+static TickType_t prvWaitForOneBit( UBaseType_t uxWaiter )
+{
+    return ( TickType_t ) 1 << ( uxWaiter % EVENT_BIT_COUNT );
+}
+
+/* Waiter i waits for both bit ( i % EVENT_BIT_COUNT ) and the bit above it. */
+static TickType_t prvWaitForTwoBits( UBaseType_t uxWaiter )
+{
+    return ( ( TickType_t ) 1 << ( uxWaiter % EVENT_BIT_COUNT ) ) |
+           ( ( TickType_t ) 1 << ( ( uxWaiter + 1 ) % EVENT_BIT_COUNT ) ) |
+           eventWAIT_FOR_ALL_BITS;
+}
+
+/* As prvWaitForOneBit(), with even numbered waiters clearing the bit on exit. */
+static TickType_t prvWaitForOneBitEvenClear( UBaseType_t uxWaiter )
+{
+    TickType_t xValue = prvWaitForOneBit( uxWaiter );
+
+    if( ( uxWaiter % 2 ) == 0 )
+    {
+        xValue |= eventCLEAR_EVENTS_ON_EXIT_BIT;
+    }
+
+    return xValue;
+}
+
+/* Number of waiters in 0 .. WAITER_COUNT - 1 for which i % EVENT_BIT_COUNT == uxBit. */
+static UBaseType_t prvWaitersOnBit( UBaseType_t uxBit )
+{
+    return ( ( WAITER_COUNT - 1 - uxBit ) / EVENT_BIT_COUNT ) + 1;
+}
+
 
 /* ==============================  Test Cases  ============================== */
 
@@ -791,3 +945,147 @@ void test_xEventGroupSetBitsFromISR_Success( void )
     /* API to Test */
     ( void ) xEventGroupSetBitsFromISR( NULL, BIT_0, &xHigherPriorityTaskWoken );
 }
+
+/*!
+ * @brief validate setting one bit with WAITER_COUNT tasks each waiting for any
+ *        of a single bit unblocks exactly the tasks waiting for that bit.
+ * @coverage xEventGroupSetBits
+ */
+void test_xEventGroupSetBits_ManyWaiters_WaitForEither_UnblocksOnlyMatching( void )
+{
+    StaticEventGroup_t xCreatedEventGroup = { 0 };
+    const UBaseType_t uxBit = 5;
+    EventBits_t uxBits;
+    UBaseType_t uxWaiter;
+
+    /* Set-up */
+    prvCreateEventGroupWithWaiters( &xCreatedEventGroup, prvWaitForOneBit );
+
+    /* API to Test */
+    uxBits = xEventGroupSetBits( xEventGroupHandle, ( EventBits_t ) 1 << uxBit );
+
+    /* Validate */
+    TEST_ASSERT_EQUAL( ( EventBits_t ) 1 << uxBit, uxBits );
+    TEST_ASSERT_EQUAL( prvWaitersOnBit( uxBit ), uxWaitersUnblocked );
+
+    for( uxWaiter = 0; uxWaiter < WAITER_COUNT; uxWaiter++ )
+    {
+        if( ( uxWaiter % EVENT_BIT_COUNT ) == uxBit )
+        {
+            TEST_ASSERT_EQUAL( ( ( TickType_t ) 1 << uxBit ) | eventUNBLOCKED_DUE_TO_BIT_SET,
+                               xWaiterUnblockedValue[ uxWaiter ] );
+            TEST_ASSERT_NULL( xWaiterItems[ uxWaiter ].pxNext );
+        }
+        else
+        {
+            TEST_ASSERT_EQUAL( 0, xWaiterUnblockedValue[ uxWaiter ] );
+        }
+    }
+}
+
+/*!
+ * @brief validate tasks waiting for all of two bits with WAITER_COUNT tasks
+ *        blocked are only unblocked once both bits are set, including when
+ *        the bits are set by separate calls.
+ * @coverage xEventGroupSetBits
+ */
+void test_xEventGroupSetBits_ManyWaiters_WaitForAll_UnblocksOnlyMatching( void )
+{
+    StaticEventGroup_t xCreatedEventGroup = { 0 };
+    EventBits_t uxBits;
+    UBaseType_t uxWaiter;
+
+    /* Set-up */
+    prvCreateEventGroupWithWaiters( &xCreatedEventGroup, prvWaitForTwoBits );
+
+    /* API to Test: no waiter wants bit 3 alone. */
+    uxBits = xEventGroupSetBits( xEventGroupHandle, ( EventBits_t ) 1 << 3 );
+
+    /* Validate */
+    TEST_ASSERT_EQUAL( ( EventBits_t ) 1 << 3, uxBits );
+    TEST_ASSERT_EQUAL( 0, uxWaitersUnblocked );
+
+    /* API to Test: bits 3 and 4 are now both set. */
+    uxBits = xEventGroupSetBits( xEventGroupHandle, ( EventBits_t ) 1 << 4 );
+
+    /* Validate */
+    TEST_ASSERT_EQUAL( ( ( EventBits_t ) 1 << 3 ) | ( ( EventBits_t ) 1 << 4 ), uxBits );
+    TEST_ASSERT_EQUAL( prvWaitersOnBit( 3 ), uxWaitersUnblocked );
+
+    /* API to Test: bits 4 and 5 are now both set, and only waiters on
+     * bits 4 and 5 are still blocked on the newly completed pair. */
+    uxBits = xEventGroupSetBits( xEventGroupHandle, ( EventBits_t ) 1 << 5 );
+
+    /* Validate */
+    TEST_ASSERT_EQUAL( prvWaitersOnBit( 3 ) + prvWaitersOnBit( 4 ), uxWaitersUnblocked );
+
+    for( uxWaiter = 0; uxWaiter < WAITER_COUNT; uxWaiter++ )
+    {
+        if( ( uxWaiter % EVENT_BIT_COUNT ) == 3 )
+        {
+            TEST_ASSERT_EQUAL( ( ( TickType_t ) 3 << 3 ) | eventUNBLOCKED_DUE_TO_BIT_SET,
+                               xWaiterUnblockedValue[ uxWaiter ] );
+        }
+        else if( ( uxWaiter % EVENT_BIT_COUNT ) == 4 )
+        {
+            TEST_ASSERT_EQUAL( ( ( TickType_t ) 7 << 3 ) | eventUNBLOCKED_DUE_TO_BIT_SET,
+                               xWaiterUnblockedValue[ uxWaiter ] );
+        }
+        else
+        {
+            TEST_ASSERT_EQUAL( 0, xWaiterUnblockedValue[ uxWaiter ] );
+        }
+    }
+}
+
+/*!
+ * @brief validate bits are cleared on exit only when at least one of the
+ *        unblocked tasks among WAITER_COUNT asked for them to be cleared.
+ * @coverage xEventGroupSetBits
+ */
+void test_xEventGroupSetBits_ManyWaiters_ClearOnExit_ClearsOnlyRequestedBits( void )
+{
+    StaticEventGroup_t xCreatedEventGroup = { 0 };
+    EventBits_t uxBits;
+
+    /* Set-up */
+    prvCreateEventGroupWithWaiters( &xCreatedEventGroup, prvWaitForOneBitEvenClear );
+
+    /* API to Test: EVENT_BIT_COUNT is even, so every waiter on bit 0 clears
+     * its bit on exit and no waiter on bit 1 does. */
+    uxBits = xEventGroupSetBits( xEventGroupHandle, BIT_0 | ( 1 << 1 ) );
+
+    /* Validate */
+    TEST_ASSERT_EQUAL( 1 << 1, uxBits );
+    TEST_ASSERT_EQUAL( prvWaitersOnBit( 0 ) + prvWaitersOnBit( 1 ), uxWaitersUnblocked );
+    TEST_ASSERT_EQUAL( BIT_0 | ( 1 << 1 ) | eventUNBLOCKED_DUE_TO_BIT_SET, xWaiterUnblockedValue[ 0 ] );
+    TEST_ASSERT_EQUAL( 1 << 1, xEventGroupGetBits( xEventGroupHandle ) );
+}
+
+/*!
+ * @brief validate setting every bit in turn unblocks each of WAITER_COUNT tasks
+ *        exactly once and leaves no task blocked on the event group.
+ * @coverage xEventGroupSetBits
+ */
+void test_xEventGroupSetBits_ManyWaiters_EachBitInTurn_UnblocksAll( void )
+{
+    StaticEventGroup_t xCreatedEventGroup = { 0 };
+    UBaseType_t uxBit, uxUnblockedBefore;
+
+    /* Set-up */
+    prvCreateEventGroupWithWaiters( &xCreatedEventGroup, prvWaitForOneBit );
+
+    for( uxBit = 0; uxBit < EVENT_BIT_COUNT; uxBit++ )
+    {
+        uxUnblockedBefore = uxWaitersUnblocked;
+
+        /* API to Test */
+        ( void ) xEventGroupSetBits( xEventGroupHandle, ( EventBits_t ) 1 << uxBit );
+
+        /* Validate */
+        TEST_ASSERT_EQUAL( prvWaitersOnBit( uxBit ), uxWaitersUnblocked - uxUnblockedBefore );
+    }
+
+    TEST_ASSERT_EQUAL( WAITER_COUNT, uxWaitersUnblocked );
+    TEST_ASSERT_NULL( pxListTemp->xListEnd.pxNext );
+}
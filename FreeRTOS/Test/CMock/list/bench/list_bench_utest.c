@@ -0,0 +1,409 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file list_bench_utest.c
+ *
+ * List micro-benchmarks. Every test times one list operation against a list
+ * already holding each depth in uxListDepths, the depth being restored after
+ * each sample so every call sees the same list. These bound the time the
+ * kernel spends in vListInsert() with interrupts disabled, for example when a
+ * task is added to a delayed list. The per call percentiles are printed and
+ * written as JSON into BENCH_OUTPUT_DIR once the suite completes.
+ */
+
+/* clock_gettime( CLOCK_MONOTONIC_RAW ) is used where no cycle counter is read. */
+#ifndef _GNU_SOURCE
+    #define _GNU_SOURCE
+#endif
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+/* List includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "list.h"
+
+/* Test includes. */
+#include "unity.h"
+
+/* ===========================  LOCAL DEFINITIONS  ========================== */
+
+#ifndef BENCH_OUTPUT_DIR
+    #define BENCH_OUTPUT_DIR    "."
+#endif
+
+/* Number of timed calls per operation and list depth. */
+#define benchSAMPLES            ( 1000U )
+
+/* Distance between the values of consecutive items in the list, leaving room
+ * for the inserted item to land between any two of them. */
+#define benchVALUE_SPACING      ( 16U )
+
+#define benchNUM_DEPTHS         ( sizeof( uxListDepths ) / sizeof( uxListDepths[ 0 ] ) )
+#define benchMAX_LIST_DEPTH     ( 10000U )
+#define benchMAX_RESULTS        ( 4U * benchNUM_DEPTHS )
+
+/* Number of items in the list when a measurement starts. */
+static const UBaseType_t uxListDepths[] = { 10U, 100U, 1000U, 10000U };
+
+/* Timestamp source and the unit it counts in. */
+#if defined( __x86_64__ ) || defined( __i386__ )
+    #define benchTIME_UNIT    "cycles"
+#elif defined( __aarch64__ )
+    #define benchTIME_UNIT    "cntvct_ticks"
+#else
+    #define benchTIME_UNIT    "ns"
+#endif
+
+typedef struct BenchResult
+{
+    const char * pcApi;
+    UBaseType_t uxListItems;
+    uint64_t ullMin;
+    uint64_t ullP50;
+    uint64_t ullP90;
+    uint64_t ullP99;
+    uint64_t ullMax;
+    uint64_t ullMean;
+} BenchResult_t;
+
+/* ============================  LOCAL VARIABLES  =========================== */
+
+static List_t xList;
+static ListItem_t xListItems[ benchMAX_LIST_DEPTH ];
+static ListItem_t xInsertedItem;
+static uint64_t ullSamples[ benchSAMPLES ];
+static BenchResult_t xResults[ benchMAX_RESULTS ];
+static uint32_t ulNumResults = 0;
+static uint32_t ulRandomState = 1U;
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    ulRandomState = 1U;
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+    ulNumResults = 0;
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    char cPath[ 256 ];
+    FILE * pxFile;
+    uint32_t i;
+
+    if( ( mkdir( BENCH_OUTPUT_DIR, 0755 ) != 0 ) && ( errno != EEXIST ) )
+    {
+        printf( "Unable to create %s\n", BENCH_OUTPUT_DIR );
+        return numFailures + 1;
+    }
+
+    snprintf( cPath, sizeof( cPath ), "%s/list_bench.json", BENCH_OUTPUT_DIR );
+    pxFile = fopen( cPath, "w" );
+
+    if( pxFile == NULL )
+    {
+        printf( "Unable to open %s\n", cPath );
+        return numFailures + 1;
+    }
+
+    fprintf( pxFile, "{\n" );
+    fprintf( pxFile, "  \"unit\": \"%s\",\n", benchTIME_UNIT );
+    fprintf( pxFile, "  \"samples\": %u,\n", benchSAMPLES );
+    fprintf( pxFile, "  \"results\": [\n" );
+
+    for( i = 0; i < ulNumResults; i++ )
+    {
+        fprintf( pxFile,
+                 "    { \"api\": \"%s\", \"list_items\": %lu, \"min\": %llu, \"p50\": %llu, "
+                 "\"p90\": %llu, \"p99\": %llu, \"max\": %llu, \"mean\": %llu }%s\n",
+                 xResults[ i ].pcApi,
+                 ( unsigned long ) xResults[ i ].uxListItems,
+                 ( unsigned long long ) xResults[ i ].ullMin,
+                 ( unsigned long long ) xResults[ i ].ullP50,
+                 ( unsigned long long ) xResults[ i ].ullP90,
+                 ( unsigned long long ) xResults[ i ].ullP99,
+                 ( unsigned long long ) xResults[ i ].ullMax,
+                 ( unsigned long long ) xResults[ i ].ullMean,
+                 ( i + 1U < ulNumResults ) ? "," : "" );
+    }
+
+    fprintf( pxFile, "  ]\n}\n" );
+    fclose( pxFile );
+
+    printf( "Benchmark results written to %s\n", cPath );
+
+    return numFailures;
+}
+
+/* =============================  HELPER FUNCTIONS  ========================= */
+
+static inline uint64_t prvTimestamp( void )
+{
+    #if defined( __x86_64__ ) || defined( __i386__ )
+        return __builtin_ia32_rdtsc();
+    #elif defined( __aarch64__ )
+        uint64_t ullValue;
+
+        __asm volatile ( "isb\n mrs %0, cntvct_el0" : "=r" ( ullValue ) );
+        return ullValue;
+    #else
+        struct timespec xNow;
+
+        clock_gettime( CLOCK_MONOTONIC_RAW, &xNow );
+        return ( ( uint64_t ) xNow.tv_sec * 1000000000ULL ) + ( uint64_t ) xNow.tv_nsec;
+    #endif
+}
+
+/* Deterministic pseudo random sequence, so runs can be compared. */
+static uint32_t prvRandom( void )
+{
+    ulRandomState = ( ulRandomState * 1103515245U ) + 12345U;
+
+    return ulRandomState >> 8;
+}
+
+static int prvCompareSamples( const void * pvA,
+                              const void * pvB )
+{
+    uint64_t ullA = *( const uint64_t * ) pvA;
+    uint64_t ullB = *( const uint64_t * ) pvB;
+
+    return ( ullA > ullB ) - ( ullA < ullB );
+}
+
+/* Check xList holds uxListItems items in ascending value order. */
+static void prvValidateList( UBaseType_t uxListItems )
+{
+    const ListItem_t * pxItem;
+    const ListItem_t * pxListEnd = listGET_END_MARKER( &xList );
+    TickType_t xPreviousValue = 0;
+    UBaseType_t uxCount = 0;
+
+    for( pxItem = listGET_HEAD_ENTRY( &xList ); pxItem != pxListEnd; pxItem = listGET_NEXT( pxItem ) )
+    {
+        TEST_ASSERT_GREATER_OR_EQUAL( xPreviousValue, listGET_LIST_ITEM_VALUE( pxItem ) );
+        TEST_ASSERT_EQUAL_PTR( &xList, listLIST_ITEM_CONTAINER( pxItem ) );
+        xPreviousValue = listGET_LIST_ITEM_VALUE( pxItem );
+        uxCount++;
+    }
+
+    TEST_ASSERT_EQUAL( uxListItems, uxCount );
+    TEST_ASSERT_EQUAL( uxListItems, listCURRENT_LIST_LENGTH( &xList ) );
+}
+
+/* Reduce ullSamples to percentiles and record them for the JSON report. */
+static void prvRecordResult( const char * pcApi,
+                             UBaseType_t uxListItems )
+{
+    BenchResult_t * pxResult;
+    uint64_t ullSum = 0;
+    uint32_t i;
+
+    TEST_ASSERT_LESS_THAN_UINT32( benchMAX_RESULTS, ulNumResults );
+
+    qsort( ullSamples, benchSAMPLES, sizeof( ullSamples[ 0 ] ), prvCompareSamples );
+
+    for( i = 0; i < benchSAMPLES; i++ )
+    {
+        ullSum += ullSamples[ i ];
+    }
+
+    pxResult = &xResults[ ulNumResults++ ];
+    pxResult->pcApi = pcApi;
+    pxResult->uxListItems = uxListItems;
+    pxResult->ullMin = ullSamples[ 0 ];
+    pxResult->ullP50 = ullSamples[ ( benchSAMPLES * 50U ) / 100U ];
+    pxResult->ullP90 = ullSamples[ ( benchSAMPLES * 90U ) / 100U ];
+    pxResult->ullP99 = ullSamples[ ( benchSAMPLES * 99U ) / 100U ];
+    pxResult->ullMax = ullSamples[ benchSAMPLES - 1U ];
+    pxResult->ullMean = ullSum / benchSAMPLES;
+
+    printf( "%-22s items=%-5lu p50=%-8llu p90=%-8llu p99=%-8llu max=%llu %s\n",
+            pcApi, ( unsigned long ) uxListItems,
+            ( unsigned long long ) pxResult->ullP50,
+            ( unsigned long long ) pxResult->ullP90,
+            ( unsigned long long ) pxResult->ullP99,
+            ( unsigned long long ) pxResult->ullMax,
+            benchTIME_UNIT );
+
+    /* Every measurement must leave the list sorted and at its starting depth. */
+    prvValidateList( uxListItems );
+}
+
+/* Reset xList to hold uxListItems items, item i having the value
+ * i * benchVALUE_SPACING.  The values are ascending, so appending each item
+ * builds the list in linear time without going through vListInsert(). */
+static void prvFillList( UBaseType_t uxListItems )
+{
+    UBaseType_t i;
+
+    vListInitialise( &xList );
+    vListInitialiseItem( &xInsertedItem );
+
+    for( i = 0; i < uxListItems; i++ )
+    {
+        vListInitialiseItem( &xListItems[ i ] );
+        listSET_LIST_ITEM_VALUE( &xListItems[ i ], ( TickType_t ) ( i * benchVALUE_SPACING ) );
+        vListInsertEnd( &xList, &xListItems[ i ] );
+    }
+}
+
+/* ==============================  Test Cases  ============================== */
+
+/**
+ * @brief Time vListInsert() of an item whose value lands at a random position
+ * in the list, as when a task delays for a varying time.
+ */
+void test_bench_vListInsert_random( void )
+{
+    uint64_t ullStart;
+    uint32_t i, ulDepth;
+    UBaseType_t uxListItems;
+
+    for( ulDepth = 0; ulDepth < benchNUM_DEPTHS; ulDepth++ )
+    {
+        uxListItems = uxListDepths[ ulDepth ];
+        prvFillList( uxListItems );
+
+        for( i = 0; i < benchSAMPLES; i++ )
+        {
+            listSET_LIST_ITEM_VALUE( &xInsertedItem, ( TickType_t ) ( prvRandom() % ( uxListItems * benchVALUE_SPACING ) ) );
+
+            ullStart = prvTimestamp();
+            vListInsert( &xList, &xInsertedItem );
+            ullSamples[ i ] = prvTimestamp() - ullStart;
+
+            ( void ) uxListRemove( &xInsertedItem );
+        }
+
+        prvRecordResult( "vListInsert_random", uxListItems );
+    }
+}
+
+/**
+ * @brief Time vListInsert() of an item that sorts after every item in the
+ * list, the longest walk the list can take.
+ */
+void test_bench_vListInsert_tail( void )
+{
+    uint64_t ullStart;
+    uint32_t i, ulDepth;
+    UBaseType_t uxListItems;
+
+    for( ulDepth = 0; ulDepth < benchNUM_DEPTHS; ulDepth++ )
+    {
+        uxListItems = uxListDepths[ ulDepth ];
+        prvFillList( uxListItems );
+        listSET_LIST_ITEM_VALUE( &xInsertedItem, ( TickType_t ) ( uxListItems * benchVALUE_SPACING ) );
+
+        for( i = 0; i < benchSAMPLES; i++ )
+        {
+            ullStart = prvTimestamp();
+            vListInsert( &xList, &xInsertedItem );
+            ullSamples[ i ] = prvTimestamp() - ullStart;
+
+            ( void ) uxListRemove( &xInsertedItem );
+        }
+
+        prvRecordResult( "vListInsert_tail", uxListItems );
+    }
+}
+
+/**
+ * @brief Time vListInsert() of an item with the value portMAX_DELAY, which
+ * the list places at the end without walking it.
+ */
+void test_bench_vListInsert_max_delay( void )
+{
+    uint64_t ullStart;
+    uint32_t i, ulDepth;
+    UBaseType_t uxListItems;
+
+    for( ulDepth = 0; ulDepth < benchNUM_DEPTHS; ulDepth++ )
+    {
+        uxListItems = uxListDepths[ ulDepth ];
+        prvFillList( uxListItems );
+        listSET_LIST_ITEM_VALUE( &xInsertedItem, portMAX_DELAY );
+
+        for( i = 0; i < benchSAMPLES; i++ )
+        {
+            ullStart = prvTimestamp();
+            vListInsert( &xList, &xInsertedItem );
+            ullSamples[ i ] = prvTimestamp() - ullStart;
+
+            ( void ) uxListRemove( &xInsertedItem );
+        }
+
+        prvRecordResult( "vListInsert_max_delay", uxListItems );
+    }
+}
+
+/**
+ * @brief Time uxListRemove() of an item at a random position in the list.
+ */
+void test_bench_uxListRemove_random( void )
+{
+    ListItem_t * pxItem;
+    uint64_t ullStart;
+    uint32_t i, ulDepth;
+    UBaseType_t uxListItems;
+
+    for( ulDepth = 0; ulDepth < benchNUM_DEPTHS; ulDepth++ )
+    {
+        uxListItems = uxListDepths[ ulDepth ];
+        prvFillList( uxListItems );
+
+        for( i = 0; i < benchSAMPLES; i++ )
+        {
+            pxItem = &xListItems[ prvRandom() % uxListItems ];
+
+            ullStart = prvTimestamp();
+            ( void ) uxListRemove( pxItem );
+            ullSamples[ i ] = prvTimestamp() - ullStart;
+
+            vListInsert( &xList, pxItem );
+        }
+
+        prvRecordResult( "uxListRemove_random", uxListItems );
+    }
+}
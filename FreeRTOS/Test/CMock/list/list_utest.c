@@ -476,6 +476,86 @@ void test_vListInsert_success_vportMAXDELAY( void )
     TEST_ASSERT_EQUAL_PTR( miniListEnd->xItemValue, portMAX_DELAY );
 }
 
+/*!
+ * @brief test vListInsert successful case with multiple items (5000) inserted
+ *        in an order unrelated to their values
+ * @details This test ensures every insert walks to the right position, whatever
+ *          the depth of the list
+ * @coverage vListInsert
+ */
+void test_vListInsert_success_multiple_items_unordered( void )
+{
+    List_t pxList;
+    ListItem_t pxNewListItem[ MAX_ITEMS ];
+    ListItem_t * pxItem;
+    int i;
+
+    vListInitialise( &pxList );
+    initialise_list_items( pxNewListItem, MAX_ITEMS );
+
+    /* 7919 is prime, so i * 7919 % MAX_ITEMS visits every value once. */
+    for( i = 0; i < MAX_ITEMS; i++ )
+    {
+        listSET_LIST_ITEM_VALUE( &pxNewListItem[ i ], ( i * 7919 ) % MAX_ITEMS );
+        vListInsert( &pxList, &pxNewListItem[ i ] );
+    }
+
+    TEST_ASSERT_EQUAL( MAX_ITEMS, listCURRENT_LIST_LENGTH( &pxList ) );
+
+    /* Walking from the end marker visits the values in ascending order. */
+    pxItem = listGET_HEAD_ENTRY( &pxList );
+
+    for( i = 0; i < MAX_ITEMS; i++ )
+    {
+        TEST_ASSERT_EQUAL( i, listGET_LIST_ITEM_VALUE( pxItem ) );
+        TEST_ASSERT_EQUAL_PTR( &pxList, pxItem->pxContainer );
+        TEST_ASSERT_EQUAL_PTR( pxItem, pxItem->pxNext->pxPrevious );
+        pxItem = listGET_NEXT( pxItem );
+    }
+
+    TEST_ASSERT_EQUAL_PTR( listGET_END_MARKER( &pxList ), pxItem );
+}
+
+/*!
+ * @brief test vListInsert places an item after every item with the same value
+ * @details Tasks in a ready list all have the same value, and rely on this to
+ *          share the processor in turn
+ * @coverage vListInsert
+ */
+void test_vListInsert_success_equal_values_keep_insertion_order( void )
+{
+    List_t pxList;
+    ListItem_t pxNewListItem[ MAX_ITEMS ];
+    ListItem_t * pxItem;
+    int i, value;
+
+    vListInitialise( &pxList );
+    initialise_list_items( pxNewListItem, MAX_ITEMS );
+
+    /* Ten values, each shared by MAX_ITEMS / 10 items, interleaved. */
+    for( i = 0; i < MAX_ITEMS; i++ )
+    {
+        listSET_LIST_ITEM_VALUE( &pxNewListItem[ i ], 9 - ( i % 10 ) );
+        vListInsert( &pxList, &pxNewListItem[ i ] );
+    }
+
+    TEST_ASSERT_EQUAL( MAX_ITEMS, listCURRENT_LIST_LENGTH( &pxList ) );
+
+    /* Items sharing a value follow each other in the order they were inserted. */
+    pxItem = listGET_HEAD_ENTRY( &pxList );
+
+    for( value = 0; value < 10; value++ )
+    {
+        for( i = 9 - value; i < MAX_ITEMS; i += 10 )
+        {
+            TEST_ASSERT_EQUAL_PTR( &pxNewListItem[ i ], pxItem );
+            pxItem = listGET_NEXT( pxItem );
+        }
+    }
+
+    TEST_ASSERT_EQUAL_PTR( listGET_END_MARKER( &pxList ), pxItem );
+}
+
 /*!
  * @brief test uxListRemove successful case with 1 item
  * @details This test ensures the list is sane when 1 item is removed
@@ -0,0 +1,673 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file scheduler_bench_utest.c
+ *
+ * Scheduler micro-benchmarks. Every test times one kernel API for each ready
+ * list depth in uxReadyDepths, the whole suite being built once per core count
+ * listed in smp/bench/Makefile. Each sample is a single call, taken from a
+ * settled scheduler state: yields requested by the measured call are serviced
+ * after the timestamp is taken. The per call percentiles are printed and
+ * written as JSON into BENCH_OUTPUT_DIR once the suite completes.
+ *
+ * The false sharing tests run every core on its own host thread and report the
+ * wall time and, on Linux, the cache misses counted by perf per operation. They
+ * are meant to be compared between builds with and without per-core padding,
+ * see BENCH_CACHE_LINE_SIZE in smp/bench/Makefile.
+ */
+
+/* clock_gettime( CLOCK_MONOTONIC_RAW ) is used where no cycle counter is read. */
+#ifndef _GNU_SOURCE
+    #define _GNU_SOURCE
+#endif
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+    #include <unistd.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <linux/perf_event.h>
+#endif
+
+/* Task includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "event_groups.h"
+#include "queue.h"
+
+/* Test includes. */
+#include "unity.h"
+#include "unity_memory.h"
+#include "../global_vars.h"
+#include "../smp_utest_mt_common.h"
+
+/* Mock includes. */
+#include "mock_timers.h"
+#include "mock_fake_assert.h"
+#include "mock_fake_port.h"
+
+/* ===========================  LOCAL DEFINITIONS  ========================== */
+
+#ifndef BENCH_OUTPUT_DIR
+    #define BENCH_OUTPUT_DIR    "."
+#endif
+
+/* Number of timed calls per API and ready list depth. */
+#define benchSAMPLES            ( 1000U )
+
+/* Priority of the tasks populating the ready list. */
+#define benchTASK_PRIORITY      ( 1U )
+
+#define benchNUM_DEPTHS         ( sizeof( uxReadyDepths ) / sizeof( uxReadyDepths[ 0 ] ) )
+#define benchMAX_READY_TASKS    ( 1000U )
+#define benchMAX_RESULTS        ( 8U * benchNUM_DEPTHS )
+
+/* Iterations run by each core in the false sharing tests. */
+#define benchCACHE_ITERATIONS        ( 20000U )
+#define benchMAX_CACHE_RESULTS       ( 4U )
+
+/* Cache counters sampled around the false sharing tests. */
+#define benchCOUNTER_L1D_MISSES      ( 0 )
+#define benchCOUNTER_CACHE_MISSES    ( 1 )
+#define benchNUM_COUNTERS            ( 2 )
+
+/* Number of application tasks in the ready list when a measurement starts. */
+static const UBaseType_t uxReadyDepths[] = { 1U, 10U, 100U, 1000U };
+
+/* Timestamp source and the unit it counts in. */
+#if defined( __x86_64__ ) || defined( __i386__ )
+    #define benchTIME_UNIT    "cycles"
+#elif defined( __aarch64__ )
+    #define benchTIME_UNIT    "cntvct_ticks"
+#else
+    #define benchTIME_UNIT    "ns"
+#endif
+
+typedef struct BenchResult
+{
+    const char * pcApi;
+    UBaseType_t uxReadyTasks;
+    uint64_t ullMin;
+    uint64_t ullP50;
+    uint64_t ullP90;
+    uint64_t ullP99;
+    uint64_t ullMax;
+    uint64_t ullMean;
+} BenchResult_t;
+
+typedef struct BenchCacheResult
+{
+    const char * pcWorkload;
+    uint64_t ullNsPerOp;
+    BaseType_t xCountersValid;
+    /* Misses per thousand operations, indexed by benchCOUNTER_*. */
+    uint64_t ullMissesPerKOp[ benchNUM_COUNTERS ];
+} BenchCacheResult_t;
+
+/* ===========================  EXTERN VARIABLES  =========================== */
+
+extern volatile TCB_t *  pxCurrentTCBs[ configNUMBER_OF_CORES ];
+
+/* ============================  LOCAL VARIABLES  =========================== */
+
+static TaskHandle_t xReadyTasks[ benchMAX_READY_TASKS ] = { NULL };
+static uint64_t ullSamples[ benchSAMPLES ];
+static BenchResult_t xResults[ benchMAX_RESULTS ];
+static uint32_t ulNumResults = 0;
+static BenchCacheResult_t xCacheResults[ benchMAX_CACHE_RESULTS ];
+static uint32_t ulNumCacheResults = 0;
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    commonSetUp();
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+    commonTearDown();
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+    ulNumResults = 0;
+    ulNumCacheResults = 0;
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    char cPath[ 256 ];
+    FILE * pxFile;
+    uint32_t i;
+
+    if( ( mkdir( BENCH_OUTPUT_DIR, 0755 ) != 0 ) && ( errno != EEXIST ) )
+    {
+        printf( "Unable to create %s\n", BENCH_OUTPUT_DIR );
+        return numFailures + 1;
+    }
+
+    snprintf( cPath, sizeof( cPath ), "%s/smp_bench_cores_%d.json", BENCH_OUTPUT_DIR, configNUMBER_OF_CORES );
+    pxFile = fopen( cPath, "w" );
+
+    if( pxFile == NULL )
+    {
+        printf( "Unable to open %s\n", cPath );
+        return numFailures + 1;
+    }
+
+    fprintf( pxFile, "{\n" );
+    fprintf( pxFile, "  \"cores\": %d,\n", configNUMBER_OF_CORES );
+    fprintf( pxFile, "  \"unit\": \"%s\",\n", benchTIME_UNIT );
+    fprintf( pxFile, "  \"samples\": %u,\n", benchSAMPLES );
+    fprintf( pxFile, "  \"cache_line_size\": %d,\n", configCACHE_LINE_SIZE );
+    fprintf( pxFile, "  \"results\": [\n" );
+
+    for( i = 0; i < ulNumResults; i++ )
+    {
+        fprintf( pxFile,
+                 "    { \"api\": \"%s\", \"ready_tasks\": %lu, \"min\": %llu, \"p50\": %llu, "
+                 "\"p90\": %llu, \"p99\": %llu, \"max\": %llu, \"mean\": %llu }%s\n",
+                 xResults[ i ].pcApi,
+                 ( unsigned long ) xResults[ i ].uxReadyTasks,
+                 ( unsigned long long ) xResults[ i ].ullMin,
+                 ( unsigned long long ) xResults[ i ].ullP50,
+                 ( unsigned long long ) xResults[ i ].ullP90,
+                 ( unsigned long long ) xResults[ i ].ullP99,
+                 ( unsigned long long ) xResults[ i ].ullMax,
+                 ( unsigned long long ) xResults[ i ].ullMean,
+                 ( i + 1U < ulNumResults ) ? "," : "" );
+    }
+
+    fprintf( pxFile, "  ],\n" );
+    fprintf( pxFile, "  \"cache_traffic\": [\n" );
+
+    for( i = 0; i < ulNumCacheResults; i++ )
+    {
+        fprintf( pxFile, "    { \"workload\": \"%s\", \"ns_per_op\": %llu, ",
+                 xCacheResults[ i ].pcWorkload,
+                 ( unsigned long long ) xCacheResults[ i ].ullNsPerOp );
+
+        if( xCacheResults[ i ].xCountersValid == pdTRUE )
+        {
+            fprintf( pxFile, "\"l1d_read_misses_per_kop\": %llu, \"cache_misses_per_kop\": %llu }",
+                     ( unsigned long long ) xCacheResults[ i ].ullMissesPerKOp[ benchCOUNTER_L1D_MISSES ],
+                     ( unsigned long long ) xCacheResults[ i ].ullMissesPerKOp[ benchCOUNTER_CACHE_MISSES ] );
+        }
+        else
+        {
+            fprintf( pxFile, "\"l1d_read_misses_per_kop\": null, \"cache_misses_per_kop\": null }" );
+        }
+
+        fprintf( pxFile, "%s\n", ( i + 1U < ulNumCacheResults ) ? "," : "" );
+    }
+
+    fprintf( pxFile, "  ]\n}\n" );
+    fclose( pxFile );
+
+    printf( "Benchmark results written to %s\n", cPath );
+
+    return numFailures;
+}
+
+/* =============================  HELPER FUNCTIONS  ========================= */
+
+static inline uint64_t prvTimestamp( void )
+{
+    #if defined( __x86_64__ ) || defined( __i386__ )
+        return __builtin_ia32_rdtsc();
+    #elif defined( __aarch64__ )
+        uint64_t ullValue;
+
+        __asm volatile ( "isb\n mrs %0, cntvct_el0" : "=r" ( ullValue ) );
+        return ullValue;
+    #else
+        struct timespec xNow;
+
+        clock_gettime( CLOCK_MONOTONIC_RAW, &xNow );
+        return ( ( uint64_t ) xNow.tv_sec * 1000000000ULL ) + ( uint64_t ) xNow.tv_nsec;
+    #endif
+}
+
+static int prvCompareSamples( const void * pvA,
+                              const void * pvB )
+{
+    uint64_t ullA = *( const uint64_t * ) pvA;
+    uint64_t ullB = *( const uint64_t * ) pvB;
+
+    return ( ullA > ullB ) - ( ullA < ullB );
+}
+
+/* Reduce ullSamples to percentiles and record them for the JSON report. */
+static void prvRecordResult( const char * pcApi,
+                             UBaseType_t uxReadyTasks )
+{
+    BenchResult_t * pxResult;
+    uint64_t ullSum = 0;
+    uint32_t i;
+
+    TEST_ASSERT_LESS_THAN_UINT32( benchMAX_RESULTS, ulNumResults );
+
+    qsort( ullSamples, benchSAMPLES, sizeof( ullSamples[ 0 ] ), prvCompareSamples );
+
+    for( i = 0; i < benchSAMPLES; i++ )
+    {
+        ullSum += ullSamples[ i ];
+    }
+
+    pxResult = &xResults[ ulNumResults++ ];
+    pxResult->pcApi = pcApi;
+    pxResult->uxReadyTasks = uxReadyTasks;
+    pxResult->ullMin = ullSamples[ 0 ];
+    pxResult->ullP50 = ullSamples[ ( benchSAMPLES * 50U ) / 100U ];
+    pxResult->ullP90 = ullSamples[ ( benchSAMPLES * 90U ) / 100U ];
+    pxResult->ullP99 = ullSamples[ ( benchSAMPLES * 99U ) / 100U ];
+    pxResult->ullMax = ullSamples[ benchSAMPLES - 1U ];
+    pxResult->ullMean = ullSum / benchSAMPLES;
+
+    printf( "%-22s cores=%-2d ready=%-4lu p50=%-8llu p90=%-8llu p99=%-8llu max=%llu %s\n",
+            pcApi, configNUMBER_OF_CORES, ( unsigned long ) uxReadyTasks,
+            ( unsigned long long ) pxResult->ullP50,
+            ( unsigned long long ) pxResult->ullP90,
+            ( unsigned long long ) pxResult->ullP99,
+            ( unsigned long long ) pxResult->ullMax,
+            benchTIME_UNIT );
+
+    /* Every measurement must leave the scheduler in a consistent state. */
+    verifySmpMtRunningTasks();
+}
+
+static uint64_t prvWallClockNs( void )
+{
+    struct timespec xNow;
+
+    clock_gettime( CLOCK_MONOTONIC_RAW, &xNow );
+    return ( ( uint64_t ) xNow.tv_sec * 1000000000ULL ) + ( uint64_t ) xNow.tv_nsec;
+}
+
+/* Open a user space counter for this thread and the core threads it creates
+ * afterwards. Returns -1 when perf is unavailable, e.g. because of
+ * perf_event_paranoid or on a virtual machine without a PMU. */
+static int prvOpenCacheCounter( int xCounter )
+{
+    #ifdef __linux__
+        struct perf_event_attr xAttr;
+
+        memset( &xAttr, 0x00, sizeof( xAttr ) );
+        xAttr.size = sizeof( xAttr );
+        xAttr.disabled = 1;
+        xAttr.inherit = 1;
+        xAttr.exclude_kernel = 1;
+        xAttr.exclude_hv = 1;
+
+        if( xCounter == benchCOUNTER_L1D_MISSES )
+        {
+            xAttr.type = PERF_TYPE_HW_CACHE;
+            xAttr.config = PERF_COUNT_HW_CACHE_L1D |
+                           ( PERF_COUNT_HW_CACHE_OP_READ << 8 ) |
+                           ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 );
+        }
+        else
+        {
+            xAttr.type = PERF_TYPE_HARDWARE;
+            xAttr.config = PERF_COUNT_HW_CACHE_MISSES;
+        }
+
+        return ( int ) syscall( __NR_perf_event_open, &xAttr, 0, -1, -1, 0 );
+    #else
+        ( void ) xCounter;
+        return -1;
+    #endif
+}
+
+/* Run pxCoreFunction on every core and record the wall time and the cache
+ * misses per operation. Counts of inherited counters are folded into the
+ * parent once the core threads exit, which vSmpMtRunCores() waits for. */
+static void prvMeasureCacheTraffic( const char * pcWorkload,
+                                    SmpMtCoreFunction_t pxCoreFunction )
+{
+    BenchCacheResult_t * pxResult;
+    int xCounters[ benchNUM_COUNTERS ];
+    uint64_t ullCount;
+    uint64_t ullOps = ( uint64_t ) configNUMBER_OF_CORES * benchCACHE_ITERATIONS;
+    uint64_t ullStart;
+    int i;
+
+    TEST_ASSERT_LESS_THAN_UINT32( benchMAX_CACHE_RESULTS, ulNumCacheResults );
+
+    pxResult = &xCacheResults[ ulNumCacheResults++ ];
+    pxResult->pcWorkload = pcWorkload;
+    pxResult->xCountersValid = pdTRUE;
+
+    for( i = 0; i < benchNUM_COUNTERS; i++ )
+    {
+        xCounters[ i ] = prvOpenCacheCounter( i );
+
+        if( xCounters[ i ] < 0 )
+        {
+            pxResult->xCountersValid = pdFALSE;
+        }
+    }
+
+    #ifdef __linux__
+        for( i = 0; i < benchNUM_COUNTERS; i++ )
+        {
+            if( xCounters[ i ] >= 0 )
+            {
+                ioctl( xCounters[ i ], PERF_EVENT_IOC_RESET, 0 );
+                ioctl( xCounters[ i ], PERF_EVENT_IOC_ENABLE, 0 );
+            }
+        }
+    #endif
+
+    ullStart = prvWallClockNs();
+    vSmpMtRunCores( pxCoreFunction, benchCACHE_ITERATIONS );
+    pxResult->ullNsPerOp = ( prvWallClockNs() - ullStart ) / ullOps;
+
+    for( i = 0; i < benchNUM_COUNTERS; i++ )
+    {
+        pxResult->ullMissesPerKOp[ i ] = 0;
+
+        #ifdef __linux__
+            if( xCounters[ i ] >= 0 )
+            {
+                ioctl( xCounters[ i ], PERF_EVENT_IOC_DISABLE, 0 );
+
+                if( read( xCounters[ i ], &ullCount, sizeof( ullCount ) ) == ( ssize_t ) sizeof( ullCount ) )
+                {
+                    pxResult->ullMissesPerKOp[ i ] = ( ullCount * 1000U ) / ullOps;
+                }
+                else
+                {
+                    pxResult->xCountersValid = pdFALSE;
+                }
+
+                close( xCounters[ i ] );
+            }
+        #else
+            ( void ) ullCount;
+        #endif
+    }
+
+    if( pxResult->xCountersValid == pdTRUE )
+    {
+        printf( "%-22s cores=%-2d line=%-3d %llu ns/op, l1d read misses=%llu/kop, cache misses=%llu/kop\n",
+                pcWorkload, configNUMBER_OF_CORES, configCACHE_LINE_SIZE,
+                ( unsigned long long ) pxResult->ullNsPerOp,
+                ( unsigned long long ) pxResult->ullMissesPerKOp[ benchCOUNTER_L1D_MISSES ],
+                ( unsigned long long ) pxResult->ullMissesPerKOp[ benchCOUNTER_CACHE_MISSES ] );
+    }
+    else
+    {
+        printf( "%-22s cores=%-2d line=%-3d %llu ns/op, cache counters unavailable\n",
+                pcWorkload, configNUMBER_OF_CORES, configCACHE_LINE_SIZE,
+                ( unsigned long long ) pxResult->ullNsPerOp );
+    }
+
+    verifySmpMtRunningTasks();
+}
+
+static void prvInterruptMaskCoreFunction( BaseType_t xCoreID,
+                                          uint32_t ulIteration )
+{
+    /* Only writes the port state of this core. */
+    portDISABLE_INTERRUPTS();
+    portENABLE_INTERRUPTS();
+}
+
+static void prvYieldCoreFunction( BaseType_t xCoreID,
+                                  uint32_t ulIteration )
+{
+    taskYIELD();
+}
+
+/* Reset the kernel and start the scheduler with uxReadyTasks application tasks
+ * in the ready list. */
+static void prvStartScheduler( UBaseType_t uxReadyTasks )
+{
+    UBaseType_t i;
+
+    commonSetUp();
+
+    for( i = 0; i < uxReadyTasks; i++ )
+    {
+        xTaskCreate( vSmpTestTask, "Bench", configMINIMAL_STACK_SIZE, NULL, benchTASK_PRIORITY, &xReadyTasks[ i ] );
+    }
+
+    vTaskStartScheduler();
+    vSetCurrentCore( 0 );
+}
+
+/* ==============================  Test Cases  ============================== */
+
+/**
+ * @brief Time vTaskSwitchContext(), issued on each core in turn.
+ */
+void test_bench_vTaskSwitchContext( void )
+{
+    uint64_t ullStart;
+    uint32_t i, ulDepth;
+    BaseType_t xCoreID;
+
+    for( ulDepth = 0; ulDepth < benchNUM_DEPTHS; ulDepth++ )
+    {
+        prvStartScheduler( uxReadyDepths[ ulDepth ] );
+
+        for( i = 0; i < benchSAMPLES; i++ )
+        {
+            xCoreID = ( BaseType_t ) ( i % configNUMBER_OF_CORES );
+            vSetCurrentCore( xCoreID );
+
+            ullStart = prvTimestamp();
+            vTaskSwitchContext( xCoreID );
+            ullSamples[ i ] = prvTimestamp() - ullStart;
+        }
+
+        vSetCurrentCore( 0 );
+        prvRecordResult( "vTaskSwitchContext", uxReadyDepths[ ulDepth ] );
+    }
+}
+
+/**
+ * @brief Time a tick interrupt on the tick core, including the critical section
+ * and the resulting yield.
+ */
+void test_bench_xTaskIncrementTick( void )
+{
+    uint64_t ullStart;
+    uint32_t i, ulDepth;
+
+    for( ulDepth = 0; ulDepth < benchNUM_DEPTHS; ulDepth++ )
+    {
+        prvStartScheduler( uxReadyDepths[ ulDepth ] );
+        vSetCurrentCore( configTICK_CORE );
+
+        for( i = 0; i < benchSAMPLES; i++ )
+        {
+            ullStart = prvTimestamp();
+            xTaskIncrementTick_helper();
+            ullSamples[ i ] = prvTimestamp() - ullStart;
+
+            vSmpMtDrainPendingYields();
+        }
+
+        vSetCurrentCore( 0 );
+        prvRecordResult( "xTaskIncrementTick", uxReadyDepths[ ulDepth ] );
+    }
+}
+
+/**
+ * @brief Time xTaskCreate() of a task at the priority of the ready tasks.
+ */
+void test_bench_xTaskCreate( void )
+{
+    TaskHandle_t xTaskHandle;
+    uint64_t ullStart;
+    uint32_t i, ulDepth;
+
+    for( ulDepth = 0; ulDepth < benchNUM_DEPTHS; ulDepth++ )
+    {
+        prvStartScheduler( uxReadyDepths[ ulDepth ] );
+
+        for( i = 0; i < benchSAMPLES; i++ )
+        {
+            ullStart = prvTimestamp();
+            xTaskCreate( vSmpTestTask, "Bench", configMINIMAL_STACK_SIZE, NULL, benchTASK_PRIORITY, &xTaskHandle );
+            ullSamples[ i ] = prvTimestamp() - ullStart;
+
+            vSmpMtDrainPendingYields();
+            vTaskDelete( xTaskHandle );
+            vSmpMtDrainPendingYields();
+        }
+
+        prvRecordResult( "xTaskCreate", uxReadyDepths[ ulDepth ] );
+    }
+}
+
+/**
+ * @brief Time vTaskDelete() of a task at the priority of the ready tasks.
+ */
+void test_bench_vTaskDelete( void )
+{
+    TaskHandle_t xTaskHandle;
+    uint64_t ullStart;
+    uint32_t i, ulDepth;
+
+    for( ulDepth = 0; ulDepth < benchNUM_DEPTHS; ulDepth++ )
+    {
+        prvStartScheduler( uxReadyDepths[ ulDepth ] );
+
+        for( i = 0; i < benchSAMPLES; i++ )
+        {
+            xTaskCreate( vSmpTestTask, "Bench", configMINIMAL_STACK_SIZE, NULL, benchTASK_PRIORITY, &xTaskHandle );
+            vSmpMtDrainPendingYields();
+
+            ullStart = prvTimestamp();
+            vTaskDelete( xTaskHandle );
+            ullSamples[ i ] = prvTimestamp() - ullStart;
+
+            vSmpMtDrainPendingYields();
+        }
+
+        prvRecordResult( "vTaskDelete", uxReadyDepths[ ulDepth ] );
+    }
+}
+
+/**
+ * @brief Time vTaskPrioritySet() raising a ready task above the others and
+ * lowering it back on alternate samples.
+ */
+void test_bench_vTaskPrioritySet( void )
+{
+    uint64_t ullStart;
+    uint32_t i, ulDepth;
+
+    for( ulDepth = 0; ulDepth < benchNUM_DEPTHS; ulDepth++ )
+    {
+        prvStartScheduler( uxReadyDepths[ ulDepth ] );
+
+        for( i = 0; i < benchSAMPLES; i++ )
+        {
+            ullStart = prvTimestamp();
+            vTaskPrioritySet( xReadyTasks[ 0 ], benchTASK_PRIORITY + ( ( i + 1U ) & 1U ) );
+            ullSamples[ i ] = prvTimestamp() - ullStart;
+
+            vSmpMtDrainPendingYields();
+        }
+
+        prvRecordResult( "vTaskPrioritySet", uxReadyDepths[ ulDepth ] );
+    }
+}
+
+/**
+ * @brief Time vTaskCoreAffinitySet() pinning a ready task to one core and
+ * releasing it on alternate samples.
+ */
+void test_bench_vTaskCoreAffinitySet( void )
+{
+    UBaseType_t uxCoreAffinityMask;
+    uint64_t ullStart;
+    uint32_t i, ulDepth;
+
+    for( ulDepth = 0; ulDepth < benchNUM_DEPTHS; ulDepth++ )
+    {
+        prvStartScheduler( uxReadyDepths[ ulDepth ] );
+
+        for( i = 0; i < benchSAMPLES; i++ )
+        {
+            if( ( i & 1U ) == 0U )
+            {
+                uxCoreAffinityMask = ( UBaseType_t ) 1U << ( ( i / 2U ) % configNUMBER_OF_CORES );
+            }
+            else
+            {
+                uxCoreAffinityMask = tskNO_AFFINITY;
+            }
+
+            ullStart = prvTimestamp();
+            vTaskCoreAffinitySet( xReadyTasks[ uxReadyDepths[ ulDepth ] - 1U ], uxCoreAffinityMask );
+            ullSamples[ i ] = prvTimestamp() - ullStart;
+
+            vSmpMtDrainPendingYields();
+        }
+
+        prvRecordResult( "vTaskCoreAffinitySet", uxReadyDepths[ ulDepth ] );
+    }
+}
+
+/**
+ * @brief Every core masks and unmasks its own interrupts. No state is shared
+ * between the cores, so any cache traffic comes from per-core state sharing a
+ * cache line.
+ */
+void test_bench_false_sharing_interrupt_mask( void )
+{
+    prvStartScheduler( configNUMBER_OF_CORES );
+
+    prvMeasureCacheTraffic( "interrupt_mask", prvInterruptMaskCoreFunction );
+}
+
+/**
+ * @brief Every core yields, taking the task lock and updating its entry in
+ * pxCurrentTCBs.
+ */
+void test_bench_false_sharing_yield( void )
+{
+    prvStartScheduler( configNUMBER_OF_CORES );
+
+    prvMeasureCacheTraffic( "yield", prvYieldCoreFunction );
+}
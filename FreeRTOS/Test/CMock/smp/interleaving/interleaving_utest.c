@@ -0,0 +1,365 @@
+/*
+ * FreeRTOS V202012.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file interleaving_utest.c */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Task includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "event_groups.h"
+#include "queue.h"
+
+/* Test includes. */
+#include "unity.h"
+#include "unity_memory.h"
+#include "../global_vars.h"
+#include "../smp_utest_common.h"
+
+/* Mock includes. */
+#include "mock_timers.h"
+#include "mock_fake_assert.h"
+#include "mock_fake_port.h"
+
+/* ===========================  EXTERN VARIABLES  =========================== */
+
+extern volatile TCB_t *  pxCurrentTCBs[ configNUMBER_OF_CORES ];
+
+/* ===========================  DEFINES CONSTANTS  ========================== */
+
+/* Number of runs of each scenario under the random and round-robin policies. */
+#define INTERLEAVING_RANDOM_RUNS        ( 10000 )
+
+/* Upper bound on the runs of an exhaustive exploration. */
+#define INTERLEAVING_EXHAUSTIVE_RUNS    ( 100000 )
+
+/* Number of choices an exhaustive exploration enumerates. */
+#define INTERLEAVING_EXHAUSTIVE_DEPTH   ( 8 )
+
+/* Tasks of a scenario: one per core plus as many waiting for a core. */
+#define INTERLEAVING_NUM_TASKS          ( configNUMBER_OF_CORES * 2 )
+
+/* ===========================  STATIC VARIABLES  =========================== */
+
+/* uxTCBNumber of the task running on each core at the end of the last run. */
+static UBaseType_t uxCoreTaskNumbers[ configNUMBER_OF_CORES ];
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    commonSetUp();
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+    commonTearDown();
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+
+/* ===========================  Helper functions  =========================== */
+
+/**
+ * @brief Verify the state every schedule must reach once the pending yields
+ * have been serviced:
+ *  - each core runs a distinct task, whose xTaskRunState names that core.
+ *  - no task waits for a core while a core runs a lower priority task.
+ * Records the task running on each core in uxCoreTaskNumbers.
+ */
+static void verifyCoreAssignment( TaskHandle_t * pxTaskHandles,
+                                  uint32_t ulNumTasks )
+{
+    TaskStatus_t xTaskDetails;
+    BaseType_t x;
+    BaseType_t y;
+    uint32_t i;
+
+    for( x = 0; x < configNUMBER_OF_CORES; x++ )
+    {
+        TEST_ASSERT_NOT_NULL( pxCurrentTCBs[ x ] );
+        TEST_ASSERT_EQUAL_INT_MESSAGE( x, pxCurrentTCBs[ x ]->xTaskRunState, "Interleaving: inconsistent xTaskRunState" );
+
+        for( y = x + 1; y < configNUMBER_OF_CORES; y++ )
+        {
+            TEST_ASSERT_TRUE_MESSAGE( pxCurrentTCBs[ x ] != pxCurrentTCBs[ y ], "Interleaving: task running on two cores" );
+        }
+
+        uxCoreTaskNumbers[ x ] = pxCurrentTCBs[ x ]->uxTCBNumber;
+    }
+
+    for( i = 0; i < ulNumTasks; i++ )
+    {
+        if( pxTaskHandles[ i ] == NULL )
+        {
+            continue;
+        }
+
+        vTaskGetInfo( pxTaskHandles[ i ], &xTaskDetails, pdTRUE, eInvalid );
+
+        if( xTaskDetails.eCurrentState == eReady )
+        {
+            for( x = 0; x < configNUMBER_OF_CORES; x++ )
+            {
+                TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE( xTaskDetails.xHandle->uxPriority,
+                                                      pxCurrentTCBs[ x ]->uxPriority,
+                                                      "Interleaving: a core runs a lower priority task than a ready one" );
+            }
+        }
+    }
+}
+
+/**
+ * @brief Scenario: every core runs a priority 1 task with as many priority 1
+ * tasks ready. Core 0 raises the ready tasks to priority 2 inside one critical
+ * section, leaving a yield pending on every core when it exits.
+ */
+static void prvScenarioRaisePriorities( void )
+{
+    TaskHandle_t xTaskHandles[ INTERLEAVING_NUM_TASKS ] = { NULL };
+    uint32_t i;
+
+    for( i = 0; i < INTERLEAVING_NUM_TASKS; i++ )
+    {
+        xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL, 1, &xTaskHandles[ i ] );
+    }
+
+    vTaskStartScheduler();
+
+    taskENTER_CRITICAL();
+    {
+        for( i = configNUMBER_OF_CORES; i < INTERLEAVING_NUM_TASKS; i++ )
+        {
+            vTaskPrioritySet( xTaskHandles[ i ], 2 );
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    verifyCoreAssignment( xTaskHandles, INTERLEAVING_NUM_TASKS );
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        verifySmpTask( &xTaskHandles[ i ], eReady, -1 );
+    }
+}
+
+/**
+ * @brief Scenario: every core runs a priority 1 task while as many priority 2
+ * tasks are suspended. Core 0 resumes them inside one critical section.
+ */
+static void prvScenarioResumeTasks( void )
+{
+    TaskHandle_t xTaskHandles[ INTERLEAVING_NUM_TASKS ] = { NULL };
+    uint32_t i;
+
+    for( i = 0; i < INTERLEAVING_NUM_TASKS; i++ )
+    {
+        xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL,
+                     ( i < configNUMBER_OF_CORES ) ? 1 : 2, &xTaskHandles[ i ] );
+
+        if( i >= configNUMBER_OF_CORES )
+        {
+            vTaskSuspend( xTaskHandles[ i ] );
+        }
+    }
+
+    vTaskStartScheduler();
+
+    taskENTER_CRITICAL();
+    {
+        for( i = configNUMBER_OF_CORES; i < INTERLEAVING_NUM_TASKS; i++ )
+        {
+            vTaskResume( xTaskHandles[ i ] );
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    verifyCoreAssignment( xTaskHandles, INTERLEAVING_NUM_TASKS );
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        verifySmpTask( &xTaskHandles[ i ], eReady, -1 );
+    }
+}
+
+/**
+ * @brief Scenario: every core runs a priority 2 task with as many priority 1
+ * tasks ready. Core 0 deletes the tasks running on the other cores inside one
+ * critical section, then the tick interrupt fires.
+ */
+static void prvScenarioDeleteTasks( void )
+{
+    TaskHandle_t xTaskHandles[ INTERLEAVING_NUM_TASKS ] = { NULL };
+    uint32_t i;
+
+    for( i = 0; i < INTERLEAVING_NUM_TASKS; i++ )
+    {
+        xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL,
+                     ( i < configNUMBER_OF_CORES ) ? 2 : 1, &xTaskHandles[ i ] );
+    }
+
+    vTaskStartScheduler();
+
+    taskENTER_CRITICAL();
+    {
+        for( i = 1; i < configNUMBER_OF_CORES; i++ )
+        {
+            vTaskDelete( xTaskHandles[ i ] );
+            xTaskHandles[ i ] = NULL;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    xTaskIncrementTick_helper();
+
+    verifyCoreAssignment( xTaskHandles, INTERLEAVING_NUM_TASKS );
+    verifySmpTask( &xTaskHandles[ 0 ], eRunning, 0 );
+}
+
+/* ==============================  Test Cases  ============================== */
+
+/**
+ * @brief Without a policy the harness services pending yields in ascending
+ * core order, and records every choice it took as the first alternative.
+ */
+void test_interleaving_ascending_by_default( void )
+{
+    const char * pcSchedule;
+
+    prvScenarioRaisePriorities();
+
+    pcSchedule = pcSmpScheduleGet();
+
+    TEST_ASSERT_GREATER_THAN_UINT32( 0, ( uint32_t ) strlen( pcSchedule ) );
+    TEST_ASSERT_EQUAL_UINT32( ( uint32_t ) strlen( pcSchedule ), ( uint32_t ) strspn( pcSchedule, "0" ) );
+}
+
+/**
+ * @brief Every schedule of the first INTERLEAVING_EXHAUSTIVE_DEPTH choices of
+ * prvScenarioRaisePriorities reaches a valid core assignment.
+ */
+void test_interleaving_exhaustive_raise_priorities( void )
+{
+    uint32_t ulRuns;
+
+    ulRuns = ulSmpScheduleExplore( prvScenarioRaisePriorities, eSmpScheduleExhaustive, 0,
+                                   INTERLEAVING_EXHAUSTIVE_RUNS, INTERLEAVING_EXHAUSTIVE_DEPTH );
+
+    TEST_ASSERT_GREATER_THAN_UINT32( 1, ulRuns );
+    TEST_ASSERT_LESS_THAN_UINT32( INTERLEAVING_EXHAUSTIVE_RUNS, ulRuns );
+}
+
+/**
+ * @brief Every schedule of the first INTERLEAVING_EXHAUSTIVE_DEPTH choices of
+ * prvScenarioResumeTasks reaches a valid core assignment.
+ */
+void test_interleaving_exhaustive_resume_tasks( void )
+{
+    uint32_t ulRuns;
+
+    ulRuns = ulSmpScheduleExplore( prvScenarioResumeTasks, eSmpScheduleExhaustive, 0,
+                                   INTERLEAVING_EXHAUSTIVE_RUNS, INTERLEAVING_EXHAUSTIVE_DEPTH );
+
+    TEST_ASSERT_GREATER_THAN_UINT32( 1, ulRuns );
+    TEST_ASSERT_LESS_THAN_UINT32( INTERLEAVING_EXHAUSTIVE_RUNS, ulRuns );
+}
+
+/**
+ * @brief Every schedule of the first INTERLEAVING_EXHAUSTIVE_DEPTH choices of
+ * prvScenarioDeleteTasks reaches a valid core assignment.
+ */
+void test_interleaving_exhaustive_delete_tasks( void )
+{
+    uint32_t ulRuns;
+
+    ulRuns = ulSmpScheduleExplore( prvScenarioDeleteTasks, eSmpScheduleExhaustive, 0,
+                                   INTERLEAVING_EXHAUSTIVE_RUNS, INTERLEAVING_EXHAUSTIVE_DEPTH );
+
+    TEST_ASSERT_GREATER_THAN_UINT32( 1, ulRuns );
+    TEST_ASSERT_LESS_THAN_UINT32( INTERLEAVING_EXHAUSTIVE_RUNS, ulRuns );
+}
+
+/**
+ * @brief Seeded random schedules of every scenario.
+ */
+void test_interleaving_random( void )
+{
+    TEST_ASSERT_EQUAL_UINT32( INTERLEAVING_RANDOM_RUNS,
+                              ulSmpScheduleExplore( prvScenarioRaisePriorities, eSmpScheduleRandom, 0x5eed0001,
+                                                    INTERLEAVING_RANDOM_RUNS, 0 ) );
+    TEST_ASSERT_EQUAL_UINT32( INTERLEAVING_RANDOM_RUNS,
+                              ulSmpScheduleExplore( prvScenarioResumeTasks, eSmpScheduleRandom, 0x5eed0002,
+                                                    INTERLEAVING_RANDOM_RUNS, 0 ) );
+    TEST_ASSERT_EQUAL_UINT32( INTERLEAVING_RANDOM_RUNS,
+                              ulSmpScheduleExplore( prvScenarioDeleteTasks, eSmpScheduleRandom, 0x5eed0003,
+                                                    INTERLEAVING_RANDOM_RUNS, 0 ) );
+}
+
+/**
+ * @brief Round-robin schedules of every scenario.
+ */
+void test_interleaving_round_robin( void )
+{
+    TEST_ASSERT_EQUAL_UINT32( 1, ulSmpScheduleExplore( prvScenarioRaisePriorities, eSmpScheduleRoundRobin, 0, 1, 0 ) );
+    TEST_ASSERT_EQUAL_UINT32( 1, ulSmpScheduleExplore( prvScenarioResumeTasks, eSmpScheduleRoundRobin, 0, 1, 0 ) );
+    TEST_ASSERT_EQUAL_UINT32( 1, ulSmpScheduleExplore( prvScenarioDeleteTasks, eSmpScheduleRoundRobin, 0, 1, 0 ) );
+}
+
+/**
+ * @brief Replaying a recorded random schedule takes the same choices and
+ * leaves the same task on every core.
+ */
+void test_interleaving_replay( void )
+{
+    char cRecorded[ 256 ];
+    UBaseType_t uxRecordedTaskNumbers[ configNUMBER_OF_CORES ];
+
+    TEST_ASSERT_EQUAL_UINT32( 1, ulSmpScheduleExplore( prvScenarioRaisePriorities, eSmpScheduleRandom, 1234, 1, 0 ) );
+
+    TEST_ASSERT_LESS_THAN_UINT32( sizeof( cRecorded ), ( uint32_t ) strlen( pcSmpScheduleGet() ) );
+    strcpy( cRecorded, pcSmpScheduleGet() );
+    memcpy( uxRecordedTaskNumbers, uxCoreTaskNumbers, sizeof( uxRecordedTaskNumbers ) );
+
+    vSmpScheduleReplay( cRecorded );
+    TEST_ASSERT_EQUAL_UINT32( 1, ulSmpScheduleExplore( prvScenarioRaisePriorities, eSmpScheduleReplay, 0, 1, 0 ) );
+
+    TEST_ASSERT_EQUAL_STRING( cRecorded, pcSmpScheduleGet() );
+    TEST_ASSERT_EQUAL_MEMORY( uxRecordedTaskNumbers, uxCoreTaskNumbers, sizeof( uxRecordedTaskNumbers ) );
+}
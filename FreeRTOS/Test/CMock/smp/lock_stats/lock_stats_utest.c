@@ -0,0 +1,336 @@
+/*
+ * FreeRTOS V202012.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file lock_stats_utest.c */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Task includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "event_groups.h"
+#include "queue.h"
+
+/* Test includes. */
+#include "unity.h"
+#include "unity_memory.h"
+#include "../global_vars.h"
+#include "../smp_utest_common.h"
+
+/* Mock includes. */
+#include "mock_timers.h"
+#include "mock_fake_assert.h"
+#include "mock_fake_port.h"
+
+/* ===========================  STATIC VARIABLES  =========================== */
+
+/* Totals reported through the lock trace hooks. */
+static uint32_t ulTaskLockAcquiredCalls;
+static uint32_t ulTaskLockReleasedCalls;
+static uint32_t ulIsrLockAcquiredCalls;
+static uint32_t ulIsrLockReleasedCalls;
+static uint64_t ullTraceTaskSpinCycles;
+static uint64_t ullTraceTaskHoldCycles;
+static uint64_t ullTraceIsrSpinCycles;
+static uint64_t ullTraceIsrHoldCycles;
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    commonSetUp();
+
+    ulTaskLockAcquiredCalls = 0;
+    ulTaskLockReleasedCalls = 0;
+    ulIsrLockAcquiredCalls = 0;
+    ulIsrLockReleasedCalls = 0;
+    ullTraceTaskSpinCycles = 0;
+    ullTraceTaskHoldCycles = 0;
+    ullTraceIsrSpinCycles = 0;
+    ullTraceIsrHoldCycles = 0;
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+    commonTearDown();
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+
+/* ===========================  Trace hooks  =========================== */
+
+void vTraceTaskLockAcquired( unsigned long long ullSpinCycles )
+{
+    ulTaskLockAcquiredCalls++;
+    ullTraceTaskSpinCycles += ullSpinCycles;
+}
+
+void vTraceTaskLockReleased( unsigned long long ullHoldCycles )
+{
+    ulTaskLockReleasedCalls++;
+    ullTraceTaskHoldCycles += ullHoldCycles;
+}
+
+void vTraceIsrLockAcquired( unsigned long long ullSpinCycles )
+{
+    ulIsrLockAcquiredCalls++;
+    ullTraceIsrSpinCycles += ullSpinCycles;
+}
+
+void vTraceIsrLockReleased( unsigned long long ullHoldCycles )
+{
+    ulIsrLockReleasedCalls++;
+    ullTraceIsrHoldCycles += ullHoldCycles;
+}
+
+/* ==============================  Test Cases  ============================== */
+
+/**
+ * @brief The time between the outermost acquisition and release of the task
+ * lock is reported as its hold time, with no spin time when uncontended.
+ */
+void test_lock_stats_task_lock_hold_time( void )
+{
+    SmpLockStats_t xTaskLockStats;
+    SmpLockStats_t xIsrLockStats;
+
+    vFakePortGetTaskLock();
+    vSmpAdvanceCycleCounter( 1000 );
+    vFakePortReleaseTaskLock();
+
+    vSmpGetLockStats( 0, &xTaskLockStats, &xIsrLockStats );
+
+    TEST_ASSERT_EQUAL_UINT32( 1, xTaskLockStats.ulAcquisitions );
+    TEST_ASSERT_EQUAL_UINT64( 0, xTaskLockStats.ullTotalSpinCycles );
+    TEST_ASSERT_EQUAL_UINT64( 0, xTaskLockStats.ullMaxSpinCycles );
+    TEST_ASSERT_EQUAL_UINT64( 1000, xTaskLockStats.ullTotalHoldCycles );
+    TEST_ASSERT_EQUAL_UINT64( 1000, xTaskLockStats.ullMaxHoldCycles );
+
+    TEST_ASSERT_EQUAL_UINT32( 0, xIsrLockStats.ulAcquisitions );
+    TEST_ASSERT_EQUAL_UINT64( 0, xIsrLockStats.ullTotalHoldCycles );
+}
+
+/**
+ * @brief A recursively taken lock counts as a single acquisition, held from
+ * the outermost acquisition to the outermost release.
+ */
+void test_lock_stats_nested_acquisition_counted_once( void )
+{
+    SmpLockStats_t xTaskLockStats;
+
+    vFakePortGetTaskLock();
+    vSmpAdvanceCycleCounter( 40 );
+    vFakePortGetTaskLock();
+    vSmpAdvanceCycleCounter( 60 );
+    vFakePortReleaseTaskLock();
+    vFakePortReleaseTaskLock();
+
+    vSmpGetLockStats( 0, &xTaskLockStats, NULL );
+
+    TEST_ASSERT_EQUAL_UINT32( 1, xTaskLockStats.ulAcquisitions );
+    TEST_ASSERT_EQUAL_UINT64( 100, xTaskLockStats.ullTotalHoldCycles );
+    TEST_ASSERT_EQUAL_UINT32( 1, ulTaskLockAcquiredCalls );
+    TEST_ASSERT_EQUAL_UINT32( 1, ulTaskLockReleasedCalls );
+    TEST_ASSERT_EQUAL_UINT64( 100, ullTraceTaskHoldCycles );
+}
+
+/**
+ * @brief The spin and hold costs set with vSmpSetLockCycleCosts() are
+ * accumulated on every outermost acquisition and release.
+ */
+void test_lock_stats_isr_lock_cycle_costs( void )
+{
+    SmpLockStats_t xIsrLockStats;
+    uint32_t i;
+
+    vSmpSetLockCycleCosts( 7, 11 );
+
+    for( i = 0; i < 3; i++ )
+    {
+        vFakePortGetISRLock();
+        vFakePortReleaseISRLock();
+    }
+
+    vSmpGetLockStats( 0, NULL, &xIsrLockStats );
+
+    TEST_ASSERT_EQUAL_UINT32( 3, xIsrLockStats.ulAcquisitions );
+    TEST_ASSERT_EQUAL_UINT64( 21, xIsrLockStats.ullTotalSpinCycles );
+    TEST_ASSERT_EQUAL_UINT64( 7, xIsrLockStats.ullMaxSpinCycles );
+    TEST_ASSERT_EQUAL_UINT64( 33, xIsrLockStats.ullTotalHoldCycles );
+    TEST_ASSERT_EQUAL_UINT64( 11, xIsrLockStats.ullMaxHoldCycles );
+    TEST_ASSERT_EQUAL_UINT64( 54, ullSmpGetCycleCounter() );
+
+    TEST_ASSERT_EQUAL_UINT32( 3, ulIsrLockAcquiredCalls );
+    TEST_ASSERT_EQUAL_UINT64( 21, ullTraceIsrSpinCycles );
+    TEST_ASSERT_EQUAL_UINT64( 33, ullTraceIsrHoldCycles );
+}
+
+/**
+ * @brief The maximum hold time is the longest single hold, not the last one.
+ */
+void test_lock_stats_max_hold_time( void )
+{
+    SmpLockStats_t xTaskLockStats;
+    const uint32_t ulHoldCycles[] = { 10, 50, 20 };
+    uint32_t i;
+
+    for( i = 0; i < ( sizeof( ulHoldCycles ) / sizeof( ulHoldCycles[ 0 ] ) ); i++ )
+    {
+        vFakePortGetTaskLock();
+        vSmpAdvanceCycleCounter( ulHoldCycles[ i ] );
+        vFakePortReleaseTaskLock();
+    }
+
+    vSmpGetLockStats( 0, &xTaskLockStats, NULL );
+
+    TEST_ASSERT_EQUAL_UINT32( 3, xTaskLockStats.ulAcquisitions );
+    TEST_ASSERT_EQUAL_UINT64( 80, xTaskLockStats.ullTotalHoldCycles );
+    TEST_ASSERT_EQUAL_UINT64( 50, xTaskLockStats.ullMaxHoldCycles );
+}
+
+/**
+ * @brief The lock statistics are attributed to the core holding the lock.
+ */
+void test_lock_stats_per_core( void )
+{
+    SmpLockStats_t xTaskLockStats;
+    BaseType_t xCoreID;
+
+    vSetCurrentCore( 1 );
+    vFakePortGetTaskLock();
+    vSmpAdvanceCycleCounter( 5 );
+    vFakePortReleaseTaskLock();
+    vSetCurrentCore( 0 );
+
+    for( xCoreID = 0; xCoreID < configNUMBER_OF_CORES; xCoreID++ )
+    {
+        vSmpGetLockStats( xCoreID, &xTaskLockStats, NULL );
+
+        if( xCoreID == 1 )
+        {
+            TEST_ASSERT_EQUAL_UINT32( 1, xTaskLockStats.ulAcquisitions );
+            TEST_ASSERT_EQUAL_UINT64( 5, xTaskLockStats.ullTotalHoldCycles );
+        }
+        else
+        {
+            TEST_ASSERT_EQUAL_UINT32( 0, xTaskLockStats.ulAcquisitions );
+            TEST_ASSERT_EQUAL_UINT64( 0, xTaskLockStats.ullTotalHoldCycles );
+        }
+    }
+}
+
+/**
+ * @brief The statistics gathered while the kernel starts the scheduler agree
+ * with what the trace hooks reported.
+ */
+void test_lock_stats_match_trace_hooks( void )
+{
+    TaskHandle_t xTaskHandles[ configNUMBER_OF_CORES ] = { NULL };
+    SmpLockStats_t xTaskLockStats;
+    SmpLockStats_t xIsrLockStats;
+    uint32_t ulTaskAcquisitions = 0;
+    uint32_t ulIsrAcquisitions = 0;
+    uint64_t ullTaskSpinCycles = 0;
+    uint64_t ullTaskHoldCycles = 0;
+    uint64_t ullIsrSpinCycles = 0;
+    uint64_t ullIsrHoldCycles = 0;
+    BaseType_t xCoreID;
+    uint32_t i;
+
+    vSmpSetLockCycleCosts( 3, 4 );
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL, 1, &xTaskHandles[ i ] );
+    }
+
+    vTaskStartScheduler();
+
+    for( xCoreID = 0; xCoreID < configNUMBER_OF_CORES; xCoreID++ )
+    {
+        vSmpGetLockStats( xCoreID, &xTaskLockStats, &xIsrLockStats );
+
+        TEST_ASSERT_LESS_OR_EQUAL_UINT64( xTaskLockStats.ullTotalHoldCycles, xTaskLockStats.ullMaxHoldCycles );
+        TEST_ASSERT_LESS_OR_EQUAL_UINT64( xIsrLockStats.ullTotalHoldCycles, xIsrLockStats.ullMaxHoldCycles );
+
+        ulTaskAcquisitions += xTaskLockStats.ulAcquisitions;
+        ulIsrAcquisitions += xIsrLockStats.ulAcquisitions;
+        ullTaskSpinCycles += xTaskLockStats.ullTotalSpinCycles;
+        ullTaskHoldCycles += xTaskLockStats.ullTotalHoldCycles;
+        ullIsrSpinCycles += xIsrLockStats.ullTotalSpinCycles;
+        ullIsrHoldCycles += xIsrLockStats.ullTotalHoldCycles;
+    }
+
+    TEST_ASSERT_GREATER_THAN_UINT32( 0, ulTaskAcquisitions );
+    TEST_ASSERT_EQUAL_UINT32( ulTaskLockAcquiredCalls, ulTaskAcquisitions );
+    TEST_ASSERT_EQUAL_UINT32( ulTaskLockReleasedCalls, ulTaskAcquisitions );
+    TEST_ASSERT_EQUAL_UINT32( ulIsrLockAcquiredCalls, ulIsrAcquisitions );
+    TEST_ASSERT_EQUAL_UINT32( ulIsrLockReleasedCalls, ulIsrAcquisitions );
+    TEST_ASSERT_EQUAL_UINT64( ( uint64_t ) ulTaskAcquisitions * 3, ullTaskSpinCycles );
+    TEST_ASSERT_EQUAL_UINT64( ( uint64_t ) ulIsrAcquisitions * 3, ullIsrSpinCycles );
+    TEST_ASSERT_EQUAL_UINT64( ( uint64_t ) ulIsrAcquisitions * 4, ullIsrHoldCycles );
+    TEST_ASSERT_EQUAL_UINT64( ullTraceTaskSpinCycles, ullTaskSpinCycles );
+    TEST_ASSERT_EQUAL_UINT64( ullTraceTaskHoldCycles, ullTaskHoldCycles );
+    TEST_ASSERT_EQUAL_UINT64( ullTraceIsrSpinCycles, ullIsrSpinCycles );
+    TEST_ASSERT_EQUAL_UINT64( ullTraceIsrHoldCycles, ullIsrHoldCycles );
+}
+
+/**
+ * @brief vSmpGetLockStatsString() writes one tab separated line per core and
+ * lock, and never writes a partial line.
+ */
+void test_lock_stats_string( void )
+{
+    char cBuffer[ 64 * 2 * configNUMBER_OF_CORES ];
+    char cShortBuffer[ 10 ];
+
+    vFakePortGetTaskLock();
+    vSmpAdvanceCycleCounter( 1000 );
+    vFakePortReleaseTaskLock();
+
+    vSmpGetLockStatsString( cBuffer, sizeof( cBuffer ) );
+
+    TEST_ASSERT_NOT_NULL( strstr( cBuffer, "0\tTASK\t1\t0\t0\t1000\t1000\r\n" ) );
+    TEST_ASSERT_NOT_NULL( strstr( cBuffer, "0\tISR\t0\t0\t0\t0\t0\r\n" ) );
+    TEST_ASSERT_NOT_NULL( strstr( cBuffer, "1\tTASK\t0\t0\t0\t0\t0\r\n" ) );
+
+    vSmpGetLockStatsString( cShortBuffer, sizeof( cShortBuffer ) );
+
+    TEST_ASSERT_EQUAL_STRING( "", cShortBuffer );
+}
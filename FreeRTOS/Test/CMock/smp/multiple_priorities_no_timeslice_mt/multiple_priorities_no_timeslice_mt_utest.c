@@ -0,0 +1,254 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file multiple_priorities_no_timeslice_mt_utest.c */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Task includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "event_groups.h"
+#include "queue.h"
+
+/* Test includes. */
+#include "unity.h"
+#include "unity_memory.h"
+#include "../global_vars.h"
+#include "../smp_utest_mt_common.h"
+
+/* Mock includes. */
+#include "mock_timers.h"
+#include "mock_fake_assert.h"
+#include "mock_fake_port.h"
+
+/* ===========================  LOCAL DEFINITIONS  ========================== */
+
+/* Number of iterations executed by each core thread. */
+#define mtITERATIONS       ( 2000U )
+
+/* Number of tasks created per core, so that yields have somewhere to go. */
+#define mtTASKS_PER_CORE   ( 2U )
+
+#define mtNUM_TASKS        ( configNUMBER_OF_CORES * mtTASKS_PER_CORE )
+
+/* ===========================  EXTERN VARIABLES  =========================== */
+
+extern volatile TickType_t xTickCount;
+extern volatile TCB_t *  pxCurrentTCBs[ configNUMBER_OF_CORES ];
+
+/* ============================  LOCAL VARIABLES  =========================== */
+
+static TaskHandle_t xTaskHandles[ mtNUM_TASKS ] = { NULL };
+
+/* Only modified inside critical sections. */
+static volatile uint32_t ulSharedCounter = 0;
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    commonSetUp();
+    memset( xTaskHandles, 0x00, sizeof( xTaskHandles ) );
+    ulSharedCounter = 0;
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+    commonTearDown();
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+
+/* =============================  HELPER FUNCTIONS  ========================= */
+
+static void prvCreateTasks( UBaseType_t uxPriority )
+{
+    uint32_t i;
+
+    for( i = 0; i < mtNUM_TASKS; i++ )
+    {
+        xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL, uxPriority, &xTaskHandles[ i ] );
+    }
+}
+
+static void prvYieldCoreFunction( BaseType_t xCoreID,
+                                  uint32_t ulIteration )
+{
+    /* Alternate between yielding this core and interrupting a neighbour. */
+    if( ( ulIteration & 1U ) == 0U )
+    {
+        taskYIELD();
+    }
+    else
+    {
+        portYIELD_CORE( ( xCoreID + 1 ) % configNUMBER_OF_CORES );
+    }
+}
+
+static void prvCriticalSectionCoreFunction( BaseType_t xCoreID,
+                                            uint32_t ulIteration )
+{
+    uint32_t ulValue;
+
+    taskENTER_CRITICAL();
+    {
+        /* Split read-modify-write, a lost update means the locks failed. */
+        ulValue = ulSharedCounter;
+        ulSharedCounter = ulValue + 1U;
+    }
+    taskEXIT_CRITICAL();
+}
+
+static void prvTickAndPriorityCoreFunction( BaseType_t xCoreID,
+                                            uint32_t ulIteration )
+{
+    if( xCoreID == configTICK_CORE )
+    {
+        xTaskIncrementTick_helper();
+    }
+    else
+    {
+        /* Each core only touches its own tasks, yet every call contends
+         * with the tick and with the other cores for the kernel locks. */
+        vTaskPrioritySet( xTaskHandles[ xCoreID ], 1 + ( ulIteration & 1U ) );
+    }
+}
+
+static void prvAffinityCoreFunction( BaseType_t xCoreID,
+                                     uint32_t ulIteration )
+{
+    UBaseType_t uxMask;
+
+    if( ( ulIteration & 1U ) == 0U )
+    {
+        /* Restrict the task to a pair of cores. */
+        uxMask = ( 1U << ( ( xCoreID + ulIteration ) % configNUMBER_OF_CORES ) ) |
+                 ( 1U << ( ( xCoreID + ulIteration + 1U ) % configNUMBER_OF_CORES ) );
+    }
+    else
+    {
+        uxMask = tskNO_AFFINITY;
+    }
+
+    vTaskCoreAffinitySet( xTaskHandles[ xCoreID ], uxMask );
+}
+
+/* ==============================  Test Cases  ============================== */
+
+/**
+ * @brief Every core yields itself or its neighbour concurrently. Each yield runs
+ * vTaskSwitchContext() on the target core's own host thread, so all cores compete
+ * for the task and ISR locks while picking tasks from the shared ready lists.
+ *
+ * Once the cores stop, each core must run exactly one task and no task may be
+ * running on two cores.
+ */
+void test_mt_switch_context_contention( void )
+{
+    prvCreateTasks( 1 );
+
+    vTaskStartScheduler();
+
+    vSmpMtRunCores( prvYieldCoreFunction, mtITERATIONS );
+
+    verifySmpMtRunningTasks();
+}
+
+/**
+ * @brief Every core increments a shared counter inside taskENTER_CRITICAL() /
+ * taskEXIT_CRITICAL(). The counter matches the total number of critical sections
+ * only if the spinlocks backing portGET_TASK_LOCK() and portGET_ISR_LOCK() provide
+ * mutual exclusion between the cores.
+ */
+void test_mt_critical_section_mutual_exclusion( void )
+{
+    prvCreateTasks( 1 );
+
+    vTaskStartScheduler();
+
+    vSmpMtRunCores( prvCriticalSectionCoreFunction, mtITERATIONS );
+
+    TEST_ASSERT_EQUAL_UINT32( configNUMBER_OF_CORES * mtITERATIONS, ulSharedCounter );
+    verifySmpMtRunningTasks();
+}
+
+/**
+ * @brief The tick core calls xTaskIncrementTick() while the other cores change task
+ * priorities. No tick may be lost and the scheduler state has to be consistent
+ * once the cores stop.
+ */
+void test_mt_tick_increment_with_priority_changes( void )
+{
+    TickType_t xStartTick;
+
+    prvCreateTasks( 1 );
+
+    vTaskStartScheduler();
+
+    xStartTick = xTickCount;
+
+    vSmpMtRunCores( prvTickAndPriorityCoreFunction, mtITERATIONS );
+
+    TEST_ASSERT_EQUAL_UINT32( xStartTick + mtITERATIONS, xTickCount );
+    verifySmpMtRunningTasks();
+}
+
+/**
+ * @brief Every core changes the affinity of one task while the others do the
+ * same. Once the cores stop, each running task must be allowed to run on the
+ * core it occupies.
+ */
+void test_mt_core_affinity_changes( void )
+{
+    BaseType_t i;
+
+    prvCreateTasks( 1 );
+
+    vTaskStartScheduler();
+
+    vSmpMtRunCores( prvAffinityCoreFunction, mtITERATIONS );
+
+    verifySmpMtRunningTasks();
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        TEST_ASSERT_NOT_EQUAL( 0, pxCurrentTCBs[ i ]->uxCoreAffinityMask & ( 1U << i ) );
+    }
+}
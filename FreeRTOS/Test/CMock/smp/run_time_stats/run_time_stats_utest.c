@@ -0,0 +1,219 @@
+/*
+ * FreeRTOS V202012.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file run_time_stats_utest.c */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Task includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "event_groups.h"
+#include "queue.h"
+
+/* Test includes. */
+#include "unity.h"
+#include "unity_memory.h"
+#include "../global_vars.h"
+#include "../smp_utest_common.h"
+
+/* Mock includes. */
+#include "mock_timers.h"
+#include "mock_fake_assert.h"
+#include "mock_fake_port.h"
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    commonSetUp();
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+    commonTearDown();
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+
+/* ==============================  Test Cases  ============================== */
+
+/**
+ * @brief With no task created, every core runs its idle task and all of the
+ * run time is accounted as idle time.
+ */
+void test_run_time_stats_all_cores_idle( void )
+{
+    SmpCoreRunTimeStats_t xStats;
+    BaseType_t i;
+
+    vTaskStartScheduler();
+
+    vSmpAdvanceRunTimeCounter( 1000 );
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        vSmpGetCoreRunTimeStats( i, &xStats );
+
+        TEST_ASSERT_EQUAL_UINT64( 0, xStats.ullBusyTime );
+        TEST_ASSERT_EQUAL_UINT64( 1000, xStats.ullIdleTime );
+    }
+}
+
+/**
+ * @brief With a task running on every core, all of the run time is accounted
+ * as busy time, and each task resides on its own core only. The kernel's
+ * counter of a task agrees once the task is switched out.
+ */
+void test_run_time_stats_task_per_core( void )
+{
+    TaskHandle_t xTaskHandles[ configNUMBER_OF_CORES ] = { NULL };
+    SmpCoreRunTimeStats_t xStats;
+    BaseType_t i;
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL, 1, &xTaskHandles[ i ] );
+    }
+
+    vTaskStartScheduler();
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        verifySmpTask( &xTaskHandles[ i ], eRunning, i );
+    }
+
+    vSmpAdvanceRunTimeCounter( 500 );
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        vSmpGetCoreRunTimeStats( i, &xStats );
+
+        TEST_ASSERT_EQUAL_UINT64( 500, xStats.ullBusyTime );
+        TEST_ASSERT_EQUAL_UINT64( 0, xStats.ullIdleTime );
+        TEST_ASSERT_EQUAL_UINT64( 500, ullSmpGetTaskCoreRunTime( xTaskHandles[ i ], i ) );
+        TEST_ASSERT_EQUAL_UINT64( 0, ullSmpGetTaskCoreRunTime( xTaskHandles[ i ], ( i + 1 ) % configNUMBER_OF_CORES ) );
+    }
+
+    /* Switch the tasks out so the kernel charges their run time. */
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        vTaskSuspend( xTaskHandles[ i ] );
+        TEST_ASSERT_EQUAL_UINT64( 500, ulTaskGetRunTimeCounter( xTaskHandles[ i ] ) );
+    }
+}
+
+/**
+ * @brief A task moved to another core by a change of affinity is charged on
+ * each core for the time it ran there, and the cores account the rest of the
+ * time as idle.
+ */
+void test_run_time_stats_migration( void )
+{
+    TaskHandle_t xTaskHandle = NULL;
+    SmpCoreRunTimeStats_t xStats;
+    BaseType_t i;
+
+    xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL, 1, &xTaskHandle );
+    vTaskCoreAffinitySet( xTaskHandle, ( 1 << 0 ) );
+
+    vTaskStartScheduler();
+
+    verifySmpTask( &xTaskHandle, eRunning, 0 );
+
+    vSmpAdvanceRunTimeCounter( 100 );
+
+    /* Move the task to core 1. */
+    vTaskCoreAffinitySet( xTaskHandle, ( 1 << 1 ) );
+
+    verifySmpTask( &xTaskHandle, eRunning, 1 );
+
+    vSmpAdvanceRunTimeCounter( 200 );
+
+    TEST_ASSERT_EQUAL_UINT64( 100, ullSmpGetTaskCoreRunTime( xTaskHandle, 0 ) );
+    TEST_ASSERT_EQUAL_UINT64( 200, ullSmpGetTaskCoreRunTime( xTaskHandle, 1 ) );
+
+    vSmpGetCoreRunTimeStats( 0, &xStats );
+    TEST_ASSERT_EQUAL_UINT64( 100, xStats.ullBusyTime );
+    TEST_ASSERT_EQUAL_UINT64( 200, xStats.ullIdleTime );
+
+    vSmpGetCoreRunTimeStats( 1, &xStats );
+    TEST_ASSERT_EQUAL_UINT64( 200, xStats.ullBusyTime );
+    TEST_ASSERT_EQUAL_UINT64( 100, xStats.ullIdleTime );
+
+    for( i = 2; i < configNUMBER_OF_CORES; i++ )
+    {
+        vSmpGetCoreRunTimeStats( i, &xStats );
+        TEST_ASSERT_EQUAL_UINT64( 0, xStats.ullBusyTime );
+        TEST_ASSERT_EQUAL_UINT64( 300, xStats.ullIdleTime );
+    }
+
+    /* The kernel keeps a single counter for the task across both cores. */
+    vTaskSuspend( xTaskHandle );
+    TEST_ASSERT_EQUAL_UINT64( 300, ulTaskGetRunTimeCounter( xTaskHandle ) );
+}
+
+/**
+ * @brief The 64-bit run time counter does not wrap after 2^32 ticks, neither
+ * in the harness accounting nor in the kernel's counter of the task.
+ */
+void test_run_time_stats_counter_past_32_bits( void )
+{
+    TaskHandle_t xTaskHandle = NULL;
+    SmpCoreRunTimeStats_t xStats;
+    const uint64_t ullTicks = 5000000000ULL;
+
+    xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL, 1, &xTaskHandle );
+    vTaskCoreAffinitySet( xTaskHandle, ( 1 << 0 ) );
+
+    vTaskStartScheduler();
+
+    vSmpAdvanceRunTimeCounter( ullTicks );
+
+    TEST_ASSERT_EQUAL_UINT64( ullTicks, ullSmpGetTaskCoreRunTime( xTaskHandle, 0 ) );
+
+    vSmpGetCoreRunTimeStats( 0, &xStats );
+    TEST_ASSERT_EQUAL_UINT64( ullTicks, xStats.ullBusyTime );
+
+    vSmpGetCoreRunTimeStats( 1, &xStats );
+    TEST_ASSERT_EQUAL_UINT64( ullTicks, xStats.ullIdleTime );
+
+    vTaskSuspend( xTaskHandle );
+    TEST_ASSERT_EQUAL_UINT64( ullTicks, ulTaskGetRunTimeCounter( xTaskHandle ) );
+}
@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdio.h>
 
 /* Test includes */
 #include "task.h"
@@ -45,6 +46,35 @@
 #include "mock_fake_port.h"
 #include "mock_timers.h"
 
+/* ===========================  LOCAL DEFINITIONS  ========================== */
+
+/* Lock trace hooks, called on every outermost acquisition and release of the
+ * task and ISR locks. A suite's FreeRTOSConfig.h may define them. */
+#ifndef traceTASK_LOCK_ACQUIRED
+    #define traceTASK_LOCK_ACQUIRED( ullSpinCycles )
+#endif
+
+#ifndef traceTASK_LOCK_RELEASED
+    #define traceTASK_LOCK_RELEASED( ullHoldCycles )
+#endif
+
+#ifndef traceISR_LOCK_ACQUIRED
+    #define traceISR_LOCK_ACQUIRED( ullSpinCycles )
+#endif
+
+#ifndef traceISR_LOCK_RELEASED
+    #define traceISR_LOCK_RELEASED( ullHoldCycles )
+#endif
+
+/* Longest schedule, in choices, that can be recorded or replayed. */
+#define smpSCHEDULE_MAX_LENGTH          ( 1024U )
+
+/* Most blocks the kernel may hold at once during one exploration run. */
+#define smpEXPLORE_MAX_ALLOCATIONS      ( 256U )
+
+/* Most tasks whose run time per core can be tracked during one test. */
+#define smpRUN_TIME_MAX_TASKS           ( 32U )
+
 /* ===========================  EXTERN VARIABLES  =========================== */
 
 extern List_t pxReadyTasksLists[ configMAX_PRIORITIES ];
@@ -64,6 +94,10 @@ extern volatile UBaseType_t uxSchedulerSuspended;
 extern volatile UBaseType_t uxDeletedTasksWaitingCleanUp;
 extern List_t * volatile pxDelayedTaskList;
 extern volatile TCB_t *  pxCurrentTCBs[ configNUMBER_OF_CORES ];
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+    extern configRUN_TIME_COUNTER_TYPE ulTaskSwitchedInTime[ configNUMBER_OF_CORES ];
+    extern volatile configRUN_TIME_COUNTER_TYPE ulTotalRunTime[ configNUMBER_OF_CORES ];
+#endif
 
 static BaseType_t xCoreYields[ configNUMBER_OF_CORES ] = { 0 };
 
@@ -78,6 +112,72 @@ static BaseType_t xCurrentCoreId = 0;
 static BaseType_t xIsrLockCount[ configNUMBER_OF_CORES ] = { 0 };
 static BaseType_t xTaskLockCount[ configNUMBER_OF_CORES ] = { 0 };
 
+/* Fake cycle counter timing the locks. It only moves when a test advances it
+ * or through the lock cycle costs, which keeps the lock statistics exact. */
+static uint64_t ullCycleCounter = 0;
+static uint32_t ulLockSpinCycles = 0;
+static uint32_t ulLockHoldCycles = 0;
+
+/* Cycle counter value at the outermost acquisition of each core's locks. */
+static uint64_t ullTaskLockAcquiredAt[ configNUMBER_OF_CORES ] = { 0 };
+static uint64_t ullIsrLockAcquiredAt[ configNUMBER_OF_CORES ] = { 0 };
+
+#if ( configGENERATE_LOCK_STATS == 1 )
+    static SmpLockStats_t xTaskLockStats[ configNUMBER_OF_CORES ];
+    static SmpLockStats_t xIsrLockStats[ configNUMBER_OF_CORES ];
+#endif
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+/* Run time of one task on each core. */
+    typedef struct SmpTaskRunTime
+    {
+        TaskHandle_t xTask;
+        uint64_t ullRunTime[ configNUMBER_OF_CORES ];
+    } SmpTaskRunTime_t;
+
+/* Fake run time counter returned by portGET_RUN_TIME_COUNTER_VALUE(). It only
+ * moves when a test advances it. */
+    static uint64_t ullRunTimeCounter = 0;
+
+/* Task running on each core and the counter value it was switched in at. */
+    static TaskHandle_t xSwitchedInTask[ configNUMBER_OF_CORES ];
+    static uint64_t ullSwitchedInAt[ configNUMBER_OF_CORES ];
+
+    static SmpCoreRunTimeStats_t xCoreRunTimeStats[ configNUMBER_OF_CORES ];
+    static SmpTaskRunTime_t xTaskRunTimes[ smpRUN_TIME_MAX_TASKS ];
+    static uint32_t ulNumTaskRunTimes = 0;
+#endif
+
+/* Scheduling policy choosing which core services its pending yield next, when
+ * more than one core has a yield pending on a lock release. */
+static eSmpSchedulePolicy eSchedulePolicy = eSmpScheduleAscending;
+static uint32_t ulScheduleRandomState = 1;
+static BaseType_t xScheduleLastCore = -1;
+
+/* Choices taken by the current run. Choice i picks entry ucScheduleChoices[ i ]
+ * of the ucScheduleAlternatives[ i ] pending cores, in ascending core order. */
+static uint8_t ucScheduleChoices[ smpSCHEDULE_MAX_LENGTH ];
+static uint8_t ucScheduleAlternatives[ smpSCHEDULE_MAX_LENGTH ];
+static uint32_t ulScheduleLength = 0;
+static BaseType_t xScheduleTruncated = pdFALSE;
+
+/* Choices forced on the start of a run by a replay or exhaustive schedule.
+ * Choices beyond the forced ones are ascending. */
+static uint8_t ucScheduleForced[ smpSCHEDULE_MAX_LENGTH ];
+static uint32_t ulScheduleForcedLength = 0;
+
+/* Two hex digits per choice, for printing and replaying the schedule. */
+static char cScheduleString[ ( smpSCHEDULE_MAX_LENGTH * 2U ) + 1U ];
+
+/* Set while ulSmpScheduleExplore() runs a scenario. Kernel allocations are
+ * tracked so they can be freed before the next run. */
+static BaseType_t xExploring = pdFALSE;
+static uint32_t ulExploreRun = 0;
+static uint32_t ulExploreSeed = 0;
+static void * pvExploreAllocations[ smpEXPLORE_MAX_ALLOCATIONS ];
+static uint32_t ulNumExploreAllocations = 0;
+
 /* ==========================  EXTERN FUNCTIONS  ========================== */
 
 extern void vTaskEnterCritical( void );
@@ -85,15 +185,44 @@ extern void vTaskExitCritical( void );
 extern UBaseType_t vTaskEnterCriticalFromISR( void );
 extern void vTaskExitCriticalFromISR( UBaseType_t uxSavedInterruptStatus );
 
+/* ==========================  STATIC FUNCTIONS  ========================== */
+
+static void prvResetHarnessState( void );
+static void prvSwitchContext( BaseType_t xCoreID );
+static const char * prvScheduleToString( void );
+static BaseType_t prvScheduleNextExhaustive( uint32_t ulDepth );
+
 /* ==========================  CALLBACK FUNCTIONS  ========================== */
 
 void * pvPortMalloc( size_t xSize )
 {
-    return unity_malloc( xSize );
+    void * pv = unity_malloc( xSize );
+
+    if( ( xExploring == pdTRUE ) && ( pv != NULL ) )
+    {
+        TEST_ASSERT_MESSAGE( ulNumExploreAllocations < smpEXPLORE_MAX_ALLOCATIONS, "Too many allocations in one exploration run" );
+        pvExploreAllocations[ ulNumExploreAllocations++ ] = pv;
+    }
+
+    return pv;
 }
 
 void vPortFree( void * pv )
 {
+    uint32_t i;
+
+    if( xExploring == pdTRUE )
+    {
+        for( i = 0; i < ulNumExploreAllocations; i++ )
+        {
+            if( pvExploreAllocations[ i ] == pv )
+            {
+                pvExploreAllocations[ i ] = pvExploreAllocations[ --ulNumExploreAllocations ];
+                break;
+            }
+        }
+    }
+
     return unity_free( pv );
 }
 
@@ -110,7 +239,7 @@ BaseType_t xPortStartScheduler( void )
 
     /* Initialize each core with a task */
     for (i = 0; i < configNUMBER_OF_CORES; i++) {
-        vTaskSwitchContext(i);
+        prvSwitchContext( i );
     }
 
     return pdTRUE;
@@ -145,14 +274,14 @@ void vFakePortYieldCoreStubCallback( int xCoreID, int cmock_num_calls )
     } else {
         /* No task is in the critical section. We can yield this core. */
         xCurrentCoreId = xCoreID;
-        vTaskSwitchContext( xCurrentCoreId );
+        prvSwitchContext( xCurrentCoreId );
         xCurrentCoreId = xPreviousCoreId;
     }
 }
 
 void vFakePortYieldStubCallback( int cmock_num_calls )
 {
-    vTaskSwitchContext( xCurrentCoreId );
+    prvSwitchContext( xCurrentCoreId );
 }
 
 void vFakePortEnterCriticalSection( void )
@@ -178,23 +307,527 @@ void vSetCurrentCore( BaseType_t xCoreID )
     xCurrentCoreId = xCoreID;
 }
 
+void vSmpScheduleSetPolicy( eSmpSchedulePolicy ePolicy,
+                            uint32_t ulSeed )
+{
+    eSchedulePolicy = ePolicy;
+    ulScheduleRandomState = ( ulSeed == 0U ) ? 1U : ulSeed;
+    ulScheduleForcedLength = 0;
+}
+
+void vSmpScheduleReplay( const char * pcSchedule )
+{
+    size_t xLength = strlen( pcSchedule );
+    char cByte[ 3 ] = { 0 };
+    size_t i;
+
+    TEST_ASSERT_MESSAGE( ( xLength % 2U ) == 0U, "Schedule strings hold two hex digits per choice" );
+    TEST_ASSERT_MESSAGE( ( xLength / 2U ) <= smpSCHEDULE_MAX_LENGTH, "Schedule longer than smpSCHEDULE_MAX_LENGTH" );
+
+    for( i = 0; i < ( xLength / 2U ); i++ )
+    {
+        cByte[ 0 ] = pcSchedule[ i * 2U ];
+        cByte[ 1 ] = pcSchedule[ ( i * 2U ) + 1U ];
+        ucScheduleForced[ i ] = ( uint8_t ) strtoul( cByte, NULL, 16 );
+    }
+
+    eSchedulePolicy = eSmpScheduleReplay;
+    ulScheduleForcedLength = ( uint32_t ) ( xLength / 2U );
+}
+
+const char * pcSmpScheduleGet( void )
+{
+    return prvScheduleToString();
+}
+
+uint32_t ulSmpScheduleExplore( SmpScenarioFunction_t pxScenario,
+                               eSmpSchedulePolicy ePolicy,
+                               uint32_t ulSeed,
+                               uint32_t ulMaxRuns,
+                               uint32_t ulDepth )
+{
+    uint32_t ulRuns = 0;
+    BaseType_t xMoreSchedules = pdTRUE;
+
+    /* A replay keeps the choices passed to vSmpScheduleReplay(). */
+    if( ePolicy != eSmpScheduleReplay )
+    {
+        vSmpScheduleSetPolicy( ePolicy, ulSeed );
+    }
+
+    ulExploreSeed = ulSeed;
+
+    while( ( ulRuns < ulMaxRuns ) && ( xMoreSchedules == pdTRUE ) )
+    {
+        prvResetHarnessState();
+        ulExploreRun = ulRuns;
+        xExploring = pdTRUE;
+
+        pxScenario();
+
+        xExploring = pdFALSE;
+        ulRuns++;
+
+        while( ulNumExploreAllocations > 0U )
+        {
+            unity_free( pvExploreAllocations[ --ulNumExploreAllocations ] );
+        }
+
+        if( ePolicy == eSmpScheduleExhaustive )
+        {
+            xMoreSchedules = prvScheduleNextExhaustive( ulDepth );
+        }
+        else if( ePolicy == eSmpScheduleReplay )
+        {
+            xMoreSchedules = pdFALSE;
+        }
+    }
+
+    return ulRuns;
+}
+
+uint64_t ullSmpGetCycleCounter( void )
+{
+    return ullCycleCounter;
+}
+
+void vSmpAdvanceCycleCounter( uint32_t ulCycles )
+{
+    ullCycleCounter += ulCycles;
+}
+
+void vSmpSetLockCycleCosts( uint32_t ulSpinCycles,
+                            uint32_t ulHoldCycles )
+{
+    ulLockSpinCycles = ulSpinCycles;
+    ulLockHoldCycles = ulHoldCycles;
+}
+
+#if ( configGENERATE_LOCK_STATS == 1 )
+
+    void vSmpGetLockStats( BaseType_t xCoreID,
+                           SmpLockStats_t * pxTaskLockStats,
+                           SmpLockStats_t * pxIsrLockStats )
+    {
+        TEST_ASSERT_TRUE( ( xCoreID >= 0 ) && ( xCoreID < configNUMBER_OF_CORES ) );
+
+        if( pxTaskLockStats != NULL )
+        {
+            *pxTaskLockStats = xTaskLockStats[ xCoreID ];
+        }
+
+        if( pxIsrLockStats != NULL )
+        {
+            *pxIsrLockStats = xIsrLockStats[ xCoreID ];
+        }
+    }
+
+    void vSmpGetLockStatsString( char * pcWriteBuffer,
+                                 size_t xBufferLength )
+    {
+        const SmpLockStats_t * pxStats;
+        size_t xWritten = 0;
+        BaseType_t xCoreID;
+        BaseType_t xLock;
+        int iLength;
+
+        if( xBufferLength == 0 )
+        {
+            return;
+        }
+
+        pcWriteBuffer[ 0 ] = '\0';
+
+        for( xCoreID = 0; xCoreID < configNUMBER_OF_CORES; xCoreID++ )
+        {
+            for( xLock = 0; xLock < 2; xLock++ )
+            {
+                pxStats = ( xLock == 0 ) ? &xTaskLockStats[ xCoreID ] : &xIsrLockStats[ xCoreID ];
+
+                iLength = snprintf( &pcWriteBuffer[ xWritten ], xBufferLength - xWritten,
+                                    "%d\t%s\t%u\t%llu\t%llu\t%llu\t%llu\r\n",
+                                    ( int ) xCoreID,
+                                    ( xLock == 0 ) ? "TASK" : "ISR",
+                                    ( unsigned int ) pxStats->ulAcquisitions,
+                                    ( unsigned long long ) pxStats->ullTotalSpinCycles,
+                                    ( unsigned long long ) pxStats->ullMaxSpinCycles,
+                                    ( unsigned long long ) pxStats->ullTotalHoldCycles,
+                                    ( unsigned long long ) pxStats->ullMaxHoldCycles );
+
+                /* Stop at the first line that does not fit. */
+                if( ( iLength < 0 ) || ( ( size_t ) iLength >= ( xBufferLength - xWritten ) ) )
+                {
+                    pcWriteBuffer[ xWritten ] = '\0';
+                    return;
+                }
+
+                xWritten += ( size_t ) iLength;
+            }
+        }
+    }
+
+#endif /* configGENERATE_LOCK_STATS */
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+    static BaseType_t prvIsIdleTask( TaskHandle_t xTask )
+    {
+        BaseType_t i;
+
+        for( i = 0; i < configNUMBER_OF_CORES; i++ )
+        {
+            if( xIdleTaskHandles[ i ] == xTask )
+            {
+                return pdTRUE;
+            }
+        }
+
+        return pdFALSE;
+    }
+
+/* Find the run time entry of xTask, adding one if xCreate is set. */
+    static SmpTaskRunTime_t * prvFindTaskRunTime( TaskHandle_t xTask,
+                                                  BaseType_t xCreate )
+    {
+        uint32_t i;
+
+        for( i = 0; i < ulNumTaskRunTimes; i++ )
+        {
+            if( xTaskRunTimes[ i ].xTask == xTask )
+            {
+                return &xTaskRunTimes[ i ];
+            }
+        }
+
+        if( xCreate == pdFALSE )
+        {
+            return NULL;
+        }
+
+        TEST_ASSERT_LESS_THAN_UINT32( smpRUN_TIME_MAX_TASKS, ulNumTaskRunTimes );
+
+        xTaskRunTimes[ ulNumTaskRunTimes ].xTask = xTask;
+        memset( xTaskRunTimes[ ulNumTaskRunTimes ].ullRunTime, 0x00, sizeof( xTaskRunTimes[ 0 ].ullRunTime ) );
+
+        return &xTaskRunTimes[ ulNumTaskRunTimes++ ];
+    }
+
+    void vConfigureTimerForRunTimeStats( void )
+    {
+    }
+
+    configRUN_TIME_COUNTER_TYPE ulGetRunTimeCounterValue( void )
+    {
+        return ( configRUN_TIME_COUNTER_TYPE ) ullRunTimeCounter;
+    }
+
+    void vSmpSetRunTimeCounter( uint64_t ullValue )
+    {
+        ullRunTimeCounter = ullValue;
+    }
+
+    void vSmpAdvanceRunTimeCounter( uint64_t ullTicks )
+    {
+        ullRunTimeCounter += ullTicks;
+    }
+
+    void vSmpGetCoreRunTimeStats( BaseType_t xCoreID,
+                                  SmpCoreRunTimeStats_t * pxStats )
+    {
+        TEST_ASSERT_TRUE( ( xCoreID >= 0 ) && ( xCoreID < configNUMBER_OF_CORES ) );
+
+        *pxStats = xCoreRunTimeStats[ xCoreID ];
+
+        /* Include the slice the core is running. */
+        if( xSwitchedInTask[ xCoreID ] != NULL )
+        {
+            if( prvIsIdleTask( xSwitchedInTask[ xCoreID ] ) == pdTRUE )
+            {
+                pxStats->ullIdleTime += ullRunTimeCounter - ullSwitchedInAt[ xCoreID ];
+            }
+            else
+            {
+                pxStats->ullBusyTime += ullRunTimeCounter - ullSwitchedInAt[ xCoreID ];
+            }
+        }
+    }
+
+    uint64_t ullSmpGetTaskCoreRunTime( TaskHandle_t xTask,
+                                       BaseType_t xCoreID )
+    {
+        SmpTaskRunTime_t * pxTaskRunTime = prvFindTaskRunTime( xTask, pdFALSE );
+        uint64_t ullRunTime = 0;
+
+        TEST_ASSERT_TRUE( ( xCoreID >= 0 ) && ( xCoreID < configNUMBER_OF_CORES ) );
+
+        if( pxTaskRunTime != NULL )
+        {
+            ullRunTime = pxTaskRunTime->ullRunTime[ xCoreID ];
+        }
+
+        /* Include the slice the task is running on that core. */
+        if( xSwitchedInTask[ xCoreID ] == xTask )
+        {
+            ullRunTime += ullRunTimeCounter - ullSwitchedInAt[ xCoreID ];
+        }
+
+        return ullRunTime;
+    }
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+
+/* Pick which of the pending cores, listed in ascending order, yields next
+ * and record the choice in the schedule. */
+static BaseType_t prvScheduleChoose( const BaseType_t * pxPendingCores,
+                                     BaseType_t xNumPending )
+{
+    BaseType_t xChoice = 0;
+    BaseType_t i;
+
+    /* A single pending core is not a choice, keep schedules short. */
+    if( xNumPending == 1 )
+    {
+        return 0;
+    }
+
+    if( ulScheduleLength < ulScheduleForcedLength )
+    {
+        xChoice = ucScheduleForced[ ulScheduleLength ];
+        TEST_ASSERT_MESSAGE( xChoice < xNumPending, "Replayed schedule diverged from the recorded run" );
+    }
+    else if( eSchedulePolicy == eSmpScheduleRandom )
+    {
+        /* xorshift32 */
+        ulScheduleRandomState ^= ulScheduleRandomState << 13;
+        ulScheduleRandomState ^= ulScheduleRandomState >> 17;
+        ulScheduleRandomState ^= ulScheduleRandomState << 5;
+        xChoice = ( BaseType_t ) ( ulScheduleRandomState % ( uint32_t ) xNumPending );
+    }
+    else if( eSchedulePolicy == eSmpScheduleRoundRobin )
+    {
+        /* The first pending core after the one served last, wrapping around. */
+        for( i = 0; i < xNumPending; i++ )
+        {
+            if( pxPendingCores[ i ] > xScheduleLastCore )
+            {
+                xChoice = i;
+                break;
+            }
+        }
+    }
+
+    /* Long running tests outgrow the recording, they keep on scheduling
+     * but can no longer be replayed. */
+    if( ulScheduleLength < smpSCHEDULE_MAX_LENGTH )
+    {
+        ucScheduleChoices[ ulScheduleLength ] = ( uint8_t ) xChoice;
+        ucScheduleAlternatives[ ulScheduleLength ] = ( uint8_t ) xNumPending;
+        ulScheduleLength++;
+    }
+    else
+    {
+        xScheduleTruncated = pdTRUE;
+    }
+
+    return xChoice;
+}
+
+/* Switch the context of a core, charging the slice that ends to the core and
+ * to the task that ran it. */
+static void prvSwitchContext( BaseType_t xCoreID )
+{
+    #if ( configGENERATE_RUN_TIME_STATS == 1 )
+        TaskHandle_t xTask = xSwitchedInTask[ xCoreID ];
+        uint64_t ullSlice = ullRunTimeCounter - ullSwitchedInAt[ xCoreID ];
+
+        if( xTask != NULL )
+        {
+            if( prvIsIdleTask( xTask ) == pdTRUE )
+            {
+                xCoreRunTimeStats[ xCoreID ].ullIdleTime += ullSlice;
+            }
+            else
+            {
+                xCoreRunTimeStats[ xCoreID ].ullBusyTime += ullSlice;
+            }
+
+            prvFindTaskRunTime( xTask, pdTRUE )->ullRunTime[ xCoreID ] += ullSlice;
+        }
+    #endif /* configGENERATE_RUN_TIME_STATS */
+
+    vTaskSwitchContext( xCoreID );
+
+    #if ( configGENERATE_RUN_TIME_STATS == 1 )
+        xSwitchedInTask[ xCoreID ] = ( TaskHandle_t ) pxCurrentTCBs[ xCoreID ];
+        ullSwitchedInAt[ xCoreID ] = ullRunTimeCounter;
+    #endif
+}
+
+/* Service the pending core yields, in the order picked by the scheduling
+ * policy. eSmpScheduleAscending makes a single pass over the cores, so a
+ * yield pended on a core already passed waits for the next call. The other
+ * policies rebuild the pending set after each switch, as a switch may pend
+ * further yields. */
 static void vYieldCores( void )
 {
     BaseType_t i;
     BaseType_t xPreviousCoreId = xCurrentCoreId;
+    BaseType_t xPendingCores[ configNUMBER_OF_CORES ];
+    BaseType_t xNumPending;
+    BaseType_t xCoreID;
 
-    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    if( eSchedulePolicy == eSmpScheduleAscending )
+    {
+        for( i = 0; i < configNUMBER_OF_CORES; i++ )
+        {
+            if( xCoreYields[ i ] == pdTRUE )
+            {
+                xCurrentCoreId = i;
+                xCoreYields[ i ] = pdFALSE;
+                prvSwitchContext( i );
+            }
+        }
+
+        xCurrentCoreId = xPreviousCoreId;
+        return;
+    }
+
+    for( ; ; )
     {
-        if( xCoreYields[ i ] == pdTRUE )
+        xNumPending = 0;
+
+        for( i = 0; i < configNUMBER_OF_CORES; i++ )
         {
-            xCurrentCoreId = i;
-            xCoreYields[ i ] = pdFALSE;
-            vTaskSwitchContext( i );
+            if( xCoreYields[ i ] == pdTRUE )
+            {
+                xPendingCores[ xNumPending++ ] = i;
+            }
         }
+
+        if( xNumPending == 0 )
+        {
+            break;
+        }
+
+        xCoreID = xPendingCores[ prvScheduleChoose( xPendingCores, xNumPending ) ];
+        xScheduleLastCore = xCoreID;
+
+        xCurrentCoreId = xCoreID;
+        xCoreYields[ xCoreID ] = pdFALSE;
+        prvSwitchContext( xCoreID );
     }
     xCurrentCoreId = xPreviousCoreId;
 }
 
+/* Convert the choices taken so far into the replayable schedule string. */
+static const char * prvScheduleToString( void )
+{
+    static const char cHexDigits[] = "0123456789abcdef";
+    uint32_t i;
+
+    for( i = 0; i < ulScheduleLength; i++ )
+    {
+        cScheduleString[ i * 2U ] = cHexDigits[ ucScheduleChoices[ i ] >> 4 ];
+        cScheduleString[ ( i * 2U ) + 1U ] = cHexDigits[ ucScheduleChoices[ i ] & 0x0FU ];
+    }
+
+    cScheduleString[ ulScheduleLength * 2U ] = '\0';
+
+    return cScheduleString;
+}
+
+/* Move the forced choices on to the next schedule in depth first order:
+ * the deepest choice within ulDepth that has an alternative left is advanced
+ * and everything after it starts again from the first alternative. */
+static BaseType_t prvScheduleNextExhaustive( uint32_t ulDepth )
+{
+    uint32_t ulLength = ( ulScheduleLength < ulDepth ) ? ulScheduleLength : ulDepth;
+    uint32_t i;
+
+    while( ulLength > 0U )
+    {
+        i = ulLength - 1U;
+
+        if( ( ucScheduleChoices[ i ] + 1U ) < ucScheduleAlternatives[ i ] )
+        {
+            memcpy( ucScheduleForced, ucScheduleChoices, i );
+            ucScheduleForced[ i ] = ( uint8_t ) ( ucScheduleChoices[ i ] + 1U );
+            ulScheduleForcedLength = i + 1U;
+            return pdTRUE;
+        }
+
+        ulLength--;
+    }
+
+    return pdFALSE;
+}
+
+/* Account for an outermost lock acquisition and return the cycles spent
+ * spinning for the lock. */
+static uint64_t prvLockAcquired( uint64_t * pullAcquiredAt,
+                                 SmpLockStats_t * pxStats )
+{
+    uint64_t ullSpinCycles;
+
+    ullSpinCycles = ulLockSpinCycles;
+    ullCycleCounter += ullSpinCycles;
+    *pullAcquiredAt = ullCycleCounter;
+
+    #if ( configGENERATE_LOCK_STATS == 1 )
+    {
+        pxStats->ulAcquisitions++;
+        pxStats->ullTotalSpinCycles += ullSpinCycles;
+
+        if( ullSpinCycles > pxStats->ullMaxSpinCycles )
+        {
+            pxStats->ullMaxSpinCycles = ullSpinCycles;
+        }
+    }
+    #else
+    {
+        ( void ) pxStats;
+    }
+    #endif
+
+    return ullSpinCycles;
+}
+
+/* Account for an outermost lock release and return the cycles the lock was
+ * held for. */
+static uint64_t prvLockReleased( const uint64_t * pullAcquiredAt,
+                                 SmpLockStats_t * pxStats )
+{
+    uint64_t ullHoldCycles;
+
+    ullCycleCounter += ulLockHoldCycles;
+    ullHoldCycles = ullCycleCounter - *pullAcquiredAt;
+
+    #if ( configGENERATE_LOCK_STATS == 1 )
+    {
+        pxStats->ullTotalHoldCycles += ullHoldCycles;
+
+        if( ullHoldCycles > pxStats->ullMaxHoldCycles )
+        {
+            pxStats->ullMaxHoldCycles = ullHoldCycles;
+        }
+    }
+    #else
+    {
+        ( void ) pxStats;
+    }
+    #endif
+
+    return ullHoldCycles;
+}
+
+#if ( configGENERATE_LOCK_STATS == 1 )
+    #define smpTASK_LOCK_STATS( xCoreID )    ( &xTaskLockStats[ ( xCoreID ) ] )
+    #define smpISR_LOCK_STATS( xCoreID )     ( &xIsrLockStats[ ( xCoreID ) ] )
+#else
+    #define smpTASK_LOCK_STATS( xCoreID )    ( NULL )
+    #define smpISR_LOCK_STATS( xCoreID )     ( NULL )
+#endif
+
 unsigned int vFakePortGetCoreID( void )
 {
     return ( unsigned int )xCurrentCoreId;
@@ -214,6 +847,14 @@ void vFakePortGetISRLock( void )
         }
     }
 
+    if( xIsrLockCount[ xCurrentCoreId ] == 0 )
+    {
+        uint64_t ullSpinCycles = prvLockAcquired( &ullIsrLockAcquiredAt[ xCurrentCoreId ],
+                                                  smpISR_LOCK_STATS( xCurrentCoreId ) );
+        ( void ) ullSpinCycles;
+        traceISR_LOCK_ACQUIRED( ullSpinCycles );
+    }
+
     xIsrLockCount[ xCurrentCoreId ]++;
 }
 
@@ -221,6 +862,14 @@ void vFakePortReleaseISRLock( void )
 {
     TEST_ASSERT_MESSAGE( xIsrLockCount[ xCurrentCoreId ] > 0, "xIsrLockCount[ xCurrentCoreId ] <= 0" );
     xIsrLockCount[ xCurrentCoreId ]--;
+
+    if( xIsrLockCount[ xCurrentCoreId ] == 0 )
+    {
+        uint64_t ullHoldCycles = prvLockReleased( &ullIsrLockAcquiredAt[ xCurrentCoreId ],
+                                                  smpISR_LOCK_STATS( xCurrentCoreId ) );
+        ( void ) ullHoldCycles;
+        traceISR_LOCK_RELEASED( ullHoldCycles );
+    }
 }
 
 void vFakePortGetTaskLock( void )
@@ -237,6 +886,14 @@ void vFakePortGetTaskLock( void )
         }
     }
 
+    if( xTaskLockCount[ xCurrentCoreId ] == 0 )
+    {
+        uint64_t ullSpinCycles = prvLockAcquired( &ullTaskLockAcquiredAt[ xCurrentCoreId ],
+                                                  smpTASK_LOCK_STATS( xCurrentCoreId ) );
+        ( void ) ullSpinCycles;
+        traceTASK_LOCK_ACQUIRED( ullSpinCycles );
+    }
+
     xTaskLockCount[ xCurrentCoreId ]++;
 }
 
@@ -248,6 +905,11 @@ void vFakePortReleaseTaskLock( void )
     /* When releasing the ISR lock, check if any core is waiting to yield. */
     if( xTaskLockCount[ xCurrentCoreId ] == 0 )
     {
+        uint64_t ullHoldCycles = prvLockReleased( &ullTaskLockAcquiredAt[ xCurrentCoreId ],
+                                                  smpTASK_LOCK_STATS( xCurrentCoreId ) );
+        ( void ) ullHoldCycles;
+        traceTASK_LOCK_RELEASED( ullHoldCycles );
+
         vYieldCores();
     }
 }
@@ -292,6 +954,46 @@ void commonSetUp( void )
     ulFakePortSetInterruptMask_IgnoreAndReturn(0);
     vFakePortClearInterruptMask_Ignore();
 
+    prvResetHarnessState();
+
+    eSchedulePolicy = eSmpScheduleAscending;
+    ulScheduleRandomState = 1;
+    ulScheduleForcedLength = 0;
+    xExploring = pdFALSE;
+    ulNumExploreAllocations = 0;
+}
+
+void commonTearDown( void )
+{
+    uint32_t i;
+
+    /* A run failed part way through an exploration, print what is needed
+     * to replay it with vSmpScheduleReplay(). */
+    if( xExploring == pdTRUE )
+    {
+        UnityPrint( "Failing exploration run " );
+        UnityPrintNumberUnsigned( ulExploreRun );
+        UnityPrint( ", seed " );
+        UnityPrintNumberUnsigned( ulExploreSeed );
+        UnityPrint( ", schedule \"" );
+        UnityPrint( prvScheduleToString() );
+        UnityPrint( ( xScheduleTruncated == pdTRUE ) ? "\" (truncated)" : "\"" );
+        UNITY_PRINT_EOL();
+
+        for( i = 0; i < ulNumExploreAllocations; i++ )
+        {
+            unity_free( pvExploreAllocations[ i ] );
+        }
+
+        ulNumExploreAllocations = 0;
+        xExploring = pdFALSE;
+    }
+}
+
+/* Reset the kernel and harness state ahead of a test, or of an exploration
+ * run. */
+static void prvResetHarnessState( void )
+{
     memset( &pxReadyTasksLists, 0x00, configMAX_PRIORITIES * sizeof( List_t ) );
     memset( &xDelayedTaskList1, 0x00, sizeof( List_t ) );
     memset( &xDelayedTaskList2, 0x00, sizeof( List_t ) );
@@ -314,11 +1016,32 @@ void commonSetUp( void )
     xCurrentCoreId = 0;
     memset( xTaskLockCount, 0x00, sizeof( xTaskLockCount ) );
     memset( xIsrLockCount, 0x00, sizeof( xIsrLockCount ) );
-}
 
-void commonTearDown( void )
-{
+    ullCycleCounter = 0;
+    ulLockSpinCycles = 0;
+    ulLockHoldCycles = 0;
+    memset( ullTaskLockAcquiredAt, 0x00, sizeof( ullTaskLockAcquiredAt ) );
+    memset( ullIsrLockAcquiredAt, 0x00, sizeof( ullIsrLockAcquiredAt ) );
+
+    #if ( configGENERATE_LOCK_STATS == 1 )
+        memset( xTaskLockStats, 0x00, sizeof( xTaskLockStats ) );
+        memset( xIsrLockStats, 0x00, sizeof( xIsrLockStats ) );
+    #endif
+
+    #if ( configGENERATE_RUN_TIME_STATS == 1 )
+        memset( ulTaskSwitchedInTime, 0x00, sizeof( ulTaskSwitchedInTime ) );
+        memset( ( void * ) ulTotalRunTime, 0x00, sizeof( ulTotalRunTime ) );
+        ullRunTimeCounter = 0;
+        memset( xSwitchedInTask, 0x00, sizeof( xSwitchedInTask ) );
+        memset( ullSwitchedInAt, 0x00, sizeof( ullSwitchedInAt ) );
+        memset( xCoreRunTimeStats, 0x00, sizeof( xCoreRunTimeStats ) );
+        ulNumTaskRunTimes = 0;
+    #endif
 
+    memset( xCoreYields, 0x00, sizeof( xCoreYields ) );
+    xScheduleLastCore = -1;
+    ulScheduleLength = 0;
+    xScheduleTruncated = pdFALSE;
 }
 
 /* ==========================  Helper functions =========================== */
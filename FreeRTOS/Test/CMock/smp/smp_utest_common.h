@@ -32,6 +32,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdint.h>
 
 /* Test includes. */
 #include "unity.h"
@@ -42,6 +43,53 @@
 #include "task.h"
 #include "global_vars.h"
 
+/* Collect per-core lock statistics in the fake task and ISR locks. */
+#ifndef configGENERATE_LOCK_STATS
+    #define configGENERATE_LOCK_STATS    0
+#endif
+
+/**
+ * @brief Acquisition and timing statistics of one lock on one core. Times are
+ * measured in fake cycle counter ticks.
+ */
+typedef struct SmpLockStats
+{
+    uint32_t ulAcquisitions;     /**< Outermost acquisitions of the lock. */
+    uint64_t ullTotalSpinCycles; /**< Cycles spent waiting for the lock. */
+    uint64_t ullMaxSpinCycles;   /**< Longest single wait for the lock. */
+    uint64_t ullTotalHoldCycles; /**< Cycles the lock was held. */
+    uint64_t ullMaxHoldCycles;   /**< Longest single hold of the lock. */
+} SmpLockStats_t;
+
+/**
+ * @brief Run time of one core, in fake run time counter ticks, split between
+ * the idle tasks and every other task.
+ */
+typedef struct SmpCoreRunTimeStats
+{
+    uint64_t ullBusyTime; /**< Ticks spent running tasks other than idle tasks. */
+    uint64_t ullIdleTime; /**< Ticks spent running an idle task. */
+} SmpCoreRunTimeStats_t;
+
+/**
+ * @brief Scheduling policies choosing the order in which cores with a pending
+ * yield switch context, when a lock release leaves more than one pending.
+ */
+typedef enum
+{
+    eSmpScheduleAscending = 0, /**< One pass in core ID order, the default. */
+    eSmpScheduleRandom,        /**< Pseudo-random, from a seed. */
+    eSmpScheduleRoundRobin,    /**< First core after the one served last. */
+    eSmpScheduleExhaustive,    /**< Every schedule up to a depth, one per run. */
+    eSmpScheduleReplay         /**< The choices of a recorded schedule. */
+} eSmpSchedulePolicy;
+
+/**
+ * @brief Scenario run once per schedule by ulSmpScheduleExplore(). It starts
+ * from freshly reset kernel state and checks its results with TEST_ASSERTs.
+ */
+typedef void ( * SmpScenarioFunction_t )( void );
+
 /* ==========================  CALLBACK FUNCTIONS =========================== */
 
 /**
@@ -58,6 +106,13 @@ void * pvPortMalloc( size_t xSize );
  */
 void vPortFree( void * pv );
 
+/**
+ * @brief portYIELD_CORE() callback registered by commonSetUp(). Switches the
+ * core's context, or pends the switch while any core holds a lock.
+ */
+void vFakePortYieldCoreStubCallback( int xCoreID,
+                                     int cmock_num_calls );
+
 /* ==========================  Helper functions =========================== */
 
 /**
@@ -96,4 +151,104 @@ void xTaskIncrementTick_helper( void );
  */
 void vSetCurrentCore( BaseType_t xCoreID );
 
+/**
+ * @brief Select the scheduling policy for the rest of the test case.
+ * commonSetUp() selects eSmpScheduleAscending.
+ */
+void vSmpScheduleSetPolicy( eSmpSchedulePolicy ePolicy,
+                            uint32_t ulSeed );
+
+/**
+ * @brief Replay a schedule returned by pcSmpScheduleGet(), or printed when an
+ * exploration run fails.
+ */
+void vSmpScheduleReplay( const char * pcSchedule );
+
+/**
+ * @brief Get the choices taken so far by the current run, two hex digits per
+ * choice. The string is overwritten by the next call.
+ */
+const char * pcSmpScheduleGet( void );
+
+/**
+ * @brief Run pxScenario under ePolicy up to ulMaxRuns times, resetting the
+ * kernel and freeing its allocations between runs. eSmpScheduleExhaustive
+ * stops early once every schedule of the first ulDepth choices has run, and
+ * eSmpScheduleReplay runs once.
+ * @return The number of runs.
+ */
+uint32_t ulSmpScheduleExplore( SmpScenarioFunction_t pxScenario,
+                               eSmpSchedulePolicy ePolicy,
+                               uint32_t ulSeed,
+                               uint32_t ulMaxRuns,
+                               uint32_t ulDepth );
+
+/**
+ * @brief Read the fake cycle counter used to time the task and ISR locks
+ */
+uint64_t ullSmpGetCycleCounter( void );
+
+/**
+ * @brief Advance the fake cycle counter, e.g. while a test holds a lock
+ */
+void vSmpAdvanceCycleCounter( uint32_t ulCycles );
+
+/**
+ * @brief Set the cycles each outermost lock acquisition spins for and each
+ * outermost lock release adds to the hold time. Both are reset to 0 by
+ * commonSetUp().
+ */
+void vSmpSetLockCycleCosts( uint32_t ulSpinCycles,
+                            uint32_t ulHoldCycles );
+
+#if ( configGENERATE_LOCK_STATS == 1 )
+
+/**
+ * @brief Get the task and ISR lock statistics of a core. Either pointer may
+ * be NULL.
+ */
+    void vSmpGetLockStats( BaseType_t xCoreID,
+                           SmpLockStats_t * pxTaskLockStats,
+                           SmpLockStats_t * pxIsrLockStats );
+
+/**
+ * @brief Write the lock statistics of every core as a table, in the style of
+ * vTaskGetRunTimeStats(). One line per core and lock, tab separated:
+ * core, lock, acquisitions, total spin, max spin, total hold, max hold.
+ */
+    void vSmpGetLockStatsString( char * pcWriteBuffer,
+                                 size_t xBufferLength );
+
+#endif /* configGENERATE_LOCK_STATS */
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+/**
+ * @brief Set the fake run time counter read by portGET_RUN_TIME_COUNTER_VALUE().
+ * commonSetUp() sets it to 0.
+ */
+    void vSmpSetRunTimeCounter( uint64_t ullValue );
+
+/**
+ * @brief Advance the fake run time counter, i.e. let every core run its
+ * current task for ullTicks.
+ */
+    void vSmpAdvanceRunTimeCounter( uint64_t ullTicks );
+
+/**
+ * @brief Get the busy and idle time of a core, up to the current value of the
+ * run time counter. Nothing is allocated, so it may be sampled at any time.
+ */
+    void vSmpGetCoreRunTimeStats( BaseType_t xCoreID,
+                                  SmpCoreRunTimeStats_t * pxStats );
+
+/**
+ * @brief Get the time xTask has run on a core, up to the current value of the
+ * run time counter.
+ */
+    uint64_t ullSmpGetTaskCoreRunTime( TaskHandle_t xTask,
+                                       BaseType_t xCoreID );
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+
 #endif /* SMP_UTEST_COMMON_H */
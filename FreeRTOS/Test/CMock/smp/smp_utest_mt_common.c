@@ -0,0 +1,680 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file smp_utest_mt_common.c
+ *
+ * Real-thread alternative to smp_utest_common.c. Every simulated core is a
+ * host thread pinned to its own CPU, portGET_CORE_ID() is backed by thread
+ * local storage and the task and ISR locks are real recursive spinlocks, so
+ * suites linked against this file observe genuine contention between cores
+ * instead of a serialized replay. The port layer is implemented here with
+ * strong symbols which take precedence over the weak CMock generated ones,
+ * keeping the (non thread safe) mocks out of the paths the cores execute.
+ */
+
+/* pthread_setaffinity_np() and the CPU_SET macros are GNU extensions. */
+#ifndef _GNU_SOURCE
+    #define _GNU_SOURCE
+#endif
+
+#include "smp_utest_mt_common.h"
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+/* Test includes */
+#include "task.h"
+#include "global_vars.h"
+
+/* Unity includes. */
+#include "unity.h"
+#include "unity_memory.h"
+
+/* Mock includes. */
+#include "mock_fake_assert.h"
+#include "mock_fake_port.h"
+#include "mock_timers.h"
+
+/* ===========================  LOCAL DEFINITIONS  ========================== */
+
+/* Value of SmpMtLock_t.xOwner when no core holds the lock. */
+#define smpmtNO_OWNER                 ( ( BaseType_t ) -1 )
+
+/* Number of busy-wait iterations before a spinning core gives its host CPU
+ * away. This keeps configurations with more cores than host CPUs moving. */
+#define smpmtSPINS_BEFORE_YIELD       ( 1024U )
+
+/* When configCACHE_LINE_SIZE is set, the state of each core and each of the
+ * kernel locks are given cache lines of their own, so a core writing its own
+ * state does not invalidate the lines the other cores are working on. */
+#if ( configCACHE_LINE_SIZE > 0 )
+    #define smpmtCACHE_ALIGNED    __attribute__( ( aligned( configCACHE_LINE_SIZE ) ) )
+#else
+    #define smpmtCACHE_ALIGNED
+#endif
+
+/* Recursive spinlock shared by all cores. xNesting is only accessed by the
+ * owner of the lock. */
+typedef struct SmpMtLock
+{
+    BaseType_t xOwner;
+    BaseType_t xNesting;
+    uint32_t ulContended;
+} SmpMtLock_t;
+
+/* Port state of one simulated core. */
+typedef struct SmpMtCoreState
+{
+    /* Yield request raised by portYIELD_CORE(), delivered to the core as an
+     * interrupt. */
+    BaseType_t xYieldPending;
+
+    /* Interrupt mask state. Only written by the owning core. */
+    BaseType_t xInterruptsDisabled;
+} smpmtCACHE_ALIGNED SmpMtCoreState_t;
+
+/* ===========================  EXTERN VARIABLES  =========================== */
+
+extern List_t pxReadyTasksLists[ configMAX_PRIORITIES ];
+extern List_t xDelayedTaskList1;
+extern List_t xDelayedTaskList2;
+extern volatile UBaseType_t uxDeletedTasksWaitingCleanUp;
+extern volatile UBaseType_t uxCurrentNumberOfTasks;
+extern volatile TickType_t xTickCount;
+extern volatile UBaseType_t uxTopReadyPriority;
+extern volatile BaseType_t xSchedulerRunning;
+extern volatile TickType_t xPendedTicks;
+extern volatile BaseType_t xNumOfOverflows;
+extern volatile TickType_t xNextTaskUnblockTime;
+extern UBaseType_t uxTaskNumber;
+extern TaskHandle_t xIdleTaskHandles[configNUMBER_OF_CORES];
+extern volatile UBaseType_t uxSchedulerSuspended;
+extern List_t * volatile pxDelayedTaskList;
+extern volatile TCB_t *  pxCurrentTCBs[ configNUMBER_OF_CORES ];
+
+/* ============================  LOCAL VARIABLES  =========================== */
+
+/* portGET_CORE_ID() returns the core the calling host thread simulates. The
+ * test thread acts as core 0 unless vSetCurrentCore() says otherwise. */
+static __thread BaseType_t xThreadCoreId = 0;
+
+/* Set while the calling thread services a yield request, in which case it is
+ * executing in interrupt context as far as the kernel is concerned. */
+static __thread BaseType_t xThreadInISR = pdFALSE;
+
+static SmpMtLock_t xTaskLock smpmtCACHE_ALIGNED = { smpmtNO_OWNER, 0, 0 };
+static SmpMtLock_t xIsrLock smpmtCACHE_ALIGNED = { smpmtNO_OWNER, 0, 0 };
+
+static SmpMtCoreState_t xCoreStates[ configNUMBER_OF_CORES ] = { { 0 } };
+
+/* Set while vSmpMtRunCores() has core threads running. */
+static BaseType_t xCoresRunning = pdFALSE;
+
+/* First configASSERT() failure raised while the cores were running. */
+static uint32_t ulAssertFailures = 0;
+static char * pcAssertFile = NULL;
+static int iAssertLine = 0;
+
+/* unity_malloc() is not thread safe. */
+static pthread_mutex_t xMallocMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Start line for the core threads, so that all of them run concurrently. */
+static pthread_barrier_t xStartBarrier;
+
+typedef struct SmpMtCoreArgs
+{
+    BaseType_t xCoreID;
+    SmpMtCoreFunction_t pxCoreFunction;
+    uint32_t ulIterations;
+} SmpMtCoreArgs_t;
+
+/* ==========================  EXTERN FUNCTIONS  ========================== */
+
+extern void vTaskEnterCritical( void );
+extern void vTaskExitCritical( void );
+extern UBaseType_t vTaskEnterCriticalFromISR( void );
+extern void vTaskExitCriticalFromISR( UBaseType_t uxSavedInterruptStatus );
+
+/* ==========================  STATIC FUNCTIONS  ========================== */
+
+static void prvLockAcquire( SmpMtLock_t * pxLock )
+{
+    BaseType_t xExpected;
+    BaseType_t xContended = pdFALSE;
+    uint32_t ulSpins = 0;
+
+    /* The lock is recursive, only the owner can observe its own ID here. */
+    if( __atomic_load_n( &pxLock->xOwner, __ATOMIC_RELAXED ) == xThreadCoreId )
+    {
+        pxLock->xNesting++;
+        return;
+    }
+
+    for( ; ; )
+    {
+        xExpected = smpmtNO_OWNER;
+
+        if( __atomic_compare_exchange_n( &pxLock->xOwner, &xExpected, xThreadCoreId,
+                                         false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) )
+        {
+            break;
+        }
+
+        xContended = pdTRUE;
+
+        /* Spin on a plain load so the cache line stays shared until the
+         * owner releases the lock. */
+        while( __atomic_load_n( &pxLock->xOwner, __ATOMIC_RELAXED ) != smpmtNO_OWNER )
+        {
+            if( ( ++ulSpins % smpmtSPINS_BEFORE_YIELD ) == 0U )
+            {
+                sched_yield();
+            }
+        }
+    }
+
+    pxLock->xNesting = 1;
+
+    if( xContended == pdTRUE )
+    {
+        pxLock->ulContended++;
+    }
+}
+
+static void prvLockRelease( SmpMtLock_t * pxLock )
+{
+    if( __atomic_load_n( &pxLock->xOwner, __ATOMIC_RELAXED ) != xThreadCoreId )
+    {
+        vFakeAssert( false, __FILE__, __LINE__ );
+        return;
+    }
+
+    pxLock->xNesting--;
+
+    if( pxLock->xNesting == 0 )
+    {
+        __atomic_store_n( &pxLock->xOwner, smpmtNO_OWNER, __ATOMIC_RELEASE );
+    }
+}
+
+/* Deliver a pending yield request to the calling core, provided that the core
+ * currently accepts interrupts. */
+static void prvServicePendingYield( void )
+{
+    BaseType_t xCoreID = xThreadCoreId;
+
+    if( ( xCoreStates[ xCoreID ].xInterruptsDisabled == pdFALSE ) &&
+        ( xThreadInISR == pdFALSE ) &&
+        ( __atomic_exchange_n( &xCoreStates[ xCoreID ].xYieldPending, pdFALSE, __ATOMIC_ACQ_REL ) == pdTRUE ) )
+    {
+        xThreadInISR = pdTRUE;
+        vTaskSwitchContext( xCoreID );
+        xThreadInISR = pdFALSE;
+    }
+}
+
+static void prvSetInterruptMask( UBaseType_t uxDisabled )
+{
+    xCoreStates[ xThreadCoreId ].xInterruptsDisabled = ( BaseType_t ) uxDisabled;
+
+    if( uxDisabled == pdFALSE )
+    {
+        prvServicePendingYield();
+    }
+}
+
+static void * prvCoreThread( void * pvParameters )
+{
+    SmpMtCoreArgs_t * pxArgs = ( SmpMtCoreArgs_t * ) pvParameters;
+    cpu_set_t xCpuSet;
+    long lHostCpus = sysconf( _SC_NPROCESSORS_ONLN );
+    uint32_t i;
+
+    xThreadCoreId = pxArgs->xCoreID;
+    xThreadInISR = pdFALSE;
+
+    if( lHostCpus > 0 )
+    {
+        CPU_ZERO( &xCpuSet );
+        CPU_SET( ( int ) ( pxArgs->xCoreID % lHostCpus ), &xCpuSet );
+        /* Pinning is best effort, the test is still valid without it. */
+        ( void ) pthread_setaffinity_np( pthread_self(), sizeof( xCpuSet ), &xCpuSet );
+    }
+
+    pthread_barrier_wait( &xStartBarrier );
+
+    for( i = 0; i < pxArgs->ulIterations; i++ )
+    {
+        if( __atomic_load_n( &ulAssertFailures, __ATOMIC_RELAXED ) != 0U )
+        {
+            break;
+        }
+
+        prvServicePendingYield();
+        pxArgs->pxCoreFunction( xThreadCoreId, i );
+    }
+
+    return NULL;
+}
+
+/* ==========================  CALLBACK FUNCTIONS  ========================== */
+
+void * pvPortMalloc( size_t xSize )
+{
+    void * pvReturn;
+
+    pthread_mutex_lock( &xMallocMutex );
+    pvReturn = unity_malloc( xSize );
+    pthread_mutex_unlock( &xMallocMutex );
+
+    return pvReturn;
+}
+
+void vPortFree( void * pv )
+{
+    pthread_mutex_lock( &xMallocMutex );
+    unity_free( pv );
+    pthread_mutex_unlock( &xMallocMutex );
+}
+
+StackType_t * pxPortInitialiseStack( StackType_t * pxTopOfStack,
+                                     TaskFunction_t pxCode,
+                                     void * pvParameters )
+{
+    return pxTopOfStack;
+}
+
+BaseType_t xPortStartScheduler( void )
+{
+    BaseType_t xPreviousCoreId = xThreadCoreId;
+    BaseType_t i;
+
+    /* Initialize each core with a task. The first task on each core starts
+     * with interrupts enabled. */
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        xThreadCoreId = i;
+        vTaskSwitchContext( i );
+        xCoreStates[ i ].xInterruptsDisabled = pdFALSE;
+    }
+
+    xThreadCoreId = xPreviousCoreId;
+
+    return pdTRUE;
+}
+
+void vPortEndScheduler( void )
+{
+    return;
+}
+
+void vFakeAssert( bool x,
+                  char * file,
+                  int line )
+{
+    /* Outside of vSmpMtRunCores() the suites behave like the single threaded
+     * harness, which ignores assertions. */
+    if( ( x == false ) && ( __atomic_load_n( &xCoresRunning, __ATOMIC_ACQUIRE ) == pdTRUE ) )
+    {
+        if( __atomic_fetch_add( &ulAssertFailures, 1U, __ATOMIC_ACQ_REL ) == 0U )
+        {
+            pcAssertFile = file;
+            iAssertLine = line;
+        }
+    }
+}
+
+unsigned int vFakePortGetCoreID( void )
+{
+    return ( unsigned int ) xThreadCoreId;
+}
+
+void vSetCurrentCore( BaseType_t xCoreID )
+{
+    xThreadCoreId = xCoreID;
+}
+
+void vFakePortYield( void )
+{
+    vTaskSwitchContext( xThreadCoreId );
+}
+
+void vFakePortYieldWithinAPI( void )
+{
+    vFakePortYield();
+}
+
+void vFakePortYieldFromISR( void )
+{
+    /* Taken once the interrupt returns, i.e. when the mask is cleared. */
+    __atomic_store_n( &xCoreStates[ xThreadCoreId ].xYieldPending, pdTRUE, __ATOMIC_RELEASE );
+}
+
+void vFakePortYieldCore( int xCoreID )
+{
+    __atomic_store_n( &xCoreStates[ xCoreID ].xYieldPending, pdTRUE, __ATOMIC_RELEASE );
+
+    /* A core requesting its own yield takes it straight away if it can. */
+    if( xCoreID == xThreadCoreId )
+    {
+        prvServicePendingYield();
+    }
+}
+
+uint32_t vFakePortDisableInterrupts( void )
+{
+    uint32_t ulPrevious = ( uint32_t ) xCoreStates[ xThreadCoreId ].xInterruptsDisabled;
+
+    xCoreStates[ xThreadCoreId ].xInterruptsDisabled = pdTRUE;
+
+    return ulPrevious;
+}
+
+void vFakePortEnableInterrupts( void )
+{
+    prvSetInterruptMask( pdFALSE );
+}
+
+void vFakePortRestoreInterrupts( UBaseType_t uxSavedInterruptState )
+{
+    prvSetInterruptMask( uxSavedInterruptState );
+}
+
+UBaseType_t ulFakePortSetInterruptMaskFromISR( void )
+{
+    return ( UBaseType_t ) vFakePortDisableInterrupts();
+}
+
+void vFakePortClearInterruptMaskFromISR( UBaseType_t uxNewMaskValue )
+{
+    prvSetInterruptMask( uxNewMaskValue );
+}
+
+UBaseType_t ulFakePortSetInterruptMask( void )
+{
+    return ( UBaseType_t ) vFakePortDisableInterrupts();
+}
+
+void vFakePortClearInterruptMask( UBaseType_t uxNewMaskValue )
+{
+    prvSetInterruptMask( uxNewMaskValue );
+}
+
+void vFakePortAssertIfInterruptPriorityInvalid( void )
+{
+}
+
+void vFakePortAssertIfISR( void )
+{
+    if( xThreadInISR == pdTRUE )
+    {
+        vFakeAssert( false, __FILE__, __LINE__ );
+    }
+}
+
+BaseType_t vFakePortCheckIfInISR( void )
+{
+    return xThreadInISR;
+}
+
+void vPortCurrentTaskDying( void * pxTaskToDelete,
+                            volatile BaseType_t * pxPendYield )
+{
+}
+
+void portSetupTCB_CB( void * tcb )
+{
+}
+
+void vFakePortEnterCriticalSection( void )
+{
+    vTaskEnterCritical();
+}
+
+void vFakePortExitCriticalSection( void )
+{
+    vTaskExitCritical();
+}
+
+void vFakePortGetISRLock( void )
+{
+    prvLockAcquire( &xIsrLock );
+}
+
+void vFakePortReleaseISRLock( void )
+{
+    prvLockRelease( &xIsrLock );
+}
+
+void vFakePortGetTaskLock( void )
+{
+    prvLockAcquire( &xTaskLock );
+}
+
+void vFakePortReleaseTaskLock( void )
+{
+    prvLockRelease( &xTaskLock );
+}
+
+UBaseType_t vFakePortEnterCriticalFromISR( void )
+{
+    return vTaskEnterCriticalFromISR();
+}
+
+void vFakePortExitCriticalFromISR( UBaseType_t uxSavedInterruptState )
+{
+    vTaskExitCriticalFromISR( uxSavedInterruptState );
+}
+
+/* ============================= Unity Fixtures ============================= */
+
+void commonSetUp( void )
+{
+    xTimerCreateTimerTask_IgnoreAndReturn( 1 );
+
+    memset( &pxReadyTasksLists, 0x00, configMAX_PRIORITIES * sizeof( List_t ) );
+    memset( &xDelayedTaskList1, 0x00, sizeof( List_t ) );
+    memset( &xDelayedTaskList2, 0x00, sizeof( List_t ) );
+    memset( &xIdleTaskHandles, 0x00, ( configNUMBER_OF_CORES * sizeof( TaskHandle_t ) ) );
+    memset( &pxCurrentTCBs, 0x00, ( configNUMBER_OF_CORES * sizeof( TCB_t * ) ) );
+
+    uxDeletedTasksWaitingCleanUp = 0;
+    uxCurrentNumberOfTasks = ( UBaseType_t ) 0U;
+    xTickCount = ( TickType_t ) 500; /* configINITIAL_TICK_COUNT */
+    uxTopReadyPriority = tskIDLE_PRIORITY;
+    xSchedulerRunning = pdFALSE;
+    xPendedTicks = ( TickType_t ) 0U;
+    xNumOfOverflows = ( BaseType_t ) 0;
+    uxTaskNumber = ( UBaseType_t ) 0U;
+    xNextTaskUnblockTime = ( TickType_t ) 0U;
+    uxSchedulerSuspended = ( UBaseType_t ) 0;
+    pxDelayedTaskList = NULL;
+
+    xThreadCoreId = 0;
+    xThreadInISR = pdFALSE;
+    xTaskLock.xOwner = smpmtNO_OWNER;
+    xTaskLock.xNesting = 0;
+    xTaskLock.ulContended = 0;
+    xIsrLock.xOwner = smpmtNO_OWNER;
+    xIsrLock.xNesting = 0;
+    xIsrLock.ulContended = 0;
+    memset( xCoreStates, 0x00, sizeof( xCoreStates ) );
+    xCoresRunning = pdFALSE;
+    ulAssertFailures = 0;
+    pcAssertFile = NULL;
+    iAssertLine = 0;
+}
+
+void commonTearDown( void )
+{
+}
+
+/* ==========================  Helper functions =========================== */
+
+void vSmpTestTask( void * pvParameters )
+{
+}
+
+void verifySmpTask( TaskHandle_t * xTaskHandle,
+                    eTaskState eCurrentState,
+                    TaskRunning_t xTaskRunState )
+{
+    TaskStatus_t xTaskDetails;
+
+    vTaskGetInfo( *xTaskHandle, &xTaskDetails, pdTRUE, eInvalid );
+    TEST_ASSERT_EQUAL_INT_MESSAGE( xTaskRunState, xTaskDetails.xHandle->xTaskRunState, "Task Verification Failed: Incorrect xTaskRunState" );
+    TEST_ASSERT_EQUAL_INT_MESSAGE( eCurrentState, xTaskDetails.eCurrentState, "Task Verification Failed: Incorrect eCurrentState" );
+}
+
+void verifyIdleTask( BaseType_t index,
+                     TaskRunning_t xTaskRunState )
+{
+    TaskStatus_t xTaskDetails;
+    int ret;
+
+    vTaskGetInfo( xIdleTaskHandles[ index ], &xTaskDetails, pdTRUE, eInvalid );
+    ret = strncmp( xTaskDetails.xHandle->pcTaskName, "IDLE", 4 );
+    TEST_ASSERT_EQUAL_INT_MESSAGE( 0, ret, "Idle Task Verification Failed: Incorrect task name" );
+    TEST_ASSERT_EQUAL_INT_MESSAGE( pdTRUE, xTaskDetails.xHandle->uxTaskAttributes, "Idle Task Verification Failed: Incorrect xIsIdle" );
+    TEST_ASSERT_EQUAL_INT_MESSAGE( xTaskRunState, xTaskDetails.xHandle->xTaskRunState, "Idle Task Verification Failed: Incorrect xTaskRunState" );
+    TEST_ASSERT_EQUAL_INT_MESSAGE( eRunning, xTaskDetails.eCurrentState, "Idle Task Verification Failed: Incorrect eCurrentState" );
+}
+
+/* Helper function to simulate calling xTaskIncrementTick in critical section. */
+void xTaskIncrementTick_helper( void )
+{
+    BaseType_t xSwitchRequired;
+    UBaseType_t uxSavedInterruptState;
+
+    /* xTaskIncrementTick is called in ISR context. Use taskENTER/EXIT_CRITICAL_FROM_ISR
+     * here. */
+    uxSavedInterruptState = taskENTER_CRITICAL_FROM_ISR();
+
+    xSwitchRequired = xTaskIncrementTick();
+
+    /* Simulate context switch on the core which calls xTaskIncrementTick. */
+    if( xSwitchRequired == pdTRUE )
+    {
+        portYIELD_CORE( configTICK_CORE );
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptState );
+}
+
+void vSmpMtRunCores( SmpMtCoreFunction_t pxCoreFunction,
+                     uint32_t ulIterations )
+{
+    pthread_t xThreads[ configNUMBER_OF_CORES ];
+    SmpMtCoreArgs_t xArgs[ configNUMBER_OF_CORES ];
+    BaseType_t i;
+    int iRet;
+
+    xTaskLock.ulContended = 0;
+    xIsrLock.ulContended = 0;
+    __atomic_store_n( &xCoresRunning, pdTRUE, __ATOMIC_RELEASE );
+
+    iRet = pthread_barrier_init( &xStartBarrier, NULL, configNUMBER_OF_CORES );
+    TEST_ASSERT_EQUAL_INT_MESSAGE( 0, iRet, "pthread_barrier_init failed" );
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        xArgs[ i ].xCoreID = i;
+        xArgs[ i ].pxCoreFunction = pxCoreFunction;
+        xArgs[ i ].ulIterations = ulIterations;
+        iRet = pthread_create( &xThreads[ i ], NULL, prvCoreThread, &xArgs[ i ] );
+        TEST_ASSERT_EQUAL_INT_MESSAGE( 0, iRet, "pthread_create failed" );
+    }
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        pthread_join( xThreads[ i ], NULL );
+    }
+
+    pthread_barrier_destroy( &xStartBarrier );
+
+    /* Service the yields that were requested after their target core finished
+     * its last iteration, so that the scheduler state is settled. */
+    vSmpMtDrainPendingYields();
+
+    __atomic_store_n( &xCoresRunning, pdFALSE, __ATOMIC_RELEASE );
+
+    if( ulAssertFailures != 0U )
+    {
+        UnityPrint( "configASSERT() failed at " );
+        UnityPrint( pcAssertFile );
+        UnityPrint( ":" );
+        UnityPrintNumber( iAssertLine );
+        UNITY_PRINT_EOL();
+    }
+
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE( 0, ulAssertFailures, "configASSERT() failed while the cores were running" );
+    TEST_ASSERT_EQUAL_INT_MESSAGE( smpmtNO_OWNER, xTaskLock.xOwner, "Task lock still held after the cores stopped" );
+    TEST_ASSERT_EQUAL_INT_MESSAGE( smpmtNO_OWNER, xIsrLock.xOwner, "ISR lock still held after the cores stopped" );
+}
+
+void vSmpMtDrainPendingYields( void )
+{
+    BaseType_t xPreviousCoreId = xThreadCoreId;
+    BaseType_t i;
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        xThreadCoreId = i;
+        prvServicePendingYield();
+    }
+
+    xThreadCoreId = xPreviousCoreId;
+}
+
+void verifySmpMtRunningTasks( void )
+{
+    BaseType_t i, j;
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        TEST_ASSERT_NOT_NULL_MESSAGE( pxCurrentTCBs[ i ], "Core without a current task" );
+        TEST_ASSERT_EQUAL_INT_MESSAGE( i, pxCurrentTCBs[ i ]->xTaskRunState, "Current task has an incorrect xTaskRunState" );
+
+        for( j = i + 1; j < configNUMBER_OF_CORES; j++ )
+        {
+            TEST_ASSERT_MESSAGE( pxCurrentTCBs[ i ] != pxCurrentTCBs[ j ], "Task running on more than one core" );
+        }
+    }
+}
+
+uint32_t ulSmpMtGetTaskLockContention( void )
+{
+    return xTaskLock.ulContended;
+}
+
+uint32_t ulSmpMtGetISRLockContention( void )
+{
+    return xIsrLock.ulContended;
+}
@@ -0,0 +1,87 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file smp_utest_mt_common.h */
+
+#ifndef SMP_UTEST_MT_COMMON_H
+#define SMP_UTEST_MT_COMMON_H
+
+/* The real-thread harness implements every helper declared for the
+ * single-threaded harness, so suites can use both sets of helpers. */
+#include "smp_utest_common.h"
+
+/* ===========================  TYPE DEFINITIONS  =========================== */
+
+/**
+ * @brief Work executed by a simulated core on each iteration.
+ * @param xCoreID the ID of the core calling the function, also returned by
+ * portGET_CORE_ID() on the calling thread.
+ * @param ulIteration the zero based iteration count on this core.
+ */
+typedef void ( * SmpMtCoreFunction_t )( BaseType_t xCoreID,
+                                        uint32_t ulIteration );
+
+/* ==========================  Helper functions =========================== */
+
+/**
+ * @brief Run configNUMBER_OF_CORES host threads, one per simulated core.
+ *
+ * Each thread is pinned to its own host CPU (modulo the number of online
+ * CPUs), takes its core ID from thread local storage and calls
+ * pxCoreFunction ulIterations times. Cross core yields requested with
+ * portYIELD_CORE() are delivered to the target thread as an interrupt the
+ * next time that core has interrupts enabled. The call returns once every
+ * thread has been joined and all still pending yields have been serviced.
+ * Any configASSERT() failure raised while the cores were running fails the
+ * current test.
+ */
+void vSmpMtRunCores( SmpMtCoreFunction_t pxCoreFunction,
+                     uint32_t ulIterations );
+
+/**
+ * @brief Service, in ascending core order, every yield request that is still
+ * pending. Used from the test thread while no core thread is running.
+ */
+void vSmpMtDrainPendingYields( void );
+
+/**
+ * @brief Verify that each core runs exactly one task and that no task is
+ * marked as running on more than one core.
+ */
+void verifySmpMtRunningTasks( void );
+
+/**
+ * @brief Return the number of task lock acquisitions that had to spin
+ * because another core held the lock during the last vSmpMtRunCores().
+ */
+uint32_t ulSmpMtGetTaskLockContention( void );
+
+/**
+ * @brief Return the number of ISR lock acquisitions that had to spin
+ * because another core held the lock during the last vSmpMtRunCores().
+ */
+uint32_t ulSmpMtGetISRLockContention( void );
+
+#endif /* SMP_UTEST_MT_COMMON_H */
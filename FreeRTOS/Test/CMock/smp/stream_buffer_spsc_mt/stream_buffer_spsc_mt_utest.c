@@ -0,0 +1,352 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file stream_buffer_spsc_mt_utest.c
+ *
+ * A stream buffer has one writer and one reader. These tests run the writer
+ * and the reader on their own cores, each on its own host thread, and check
+ * that no byte or message is lost, duplicated or reordered while the buffer
+ * wraps. The remaining cores yield concurrently so the task lock is contended.
+ * Every send and receive goes through the existing stream_buffer.c paths,
+ * which suspend the scheduler; there is no lock-free path to test.
+ */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Task includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "stream_buffer.h"
+#include "message_buffer.h"
+
+/* Test includes. */
+#include "unity.h"
+#include "unity_memory.h"
+#include "../global_vars.h"
+#include "../smp_utest_mt_common.h"
+
+/* Mock includes. */
+#include "mock_timers.h"
+#include "mock_fake_assert.h"
+#include "mock_fake_port.h"
+
+/* ===========================  LOCAL DEFINITIONS  ========================== */
+
+/* Number of iterations executed by each core thread. */
+#define spscITERATIONS        ( 20000U )
+
+/* Prime, so successive writes and reads wrap at every offset of the buffer. */
+#define spscBUFFER_SIZE       ( 97U )
+
+/* Largest number of bytes written or read by a single call. */
+#define spscMAX_CHUNK         ( 13U )
+
+/* Byte n of the stream has the value n % spscSEQUENCE_PERIOD.  The period is
+ * prime and does not divide the buffer size, so a lost or repeated chunk can
+ * not go unnoticed. */
+#define spscSEQUENCE_PERIOD   ( 251U )
+
+#define spscPRODUCER_CORE     ( 0 )
+#define spscCONSUMER_CORE     ( 1 )
+
+/* ============================  LOCAL VARIABLES  =========================== */
+
+static StreamBufferHandle_t xStreamBuffer = NULL;
+static MessageBufferHandle_t xMessageBuffer = NULL;
+
+/* Only accessed by the producer core. */
+static uint32_t ulSent = 0;
+
+/* Only accessed by the consumer core, then by the test once the cores stop. */
+static uint32_t ulReceived = 0;
+static uint32_t ulSequenceErrors = 0;
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    commonSetUp();
+    xStreamBuffer = NULL;
+    xMessageBuffer = NULL;
+    ulSent = 0;
+    ulReceived = 0;
+    ulSequenceErrors = 0;
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+    if( xStreamBuffer != NULL )
+    {
+        vStreamBufferDelete( xStreamBuffer );
+    }
+
+    if( xMessageBuffer != NULL )
+    {
+        vMessageBufferDelete( xMessageBuffer );
+    }
+
+    commonTearDown();
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+
+/* =============================  HELPER FUNCTIONS  ========================= */
+
+/* Check received bytes continue the sequence, counting every mismatch. */
+static void prvCheckStreamBytes( const uint8_t * pucData,
+                                 size_t xLength )
+{
+    size_t i;
+
+    for( i = 0; i < xLength; i++ )
+    {
+        if( pucData[ i ] != ( uint8_t ) ( ulReceived % spscSEQUENCE_PERIOD ) )
+        {
+            ulSequenceErrors++;
+        }
+
+        ulReceived++;
+    }
+}
+
+/* Message n is 1 + ( n % spscMAX_CHUNK ) bytes long, byte i holding n + i. */
+static size_t prvBuildMessage( uint32_t ulMessage,
+                               uint8_t * pucData )
+{
+    size_t i, xLength = 1U + ( ulMessage % spscMAX_CHUNK );
+
+    for( i = 0; i < xLength; i++ )
+    {
+        pucData[ i ] = ( uint8_t ) ( ulMessage + i );
+    }
+
+    return xLength;
+}
+
+static void prvCheckMessage( const uint8_t * pucData,
+                             size_t xLength )
+{
+    uint8_t ucExpected[ spscMAX_CHUNK ];
+    size_t xExpectedLength = prvBuildMessage( ulReceived, ucExpected );
+
+    if( ( xLength != xExpectedLength ) || ( memcmp( pucData, ucExpected, xLength ) != 0 ) )
+    {
+        ulSequenceErrors++;
+    }
+
+    ulReceived++;
+}
+
+/* Cores other than the producer and the consumer keep the task lock busy. */
+static void prvContendTaskLock( BaseType_t xCoreID,
+                                uint32_t ulIteration )
+{
+    ( void ) xCoreID;
+
+    if( ( ulIteration & 1U ) == 0U )
+    {
+        taskYIELD();
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        taskEXIT_CRITICAL();
+    }
+}
+
+static void prvStreamCoreFunction( BaseType_t xCoreID,
+                                   uint32_t ulIteration )
+{
+    uint8_t ucData[ spscMAX_CHUNK ];
+    size_t i, xLength;
+
+    if( xCoreID == spscPRODUCER_CORE )
+    {
+        xLength = 1U + ( ulIteration % spscMAX_CHUNK );
+
+        for( i = 0; i < xLength; i++ )
+        {
+            ucData[ i ] = ( uint8_t ) ( ( ulSent + i ) % spscSEQUENCE_PERIOD );
+        }
+
+        /* Never blocks, so a full buffer accepts only part of the chunk. */
+        ulSent += ( uint32_t ) xStreamBufferSend( xStreamBuffer, ucData, xLength, 0 );
+    }
+    else if( xCoreID == spscCONSUMER_CORE )
+    {
+        /* Read sizes that differ from the write sizes, so reads straddle
+         * writes. */
+        xLength = xStreamBufferReceive( xStreamBuffer, ucData, 1U + ( ( ulIteration * 7U ) % spscMAX_CHUNK ), 0 );
+        prvCheckStreamBytes( ucData, xLength );
+    }
+    else
+    {
+        prvContendTaskLock( xCoreID, ulIteration );
+    }
+}
+
+static void prvMessageCoreFunction( BaseType_t xCoreID,
+                                    uint32_t ulIteration )
+{
+    uint8_t ucData[ spscMAX_CHUNK ];
+    size_t xLength;
+
+    if( xCoreID == spscPRODUCER_CORE )
+    {
+        xLength = prvBuildMessage( ulSent, ucData );
+
+        /* A message is written whole or not at all. */
+        if( xMessageBufferSend( xMessageBuffer, ucData, xLength, 0 ) == xLength )
+        {
+            ulSent++;
+        }
+    }
+    else if( xCoreID == spscCONSUMER_CORE )
+    {
+        xLength = xMessageBufferReceive( xMessageBuffer, ucData, sizeof( ucData ), 0 );
+
+        if( xLength > 0U )
+        {
+            prvCheckMessage( ucData, xLength );
+        }
+    }
+    else
+    {
+        prvContendTaskLock( xCoreID, ulIteration );
+    }
+}
+
+/* Only the producer and the consumer run, neither of which ever blocks. */
+static void prvUncontendedStreamCoreFunction( BaseType_t xCoreID,
+                                              uint32_t ulIteration )
+{
+    if( ( xCoreID == spscPRODUCER_CORE ) || ( xCoreID == spscCONSUMER_CORE ) )
+    {
+        prvStreamCoreFunction( xCoreID, ulIteration );
+    }
+}
+
+/* Receive whatever is left in the stream buffer once the cores have stopped. */
+static void prvDrainStreamBuffer( void )
+{
+    uint8_t ucData[ spscMAX_CHUNK ];
+    size_t xLength;
+
+    do
+    {
+        xLength = xStreamBufferReceive( xStreamBuffer, ucData, sizeof( ucData ), 0 );
+        prvCheckStreamBytes( ucData, xLength );
+    } while( xLength > 0U );
+}
+
+/* ==============================  Test Cases  ============================== */
+
+/**
+ * @brief The producer core writes a numbered byte stream in chunks of varying
+ * size while the consumer core reads it back in chunks of other sizes, and the
+ * other cores contend for the task lock. Every byte written must be read back
+ * once, in order.
+ */
+void test_mt_stream_buffer_spsc_no_lost_or_duplicated_bytes( void )
+{
+    vTaskStartScheduler();
+
+    xStreamBuffer = xStreamBufferCreate( spscBUFFER_SIZE, 1 );
+    TEST_ASSERT_NOT_NULL( xStreamBuffer );
+
+    vSmpMtRunCores( prvStreamCoreFunction, spscITERATIONS );
+
+    prvDrainStreamBuffer();
+
+    TEST_ASSERT_EQUAL_UINT32( 0, ulSequenceErrors );
+    TEST_ASSERT_EQUAL_UINT32( ulSent, ulReceived );
+    TEST_ASSERT_GREATER_THAN_UINT32( spscBUFFER_SIZE, ulSent );
+    TEST_ASSERT_EQUAL( pdTRUE, xStreamBufferIsEmpty( xStreamBuffer ) );
+    verifySmpMtRunningTasks();
+}
+
+/**
+ * @brief As above for a message buffer. Every message written must be read
+ * back once, in order, with its length and contents intact.
+ */
+void test_mt_message_buffer_spsc_no_lost_or_torn_messages( void )
+{
+    uint8_t ucData[ spscMAX_CHUNK ];
+    size_t xLength;
+
+    vTaskStartScheduler();
+
+    xMessageBuffer = xMessageBufferCreate( spscBUFFER_SIZE );
+    TEST_ASSERT_NOT_NULL( xMessageBuffer );
+
+    vSmpMtRunCores( prvMessageCoreFunction, spscITERATIONS );
+
+    while( ( xLength = xMessageBufferReceive( xMessageBuffer, ucData, sizeof( ucData ), 0 ) ) > 0U )
+    {
+        prvCheckMessage( ucData, xLength );
+    }
+
+    TEST_ASSERT_EQUAL_UINT32( 0, ulSequenceErrors );
+    TEST_ASSERT_EQUAL_UINT32( ulSent, ulReceived );
+    TEST_ASSERT_GREATER_THAN_UINT32( 0, ulSent );
+    TEST_ASSERT_EQUAL( pdTRUE, xMessageBufferIsEmpty( xMessageBuffer ) );
+    verifySmpMtRunningTasks();
+}
+
+/**
+ * @brief Only the producer and consumer cores run, so the two race each other
+ * on the buffer indexes without the other cores delaying either one. Every
+ * byte written must still be read back once, in order.
+ */
+void test_mt_stream_buffer_spsc_producer_consumer_only( void )
+{
+    vTaskStartScheduler();
+
+    xStreamBuffer = xStreamBufferCreate( spscBUFFER_SIZE, 1 );
+    TEST_ASSERT_NOT_NULL( xStreamBuffer );
+
+    vSmpMtRunCores( prvUncontendedStreamCoreFunction, spscITERATIONS );
+
+    prvDrainStreamBuffer();
+
+    TEST_ASSERT_EQUAL_UINT32( 0, ulSequenceErrors );
+    TEST_ASSERT_EQUAL_UINT32( ulSent, ulReceived );
+    TEST_ASSERT_GREATER_THAN_UINT32( spscBUFFER_SIZE, ulSent );
+    TEST_ASSERT_EQUAL( pdTRUE, xStreamBufferIsEmpty( xStreamBuffer ) );
+}
@@ -0,0 +1,485 @@
+/*
+ * FreeRTOS V202012.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file tickless_utest.c */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Task includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "event_groups.h"
+#include "queue.h"
+
+/* Test includes. */
+#include "unity.h"
+#include "unity_memory.h"
+#include "../global_vars.h"
+#include "../smp_utest_common.h"
+
+/* Mock includes. */
+#include "mock_timers.h"
+#include "mock_fake_assert.h"
+#include "mock_fake_port.h"
+
+/* ===========================  EXTERN VARIABLES  =========================== */
+
+extern volatile TCB_t *  pxCurrentTCBs[ configNUMBER_OF_CORES ];
+extern volatile TickType_t xTickCount;
+
+/* ===========================  EXTERN FUNCTIONS  =========================== */
+
+extern TickType_t prvGetExpectedIdleTime( void );
+
+/* ===========================  STATIC VARIABLES  =========================== */
+
+/* Fake timer. xFakeTime counts the ticks that really elapsed, whether or not
+ * any core took a tick interrupt for them. */
+static TickType_t xFakeTime;
+
+/* Per core timer state. A sleeping core takes no tick interrupts. A core with
+ * a wake time of portMAX_DELAY sleeps until another core yields it. */
+static BaseType_t xCoreSleeping[ configNUMBER_OF_CORES ];
+static TickType_t xCoreSleepStart[ configNUMBER_OF_CORES ];
+static TickType_t xCoreWakeTime[ configNUMBER_OF_CORES ];
+
+/* What the fake timer reports: wakeups from sleep and tick interrupts taken. */
+static uint32_t ulCoreWakeups[ configNUMBER_OF_CORES ];
+static uint32_t ulCoreTicks[ configNUMBER_OF_CORES ];
+
+/* ===========================  Helper functions  =========================== */
+
+/* Wake a sleeping core. The tick core catches the tick count up with the time
+ * it slept through, less the tick that fires its timer. */
+static void prvWakeCore( BaseType_t xCoreID,
+                         BaseType_t xTimerExpired )
+{
+    TickType_t xSleptTicks = xFakeTime - xCoreSleepStart[ xCoreID ];
+
+    xCoreSleeping[ xCoreID ] = pdFALSE;
+    xCoreWakeTime[ xCoreID ] = portMAX_DELAY;
+    ulCoreWakeups[ xCoreID ]++;
+
+    if( xCoreID == configTICK_CORE )
+    {
+        vTaskStepTick( ( xTimerExpired == pdTRUE ) ? ( xSleptTicks - 1U ) : xSleptTicks );
+    }
+}
+
+/* portYIELD_CORE() is an inter-core interrupt, which wakes a sleeping core. */
+static void prvYieldCoreStub( int xCoreID,
+                              int cmock_num_calls )
+{
+    if( xCoreSleeping[ xCoreID ] == pdTRUE )
+    {
+        prvWakeCore( xCoreID, pdFALSE );
+    }
+
+    vFakePortYieldCoreStubCallback( xCoreID, cmock_num_calls );
+}
+
+/* portSUPPRESS_TICKS_AND_SLEEP() of the fake port. Only the tick core keeps
+ * time, so only it programs a wake time. The other cores sleep until they are
+ * given a task to run. */
+void vFakePortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+{
+    BaseType_t xCoreID = ( BaseType_t ) portGET_CORE_ID();
+    eSleepModeStatus eSleepStatus;
+
+    eSleepStatus = eTaskConfirmSleepModeStatus();
+
+    if( eSleepStatus != eAbortSleep )
+    {
+        xCoreSleeping[ xCoreID ] = pdTRUE;
+        xCoreSleepStart[ xCoreID ] = xFakeTime;
+
+        if( ( xCoreID == configTICK_CORE ) && ( eSleepStatus == eStandardSleep ) )
+        {
+            xCoreWakeTime[ xCoreID ] = xFakeTime + xExpectedIdleTime;
+        }
+        else
+        {
+            xCoreWakeTime[ xCoreID ] = portMAX_DELAY;
+        }
+    }
+}
+
+/**
+ * @brief Run the tickless section of the idle task on a core, as prvIdleTask
+ * does. The tick core sleeps for the kernel's expected idle time, the other
+ * cores regardless of it.
+ * @return pdTRUE if the core went to sleep.
+ */
+static BaseType_t prvIdleCore( BaseType_t xCoreID )
+{
+    TickType_t xExpectedIdleTime;
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE( pdTRUE, pxCurrentTCBs[ xCoreID ]->uxTaskAttributes, "Only a core running its idle task may sleep" );
+
+    vSetCurrentCore( xCoreID );
+
+    vTaskSuspendAll();
+    {
+        if( xCoreID == configTICK_CORE )
+        {
+            xExpectedIdleTime = prvGetExpectedIdleTime();
+        }
+        else
+        {
+            xExpectedIdleTime = portMAX_DELAY;
+        }
+
+        if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+        {
+            portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime );
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    vSetCurrentCore( 0 );
+
+    return xCoreSleeping[ xCoreID ];
+}
+
+/* Let xTicks ticks elapse. Cores awake at the start of a tick take its
+ * interrupt, and the tick core's interrupt increments the tick count. */
+static void prvAdvanceTime( TickType_t xTicks )
+{
+    BaseType_t xAwake[ configNUMBER_OF_CORES ];
+    BaseType_t x;
+    TickType_t i;
+
+    for( i = 0; i < xTicks; i++ )
+    {
+        xFakeTime++;
+
+        for( x = 0; x < configNUMBER_OF_CORES; x++ )
+        {
+            xAwake[ x ] = ( xCoreSleeping[ x ] == pdTRUE ) ? pdFALSE : pdTRUE;
+        }
+
+        if( ( xCoreSleeping[ configTICK_CORE ] == pdTRUE ) &&
+            ( xCoreWakeTime[ configTICK_CORE ] == xFakeTime ) )
+        {
+            prvWakeCore( configTICK_CORE, pdTRUE );
+            xAwake[ configTICK_CORE ] = pdTRUE;
+        }
+
+        for( x = 0; x < configNUMBER_OF_CORES; x++ )
+        {
+            if( xAwake[ x ] == pdTRUE )
+            {
+                ulCoreTicks[ x ]++;
+            }
+        }
+
+        if( xAwake[ configTICK_CORE ] == pdTRUE )
+        {
+            vSetCurrentCore( configTICK_CORE );
+            xTaskIncrementTick_helper();
+            vSetCurrentCore( 0 );
+        }
+    }
+}
+
+/* Block the task running on a core for xTicks. */
+static void prvDelayTask( BaseType_t xCoreID,
+                          TickType_t xTicks )
+{
+    vSetCurrentCore( xCoreID );
+    vTaskDelay( xTicks );
+    vSetCurrentCore( 0 );
+}
+
+/* Create a priority 1 task for every core and start the scheduler. */
+static void prvStartTasks( TaskHandle_t * pxTaskHandles )
+{
+    uint32_t i;
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL, 1, &pxTaskHandles[ i ] );
+    }
+
+    vTaskStartScheduler();
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        verifySmpTask( &pxTaskHandles[ i ], eRunning, i );
+    }
+}
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    BaseType_t x;
+
+    commonSetUp();
+
+    vFakePortYieldCore_StubWithCallback( prvYieldCoreStub );
+
+    xFakeTime = 0;
+
+    for( x = 0; x < configNUMBER_OF_CORES; x++ )
+    {
+        xCoreSleeping[ x ] = pdFALSE;
+        xCoreSleepStart[ x ] = 0;
+        xCoreWakeTime[ x ] = portMAX_DELAY;
+        ulCoreWakeups[ x ] = 0;
+        ulCoreTicks[ x ] = 0;
+    }
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+    commonTearDown();
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+
+/* ==============================  Test Cases  ============================== */
+
+/**
+ * @brief Without tickless idle every core takes every tick, idle or not. This
+ * is the baseline the other test cases improve on.
+ */
+void test_tickless_not_suppressed_every_core_ticks( void )
+{
+    TaskHandle_t xTaskHandles[ configNUMBER_OF_CORES ] = { NULL };
+    BaseType_t x;
+
+    prvStartTasks( xTaskHandles );
+
+    for( x = 0; x < configNUMBER_OF_CORES; x++ )
+    {
+        prvDelayTask( x, 1000 );
+        verifyIdleTask( x, x );
+    }
+
+    prvAdvanceTime( 100 );
+
+    for( x = 0; x < configNUMBER_OF_CORES; x++ )
+    {
+        TEST_ASSERT_EQUAL_UINT32( 100, ulCoreTicks[ x ] );
+        TEST_ASSERT_EQUAL_UINT32( 0, ulCoreWakeups[ x ] );
+    }
+}
+
+/**
+ * @brief With every core idle, no core takes a tick until the next task
+ * unblocks. The tick core then wakes on its timer with the tick count caught
+ * up, and the other cores are woken to run the unblocked tasks.
+ */
+void test_tickless_all_cores_idle( void )
+{
+    TaskHandle_t xTaskHandles[ configNUMBER_OF_CORES ] = { NULL };
+    TickType_t xStartTickCount = xTickCount;
+    BaseType_t x;
+
+    prvStartTasks( xTaskHandles );
+
+    for( x = 0; x < configNUMBER_OF_CORES; x++ )
+    {
+        prvDelayTask( x, 1000 );
+    }
+
+    for( x = 0; x < configNUMBER_OF_CORES; x++ )
+    {
+        TEST_ASSERT_EQUAL( pdTRUE, prvIdleCore( x ) );
+    }
+
+    TEST_ASSERT_EQUAL( xFakeTime + 1000, xCoreWakeTime[ configTICK_CORE ] );
+
+    prvAdvanceTime( 999 );
+
+    for( x = 0; x < configNUMBER_OF_CORES; x++ )
+    {
+        TEST_ASSERT_EQUAL( pdTRUE, xCoreSleeping[ x ] );
+        TEST_ASSERT_EQUAL_UINT32( 0, ulCoreTicks[ x ] );
+        TEST_ASSERT_EQUAL_UINT32( 0, ulCoreWakeups[ x ] );
+    }
+
+    prvAdvanceTime( 1 );
+
+    TEST_ASSERT_EQUAL( xStartTickCount + 1000, xTickCount );
+    TEST_ASSERT_EQUAL_UINT32( 1, ulCoreTicks[ configTICK_CORE ] );
+
+    for( x = 0; x < configNUMBER_OF_CORES; x++ )
+    {
+        TEST_ASSERT_EQUAL( pdFALSE, xCoreSleeping[ x ] );
+        TEST_ASSERT_EQUAL_UINT32( 1, ulCoreWakeups[ x ] );
+        TEST_ASSERT_NOT_EQUAL( pdTRUE, pxCurrentTCBs[ x ]->uxTaskAttributes );
+
+        if( x != configTICK_CORE )
+        {
+            TEST_ASSERT_EQUAL_UINT32( 0, ulCoreTicks[ x ] );
+        }
+    }
+}
+
+/**
+ * @brief When a single task unblocks, only the core chosen to run it is woken.
+ */
+void test_tickless_wakes_only_cores_that_need_to_run( void )
+{
+    TaskHandle_t xTaskHandles[ configNUMBER_OF_CORES ] = { NULL };
+    BaseType_t xRunningCore;
+    BaseType_t x;
+
+    prvStartTasks( xTaskHandles );
+
+    for( x = 0; x < configNUMBER_OF_CORES; x++ )
+    {
+        prvDelayTask( x, ( x == 2 ) ? 10 : 1000 );
+    }
+
+    for( x = 0; x < configNUMBER_OF_CORES; x++ )
+    {
+        TEST_ASSERT_EQUAL( pdTRUE, prvIdleCore( x ) );
+    }
+
+    prvAdvanceTime( 10 );
+
+    verifySmpTask( &xTaskHandles[ 2 ], eRunning, xTaskHandles[ 2 ]->xTaskRunState );
+    xRunningCore = xTaskHandles[ 2 ]->xTaskRunState;
+    TEST_ASSERT_TRUE( ( xRunningCore >= 0 ) && ( xRunningCore < configNUMBER_OF_CORES ) );
+
+    /* The tick core woke on its timer, and at most one other core for T2. */
+    TEST_ASSERT_EQUAL_UINT32( 1, ulCoreWakeups[ configTICK_CORE ] );
+
+    for( x = 0; x < configNUMBER_OF_CORES; x++ )
+    {
+        if( x == configTICK_CORE )
+        {
+            continue;
+        }
+
+        TEST_ASSERT_EQUAL_UINT32( ( x == xRunningCore ) ? 1 : 0, ulCoreWakeups[ x ] );
+        TEST_ASSERT_EQUAL_UINT32( 0, ulCoreTicks[ x ] );
+    }
+}
+
+/**
+ * @brief A core other than the tick core keeps no time, so it sleeps however
+ * soon a task unblocks, while the tick core keeps ticking.
+ */
+void test_tickless_other_core_sleeps_while_tick_core_runs( void )
+{
+    TaskHandle_t xTaskHandles[ configNUMBER_OF_CORES ] = { NULL };
+    BaseType_t x;
+
+    prvStartTasks( xTaskHandles );
+
+    prvDelayTask( 1, 1 );
+    TEST_ASSERT_EQUAL( pdTRUE, prvIdleCore( 1 ) );
+    TEST_ASSERT_EQUAL( portMAX_DELAY, xCoreWakeTime[ 1 ] );
+
+    prvAdvanceTime( 1 );
+
+    /* The tick core unblocked T1 and woke core 1 to run it. */
+    verifySmpTask( &xTaskHandles[ 1 ], eRunning, 1 );
+    TEST_ASSERT_EQUAL_UINT32( 1, ulCoreWakeups[ 1 ] );
+    TEST_ASSERT_EQUAL_UINT32( 0, ulCoreTicks[ 1 ] );
+
+    for( x = 0; x < configNUMBER_OF_CORES; x++ )
+    {
+        if( x != 1 )
+        {
+            TEST_ASSERT_EQUAL_UINT32( 1, ulCoreTicks[ x ] );
+            TEST_ASSERT_EQUAL_UINT32( 0, ulCoreWakeups[ x ] );
+        }
+    }
+}
+
+/**
+ * @brief The tick core keeps its tick when the next task unblocks sooner than
+ * configEXPECTED_IDLE_TIME_BEFORE_SLEEP.
+ */
+void test_tickless_tick_core_short_idle_keeps_tick( void )
+{
+    TaskHandle_t xTaskHandles[ configNUMBER_OF_CORES ] = { NULL };
+    BaseType_t x;
+
+    prvStartTasks( xTaskHandles );
+
+    for( x = 0; x < configNUMBER_OF_CORES; x++ )
+    {
+        prvDelayTask( x, 1 );
+    }
+
+    TEST_ASSERT_EQUAL( pdFALSE, prvIdleCore( configTICK_CORE ) );
+
+    prvAdvanceTime( 1 );
+
+    TEST_ASSERT_EQUAL_UINT32( 1, ulCoreTicks[ configTICK_CORE ] );
+    TEST_ASSERT_EQUAL_UINT32( 0, ulCoreWakeups[ configTICK_CORE ] );
+}
+
+/**
+ * @brief The tick core stays awake while tasks run on other cores, as the
+ * kernel expects no idle time then. The idle cores still sleep.
+ */
+void test_tickless_tick_core_awake_while_tasks_run( void )
+{
+    TaskHandle_t xTaskHandles[ configNUMBER_OF_CORES ] = { NULL };
+    BaseType_t x;
+
+    prvStartTasks( xTaskHandles );
+
+    prvDelayTask( 0, 100 );
+    prvDelayTask( 2, 100 );
+    prvDelayTask( 3, 100 );
+
+    TEST_ASSERT_EQUAL( pdFALSE, prvIdleCore( configTICK_CORE ) );
+    TEST_ASSERT_EQUAL( pdTRUE, prvIdleCore( 2 ) );
+    TEST_ASSERT_EQUAL( pdTRUE, prvIdleCore( 3 ) );
+
+    prvAdvanceTime( 50 );
+
+    TEST_ASSERT_EQUAL_UINT32( 50, ulCoreTicks[ 0 ] );
+    TEST_ASSERT_EQUAL_UINT32( 50, ulCoreTicks[ 1 ] );
+    TEST_ASSERT_EQUAL_UINT32( 0, ulCoreTicks[ 2 ] );
+    TEST_ASSERT_EQUAL_UINT32( 0, ulCoreTicks[ 3 ] );
+
+    for( x = 0; x < configNUMBER_OF_CORES; x++ )
+    {
+        TEST_ASSERT_EQUAL_UINT32( 0, ulCoreWakeups[ x ] );
+    }
+}
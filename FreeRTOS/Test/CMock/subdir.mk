@@ -5,10 +5,11 @@
 SCRATCH_DIR     :=  $(GENERATED_DIR)/$(PROJECT)
 
 LCOV_LIST       :=  $(foreach suite,$(SUITES),$(SCRATCH_DIR)/$(PROJECT)_$(suite).info)
+RUN_LIST        :=  $(addprefix run_,$(SUITES))
 COVINFO         :=  $(GENERATED_DIR)/$(PROJECT).info
 COV_REPORT_DIR  :=  $(SCRATCH_DIR)/coverage
 
-.PHONY: all clean libs run bin lcov zerocoverage lcovhtml
+.PHONY: all clean libs run bin lcov zerocoverage lcovhtml list_tests $(RUN_LIST)
 
 all: run
 
@@ -18,24 +19,28 @@ clean :
     rm -f $(COVINFO)
 
 libs :
-    make -C $(UT_ROOT_DIR) libs
+    $(MAKE) -C $(UT_ROOT_DIR) libs
 
 lcov : $(COVINFO)
 
-# run each suite and leave gcda / gcov files in place
-run: libs
-    $(foreach suite,$(SUITES),\
-        make -C $(suite) run;)
+# run each suite, suites are independent and can run concurrently with make -j
+run: $(RUN_LIST)
+
+$(RUN_LIST) : run_% : libs
+    $(MAKE) -C $* run
 
 bin: $(EXEC_LIST)
 
+list_tests :
+    @$(foreach suite,$(SUITES),                                                \
+        $(MAKE) -s --no-print-directory -C $(suite) list_tests && ) true
+
 zerocoverage:
     $(LCOV_BIN_DIR)/lcov --zerocounters --directory $(SCRATCH_DIR)
 
 # Generate lcov for each suite
-$(LCOV_LIST) :
-    $(foreach suite,$(SUITES),\
-        make -C $(suite) lcov;)
+$(LCOV_LIST) : $(SCRATCH_DIR)/$(PROJECT)_%.info : libs
+    $(MAKE) -C $* lcov
 
 # Combine lcov from each subdirectory into one lcov info file for the project
 $(COVINFO) : $(LCOV_LIST)
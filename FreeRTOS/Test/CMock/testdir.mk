@@ -56,7 +56,13 @@ EXEC_LIST       :=  $(addprefix $(BIN_DIR)/,$(EXECS))
 LIBS_LIST       :=  $(foreach lib, $(LIBS), $(LIB_DIR)/$(lib).so)
 
 # Coverage related options
+# Suites that measure time rather than coverage (e.g. smp/bench) set
+# COVERAGE_INSTRUMENTATION to 0 to build the kernel without gcov hooks.
+ifeq ($(COVERAGE_INSTRUMENTATION),0)
+GCC_COV_OPTS    :=
+else
 GCC_COV_OPTS    :=  -fprofile-arcs -ftest-coverage -fprofile-generate
+endif
 GCOV_OPTS       :=  --unconditional-branches --branch-probabilities
 COV_REPORT_DIR  :=  $(SCRATCH_DIR)/coverage
 
@@ -120,14 +126,28 @@ $(EXEC_LIST) : $(BIN_DIR)/$(EXEC_PREFIX)_%_utest : $(SCRATCH_DIR)/%_utest.o
         $(MOCK_OBJ_LIST) $(PROJ_OBJ_LIST) $(LDFLAGS) -o $@
 
 # Generate _mock.c / .h files
-$(MOCK_HDR_LIST) $(MOCK_SRC_LIST) : $(PROJECT_DIR)/$(PROJECT).yml $(MOCK_FILES_FP)
+# cmock.rb generates every mock in one go, the stamp file keeps parallel builds
+# from running it once per mock file. A mock missing from MOCKS_DIR makes the
+# stamp out of date, so deleting one regenerates them all.
+MOCKS_MISSING   :=  $(filter-out $(wildcard $(MOCK_HDR_LIST) $(MOCK_SRC_LIST)),\
+                        $(MOCK_HDR_LIST) $(MOCK_SRC_LIST))
+
+.PHONY: mocks_missing
+
+mocks_missing : ;
+
+$(MOCK_HDR_LIST) $(MOCK_SRC_LIST) : $(MOCKS_DIR)/mocks.stamp ;
+
+$(MOCKS_DIR)/mocks.stamp : $(PROJECT_DIR)/$(PROJECT).yml $(MOCK_FILES_FP)     \
+                           $(if $(MOCKS_MISSING),mocks_missing)
     mkdir -p $(SCRATCH_DIR) $(MOCKS_DIR)
     cd $(SCRATCH_DIR) && \
         ruby $(CMOCK_EXEC_DIR)/cmock.rb -o$(PROJECT_DIR)/$(PROJECT).yml \
         $(MOCK_FILES_FP)
+    touch $@
 
 
 $(LIBS_LIST) :
-    make -C $(UT_ROOT_DIR) libs
+    $(MAKE) -C $(UT_ROOT_DIR) libs
 
 include $(UT_ROOT_DIR)/coverage.mk
@@ -42,6 +42,14 @@ arg_parser.add_argument(
     "-o", "--out", required=True, help="Output callgraph.json file path."
 )
 
+arg_parser.add_argument(
+    "-d",
+    "--definitions",
+    required=False,
+    help="Optional output .json file path mapping each function name to the file"
+    " and line where it is defined.",
+)
+
 arg_parser.add_argument("in_files", nargs="+", help="Input .c files to be parsed.")
 args = arg_parser.parse_args()
 
@@ -49,6 +57,10 @@ if vars(args)["out"] and not os.path.isdir(os.path.dirname(vars(args)["out"])):
     print("The output directory does not exist.", file=sys.stderr)
     sys.exit(1)
 
+if args.definitions and not os.path.isdir(os.path.dirname(args.definitions)):
+    print("The definitions output directory does not exist.", file=sys.stderr)
+    sys.exit(1)
+
 target_files = args.in_files
 
 for f in target_files:
@@ -84,7 +96,7 @@ if ret.stderr.decode("utf-8"):
 lineregex = (
     r"^{\s*(?P<level>\d+)} \s*"
     r"(?P<function>\S*)\(\) \<.* at "
-    r"(?P<filename>.*):\d+\>(:)?"
+    r"(?P<filename>.*):(?P<line>\d+)\>(:)?"
     r"(?P<xref> \[see \d+\])?$"
 )
 linepattern = re.compile(lineregex)
@@ -93,6 +105,7 @@ last_indent_level = 0
 last_function_name = ""
 callmap: Dict[str, Set[str]] = {}
 callmap[""] = set()
+definitions: Dict[str, Dict[str, object]] = {}
 
 for line in ret.stdout.decode("utf-8").splitlines():
     match = linepattern.match(line)
@@ -105,6 +118,12 @@ for line in ret.stdout.decode("utf-8").splitlines():
         if function_name not in callmap:
             callmap[function_name] = set()
 
+        if function_name not in definitions:
+            definitions[function_name] = {
+                "file": match.group("filename"),
+                "line": int(match.group("line")),
+            }
+
         # Indent -> lower in the call stack
         if indent_level > last_indent_level:
             # add last function to the stack
@@ -135,3 +154,7 @@ for key in callmap:
 
 with open(args.out, "w") as outfile:
     json.dump(callmap_list, outfile)
+
+if args.definitions:
+    with open(args.definitions, "w") as outfile:
+        json.dump(definitions, outfile)
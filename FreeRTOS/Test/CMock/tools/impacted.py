@@ -0,0 +1,527 @@
+#!/usr/bin/env python3
+###############################################################################
+# FreeRTOS
+# Copyright (C) 2024 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# https://www.FreeRTOS.org
+# https://github.com/FreeRTOS
+###############################################################################
+"""Select, rebuild and run only the unit tests impacted by kernel changes.
+
+The kernel sources are compared against a snapshot of the sources the cached
+coverage data was produced from. The changed lines are mapped to the enclosing
+kernel functions and, through callgraph.py, to every function which calls
+them. A test executable is impacted when its cached lcov tracefile shows it
+executed one of those functions. Only impacted executables are rebuilt and
+run; the cached tracefiles of the other executables are renumbered to follow
+the changed sources and everything is merged back into the lcov baseline.
+"""
+import argparse
+import concurrent.futures
+import glob
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+from typing import Dict, List, Optional, Set, Tuple
+
+# (old_start, old_count, new_start, new_count) of a git diff hunk
+Hunk = Tuple[int, int, int, int]
+
+HUNK_PATTERN = re.compile(r"^@@ -(\d+)(?:,(\d+))? \+(\d+)(?:,(\d+))? @@")
+
+# Prefix marking changes outside of any function body (declarations, macros)
+GLOBAL_CHANGE = ":"
+
+
+def main():
+    arg_parser = argparse.ArgumentParser(
+        description="Rebuild and run only the unit tests impacted by kernel changes"
+    )
+    arg_parser.add_argument(
+        "-k", "--kernel-dir", required=True, help="FreeRTOS/Source directory"
+    )
+    arg_parser.add_argument(
+        "-u", "--ut-dir", required=True, help="Root directory of the unit tests"
+    )
+    arg_parser.add_argument(
+        "-s",
+        "--state-dir",
+        required=True,
+        help="Directory holding the source snapshot matching the cached coverage",
+    )
+    arg_parser.add_argument(
+        "-b",
+        "--base",
+        default="HEAD",
+        help="git revision the cached coverage was generated from, used when no"
+        " snapshot exists yet (default: HEAD)",
+    )
+    arg_parser.add_argument(
+        "-o", "--out", required=True, help="lcov baseline tracefile to update"
+    )
+    arg_parser.add_argument(
+        "-j", "--jobs", type=int, default=1, help="Number of concurrent make jobs"
+    )
+    arg_parser.add_argument(
+        "-n",
+        "--dry-run",
+        action="store_true",
+        help="Only print the impacted test executables",
+    )
+    args = arg_parser.parse_args()
+
+    if not os.path.isdir(args.kernel_dir):
+        print("The kernel directory does not exist.", file=sys.stderr)
+        sys.exit(1)
+
+    if not os.path.isdir(os.path.dirname(os.path.abspath(args.out))):
+        print("The output directory does not exist.", file=sys.stderr)
+        sys.exit(1)
+
+    snapshot_dir = os.path.join(args.state_dir, "source")
+    if not os.path.isdir(snapshot_dir):
+        create_snapshot_from_git(args.kernel_dir, args.base, snapshot_dir)
+
+    hunks = get_changed_hunks(args.kernel_dir, snapshot_dir)
+    if not hunks:
+        if not os.path.isfile(args.out):
+            print("No coverage baseline found, run make coverage first.")
+            sys.exit(1)
+        print("No kernel source changes, the coverage baseline is up to date.")
+        return
+
+    changed_functions = get_changed_functions(args.kernel_dir, args.state_dir, hunks)
+    print("Changed kernel functions: " + str(sorted(changed_functions)))
+
+    tests, initials = list_tests(args.ut_dir)
+    impacted = select_impacted_tests(tests, changed_functions, hunks)
+
+    print(
+        "Impacted test executables ({} of {}):".format(len(impacted), len(tests))
+    )
+    for test in impacted:
+        print("    " + os.path.basename(test["info"]).replace(".info", ""))
+
+    if args.dry_run:
+        return
+
+    if not run_tests(impacted, args.jobs):
+        print("Impacted tests failed, the coverage baseline was not updated.")
+        sys.exit(1)
+
+    # Tracefiles not regenerated refer to the line numbers of the snapshot
+    for test in tests:
+        if test not in impacted:
+            renumber_tracefile(test["info"], args.kernel_dir, hunks)
+    for initial in initials:
+        renumber_tracefile(initial, args.kernel_dir, hunks)
+
+    merge_tracefiles(
+        [t["info"] for t in tests] + initials, args.out, os.path.join(args.ut_dir, "lcovrc")
+    )
+
+    update_snapshot(args.kernel_dir, snapshot_dir)
+
+
+def kernel_sources(kernel_dir):
+    """Return the kernel .c file names, relative to the kernel directory."""
+    return sorted(
+        os.path.basename(f) for f in glob.glob(os.path.join(kernel_dir, "*.c"))
+    )
+
+
+def create_snapshot_from_git(kernel_dir, base, snapshot_dir):
+    """Populate the snapshot with the kernel sources of the given git revision."""
+    prefix = subprocess.run(
+        ["git", "rev-parse", "--show-prefix"],
+        cwd=kernel_dir,
+        capture_output=True,
+        check=True,
+        text=True,
+    ).stdout.strip()
+
+    os.makedirs(snapshot_dir)
+    for name in kernel_sources(kernel_dir):
+        ret = subprocess.run(
+            ["git", "show", "{}:{}{}".format(base, prefix, name)],
+            cwd=kernel_dir,
+            capture_output=True,
+        )
+        # Files added after the base revision are compared against nothing
+        with open(os.path.join(snapshot_dir, name), "wb") as f:
+            if ret.returncode == 0:
+                f.write(ret.stdout)
+
+
+def update_snapshot(kernel_dir, snapshot_dir):
+    """Record the kernel sources the coverage baseline now corresponds to."""
+    shutil.rmtree(snapshot_dir)
+    os.makedirs(snapshot_dir)
+    for name in kernel_sources(kernel_dir):
+        shutil.copy2(os.path.join(kernel_dir, name), snapshot_dir)
+
+
+def get_changed_hunks(kernel_dir, snapshot_dir) -> Dict[str, List[Hunk]]:
+    """Return the git diff hunks of each changed kernel .c file."""
+    hunks: Dict[str, List[Hunk]] = {}
+    for name in kernel_sources(kernel_dir):
+        ret = subprocess.run(
+            [
+                "git",
+                "diff",
+                "--no-index",
+                "--no-color",
+                "-U0",
+                os.path.join(snapshot_dir, name),
+                os.path.join(kernel_dir, name),
+            ],
+            capture_output=True,
+            text=True,
+        )
+        # git diff --no-index exits with 1 when the files differ
+        if ret.returncode > 1:
+            print(ret.stderr, file=sys.stderr)
+            sys.exit(1)
+
+        for line in ret.stdout.splitlines():
+            match = HUNK_PATTERN.match(line)
+            if match:
+                old_count = 1 if match.group(2) is None else int(match.group(2))
+                new_count = 1 if match.group(4) is None else int(match.group(4))
+                hunks.setdefault(name, []).append(
+                    (int(match.group(1)), old_count, int(match.group(3)), new_count)
+                )
+    return hunks
+
+
+def get_function_bodies(filename, definitions) -> List[Tuple[str, int, int]]:
+    """Given a .c file and the definition lines reported by cflow, return the
+    (name, first line, last line) of each function including its signature."""
+    with open(filename, "r", errors="replace") as f:
+        source = f.read()
+
+    # Line of each closing brace that brings the nesting depth back to 0
+    closing_lines = []
+    depth = 0
+    line_no = 1
+    i = 0
+    while i < len(source):
+        c = source[i]
+        if c == "\n":
+            line_no += 1
+        elif source.startswith("/*", i):
+            end = source.find("*/", i + 2)
+            end = len(source) if end < 0 else end + 2
+            line_no += source.count("\n", i, end)
+            i = end
+            continue
+        elif source.startswith("//", i):
+            end = source.find("\n", i)
+            i = len(source) if end < 0 else end
+            continue
+        elif c in "\"'":
+            j = i + 1
+            while j < len(source) and source[j] != c and source[j] != "\n":
+                j += 2 if source[j] == "\\" else 1
+            i = j + 1
+            continue
+        elif c == "{":
+            depth += 1
+        elif c == "}":
+            depth -= 1
+            if depth == 0:
+                closing_lines.append(line_no)
+        i += 1
+
+    bodies = []
+    for name, first in definitions:
+        last = next((l for l in closing_lines if l >= first), first)
+        bodies.append((name, first, last))
+    return bodies
+
+
+def get_changed_functions(kernel_dir, state_dir, hunks) -> Set[str]:
+    """Return the changed kernel functions together with all of their callers.
+    A change outside of any function adds GLOBAL_CHANGE + the file name."""
+    sources = [os.path.join(kernel_dir, name) for name in kernel_sources(kernel_dir)]
+    callgraph = os.path.join(state_dir, "callgraph.json")
+    definitions_file = os.path.join(state_dir, "definitions.json")
+    subprocess.run(
+        [
+            sys.executable,
+            os.path.join(os.path.dirname(os.path.abspath(__file__)), "callgraph.py"),
+            "--out",
+            callgraph,
+            "--definitions",
+            definitions_file,
+        ]
+        + sources,
+        check=True,
+    )
+
+    with open(callgraph, "r") as f:
+        callmap = json.load(f)
+    with open(definitions_file, "r") as f:
+        definitions = json.load(f)
+
+    changed: Set[str] = set()
+    for name, file_hunks in hunks.items():
+        filename = os.path.join(kernel_dir, name)
+        bodies = get_function_bodies(
+            filename,
+            [
+                (function, location["line"])
+                for function, location in definitions.items()
+                if os.path.basename(location["file"]) == name
+            ],
+        )
+        for _old_start, _old_count, new_start, new_count in file_hunks:
+            # A pure deletion touches the lines around the removed block
+            first = new_start if new_count else max(new_start, 1)
+            last = new_start + new_count - 1 if new_count else new_start + 1
+            for line in range(first, last + 1):
+                owner = next(
+                    (f for f, begin, end in bodies if begin <= line <= end),
+                    GLOBAL_CHANGE + name,
+                )
+                changed.add(owner)
+
+    # callgraph.py maps each function to every function it reaches
+    callers = {
+        caller
+        for caller, callees in callmap.items()
+        if caller and any(callee in changed for callee in callees)
+    }
+    return changed | callers
+
+
+def list_tests(ut_dir):
+    """Return the test executables described by the list_tests make target and
+    the initial (zero count) tracefiles of each suite."""
+    ret = subprocess.run(
+        ["make", "-s", "--no-print-directory", "-C", ut_dir, "list_tests"],
+        capture_output=True,
+        text=True,
+        env=sub_make_env(),
+    )
+    if ret.returncode != 0:
+        print(ret.stderr, file=sys.stderr)
+        sys.exit(1)
+
+    tests = []
+    initials = []
+    for line in ret.stdout.splitlines():
+        fields = line.split("\t")
+        if fields[0] == "test" and len(fields) == 4:
+            tests.append({"dir": fields[1], "info": fields[2], "stamp": fields[3]})
+        elif fields[0] == "initial" and len(fields) == 3:
+            initials.append(fields[2])
+    return tests, initials
+
+
+def get_executed_functions(info_file) -> Dict[str, Set[str]]:
+    """Return the functions with a non zero call count in an lcov tracefile,
+    keyed by source file name."""
+    executed: Dict[str, Set[str]] = {}
+    source = ""
+    with open(info_file, "r") as f:
+        for line in f:
+            if line.startswith("SF:"):
+                source = os.path.basename(line[3:].strip())
+                executed.setdefault(source, set())
+            elif line.startswith("FNDA:"):
+                count, function = line[5:].strip().split(",", 1)
+                if int(count) > 0:
+                    executed[source].add(function)
+    return executed
+
+
+def select_impacted_tests(tests, changed_functions, hunks):
+    """Return the tests which executed a changed function or one of its
+    callers. Tests without cached coverage data are always selected."""
+    impacted = []
+    for test in tests:
+        if not os.path.isfile(test["info"]):
+            impacted.append(test)
+            continue
+
+        executed = get_executed_functions(test["info"])
+        for name in hunks:
+            functions = executed.get(name, set())
+            if (GLOBAL_CHANGE + name in changed_functions and functions) or (
+                functions & changed_functions
+            ):
+                impacted.append(test)
+                break
+    return impacted
+
+
+def sub_make_env():
+    """Environment for make invocations without the job server of a parent."""
+    env = dict(os.environ)
+    for key in ("MAKEFLAGS", "MFLAGS", "MAKELEVEL"):
+        env.pop(key, None)
+    return env
+
+
+def run_tests(impacted, jobs) -> bool:
+    """Rebuild, run and capture the coverage of the impacted tests. Suites are
+    processed concurrently, at most jobs at a time."""
+    targets: Dict[str, List[str]] = {}
+    for test in impacted:
+        # Force the executable to run even if the kernel objects did not change
+        for stale in (test["info"], test["stamp"]):
+            if os.path.exists(stale):
+                os.remove(stale)
+        targets.setdefault(test["dir"], []).append(test["info"])
+
+    def make(directory):
+        return subprocess.run(
+            ["make", "-C", directory] + targets[directory], env=sub_make_env()
+        ).returncode
+
+    with concurrent.futures.ThreadPoolExecutor(max_workers=max(jobs, 1)) as pool:
+        results = list(pool.map(make, targets))
+    return all(ret == 0 for ret in results)
+
+
+def map_line(line, file_hunks) -> Optional[int]:
+    """Map a snapshot line number to the current source, None if deleted."""
+    offset = 0
+    for old_start, old_count, _new_start, new_count in file_hunks:
+        if old_count == 0:
+            # Insertion after old_start
+            if line <= old_start:
+                break
+        else:
+            if line < old_start:
+                break
+            if line < old_start + old_count:
+                return None
+        offset += new_count - old_count
+    return line + offset
+
+
+def renumber_tracefile(info_file, kernel_dir, hunks):
+    """Rewrite the line numbers of the changed kernel sources in an lcov
+    tracefile, dropping the records of deleted lines."""
+    if not os.path.isfile(info_file):
+        return
+
+    out = []
+    section = []
+    file_hunks = None
+    with open(info_file, "r") as f:
+        for line in f:
+            record, _, value = line.rstrip("\n").partition(":")
+            if record == "SF":
+                file_hunks = None
+                if os.path.dirname(os.path.abspath(value)) == os.path.abspath(
+                    kernel_dir
+                ):
+                    file_hunks = hunks.get(os.path.basename(value))
+            if not file_hunks:
+                out.append(line)
+                continue
+
+            section.append((record, value))
+            if record == "end_of_record":
+                out += renumber_section(section, file_hunks)
+                section = []
+
+    with open(info_file, "w") as f:
+        f.writelines(out)
+
+
+def renumber_section(section, file_hunks) -> List[str]:
+    """Renumber the records of one source file and recompute its summary."""
+    out = []
+    functions = set()
+    lines_found = lines_hit = 0
+    functions_hit = 0
+    branches_found = branches_hit = 0
+    for record, value in section:
+        if record == "FN":
+            # lcov 1.x writes FN:<line>,<name>, lcov 2.x FN:<start>,<end>,<name>.
+            # Function names may not contain commas, so the name is the last
+            # field either way.
+            fields = value.split(",")
+            name = fields[-1]
+            mapped = map_line(int(fields[0]), file_hunks)
+            if mapped is None:
+                continue
+            numbers = [str(mapped)]
+            if len(fields) > 2:
+                end = map_line(int(fields[1]), file_hunks)
+                # The end line is optional, drop it rather than the function
+                # when it was deleted.
+                if end is not None:
+                    numbers.append(str(end))
+            functions.add(name)
+            value = ",".join(numbers + [name])
+        elif record in ("DA", "BRDA"):
+            number, _, rest = value.partition(",")
+            mapped = map_line(int(number), file_hunks)
+            if mapped is None:
+                continue
+            value = "{},{}".format(mapped, rest)
+            if record == "DA":
+                lines_found += 1
+                lines_hit += int(rest.split(",")[0]) > 0
+            else:
+                branches_found += 1
+                branches_hit += rest.split(",")[-1] not in ("-", "0")
+        elif record == "FNDA":
+            count, _, name = value.partition(",")
+            if name not in functions:
+                continue
+            functions_hit += int(count) > 0
+        elif record in ("LF", "LH", "FNF", "FNH", "BRF", "BRH"):
+            continue
+        elif record == "end_of_record":
+            out += [
+                "FNF:{}\n".format(len(functions)),
+                "FNH:{}\n".format(functions_hit),
+                "BRF:{}\n".format(branches_found),
+                "BRH:{}\n".format(branches_hit),
+                "LF:{}\n".format(lines_found),
+                "LH:{}\n".format(lines_hit),
+                "end_of_record\n",
+            ]
+            continue
+        out.append("{}:{}\n".format(record, value))
+    return out
+
+
+def merge_tracefiles(info_files, out, lcovrc):
+    """Combine the tracefiles into the lcov baseline."""
+    cmd = ["lcov", "--config-file", lcovrc, "-o", out]
+    for info in info_files:
+        if os.path.isfile(info):
+            cmd += ["--add-tracefile", info]
+    subprocess.run(cmd, check=True)
+
+
+if __name__ == "__main__":
+    main()